@@ -0,0 +1,17 @@
+#version 130
+
+uniform mat4 Projection;
+uniform float PointSize;
+uniform float Depth;
+
+in float PositionX;
+in float PositionY;
+in vec4 Color4;
+out vec4 Color;
+
+// Particles are already in world space, so are only projected.
+void main() {
+    gl_Position = Projection * vec4(PositionX, PositionY, Depth, 1.0);
+    gl_PointSize = PointSize;
+    Color = Color4;
+}
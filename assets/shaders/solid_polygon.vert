@@ -1,16 +1,15 @@
 #version 130
 
 uniform mat4 Projection;
-uniform mat4 ViewModel;
-uniform vec4 PolygonColor;
 
-in vec4 Position2;
+in vec3 Position3;
+in vec4 Color4;
 out vec4 Color;
 
-// Passes position through without modification and generates texture
-// coordinates for drawing to a quad with the axis in the lower left
-// corner.
+// Solid shapes are transformed into world space before being batched, so are
+// only projected.  Color and depth come with each vertex so shapes of
+// different colors and draw order can share a draw.
 void main() {
-    gl_Position = Projection * ViewModel * vec4(Position2.x, Position2.y, 0.0, 1.0);
-    Color = PolygonColor;
+    gl_Position = Projection * vec4(Position3, 1.0);
+    Color = Color4;
 }
@@ -35,6 +35,7 @@ COMMANDS_DESCRIPTION = [('clean', 'Remove build directories.'),
                         ('build', 'Do a build.'),
                         ('doc', 'Generate project documentation.'),
                         ('check', 'Run tests.'),
+                        ('bench', 'Build Release and benchmark every demo.'),
                         ('demo', 'Sets the default demo to run.'),
                         ('export', 'Creates an exported version of Calendon.'),
                         ('run', 'Run a program with the driver.'),
@@ -123,6 +123,8 @@ def cmd_gen(ctx: ProjectContext, args: argparse.Namespace) -> int:
     cmake_args = [cmake_path, '..']
     if args.enable_ccache:
         cmake_args.append('-DCN_ENABLE_CCACHE=1')
+    if args.enable_profiler:
+        cmake_args.append('-DCN_ENABLE_PROFILER=1')
 
     compiler = ctx.compiler()
     if compiler is not None:
@@ -136,6 +138,13 @@ def cmd_gen(ctx: ProjectContext, args: argparse.Namespace) -> int:
     return run_program(cmake_args, cwd=build_dir)
 
 
+def _build_args(ctx: ProjectContext) -> List[str]:
+    """Arguments to build the project, run from within the build directory."""
+    return [ctx.path_for_program('cmake'), '--build', '.',
+            '--parallel', str(multiprocessing.cpu_count()),
+            '--config', ctx.build_config()]
+
+
 def cmd_build(ctx: ProjectContext, args: argparse.Namespace) -> int:
     """Build using the current project configuration."""
     if not _verify_executable_exists(ctx, 'cmake'):
@@ -144,9 +153,7 @@ def cmd_build(ctx: ProjectContext, args: argparse.Namespace) -> int:
     if not _verify_build_dir_exists(ctx.build_dir()):
         return 1
 
-    cmake_args = [ctx.path_for_program('cmake'), '--build', '.',
-                  '--parallel', str(multiprocessing.cpu_count()),
-                  '--config', ctx.build_config()]
+    cmake_args = _build_args(ctx)
 
     if args.dry_run:
         print(f'Would have run {cmake_args} in {ctx.build_dir()}')
@@ -207,6 +214,68 @@ def cmd_check(ctx: ProjectContext, args: argparse.Namespace) -> int:
         return run_program(cmake_args, cwd=(ctx.build_dir()))
 
 
+def cmd_bench(ctx: ProjectContext, args: argparse.Namespace) -> int:
+    """Builds Release and runs every demo for a number of ticks, writing measurements of each as JSON."""
+    if not _verify_executable_exists(ctx, 'cmake'):
+        return 1
+
+    # Benchmarks use their own build directory, so they don't change the
+    # configuration of the usual build.
+    overrides = {'build_dir': args.build_dir or 'build-bench', 'build_config': 'Release'}
+    bench_ctx = ctx.copy_with_overrides(overrides)
+    build_dir = bench_ctx.build_dir()
+
+    cmake_path: str = bench_ctx.path_for_program('cmake')
+    configured: bool = os.path.isdir(build_dir)
+    if not configured:
+        compiler = bench_ctx.compiler()
+        if compiler is not None:
+            compiler = bench_ctx.path_for_program(compiler)
+        gen_args = [cmake_path, '-S', bench_ctx.calendon_home(), '-B', build_dir,
+                    '-DCMAKE_BUILD_TYPE=Release']
+        gen_args.extend(generator_settings_for_compiler(cmake_path, compiler))
+        if args.dry_run:
+            print(f'Would have run {gen_args}')
+        elif run_program(gen_args, cwd=bench_ctx.calendon_home()) != 0:
+            return 1
+
+    # A dry run doesn't configure, so there's no build directory to check yet.
+    if args.dry_run and not configured:
+        print(f'Would have run {_build_args(bench_ctx)} in {build_dir}')
+    else:
+        build_status = cmd_build(bench_ctx, args)
+        if build_status != 0:
+            return build_status
+
+    output_dir = args.output_dir or os.path.join(build_dir, 'bench')
+    asset_dir = args.asset_dir or os.path.join(bench_ctx.calendon_home(), 'assets')
+    demo_sources = sorted(glob.glob(os.path.join(bench_ctx.calendon_home(), 'src', 'demos', '*.c')))
+    if not args.dry_run:
+        os.makedirs(output_dir, exist_ok=True)
+
+    failures: List[str] = []
+    for demo_source in demo_sources:
+        demo = os.path.splitext(os.path.basename(demo_source))[0]
+        driver_args = [bench_ctx.driver_path(),
+                       '--game', os.path.join(bench_ctx.demo_dir(), mp.root_to_shared_lib(demo)),
+                       '--asset-dir', asset_dir,
+                       '--tick-limit', str(args.ticks),
+                       '--bench', os.path.join(output_dir, f'{demo}.json')]
+        if args.headless:
+            driver_args.append('--headless')
+
+        if args.dry_run:
+            print(f'Would have run {driver_args} in {build_dir}')
+        elif run_program(driver_args, cwd=build_dir) != 0:
+            failures.append(demo)
+
+    if failures:
+        print(f'Demos which failed: {", ".join(failures)}')
+    elif not args.dry_run:
+        print(f'Wrote benchmark results to {output_dir}')
+    return len(failures)
+
+
 def cmd_demo(ctx: ProjectContext, _args: argparse.Namespace) -> int:
     """Prints all currently build demos which can be run."""
     print('Demos:')
@@ -106,6 +106,9 @@ def parser_gen(parser) -> argparse.ArgumentParser:
     parser.add_argument('--enable-ccache',
                         action='store_true',
                         help='Use ccache (if available)')
+    parser.add_argument('--enable-profiler',
+                        action='store_true',
+                        help='Record profile zones, for writing traces with --profile')
     return parser
 
 
@@ -136,6 +139,25 @@ def parser_check(parser) -> argparse.ArgumentParser:
     return parser
 
 
+def parser_bench(parser) -> argparse.ArgumentParser:
+    parser_add_general_args(parser_add_build_dir(parser))
+    parser.add_argument('--ticks',
+                        type=int,
+                        default=1000,
+                        help='Number of ticks to run each demo.')
+    parser.add_argument('--headless',
+                        action='store_true',
+                        help='Run without drawing, for machines without a display.')
+    parser.add_argument('--asset-dir',
+                        type=str,
+                        help='Sets the directory from which to load assets.')
+    parser.add_argument('--output-dir',
+                        type=str,
+                        help='Where to write results, one JSON file per demo.  '
+                             'Defaults to "bench" in the build directory.')
+    return parser
+
+
 def parser_demo(parser) -> argparse.ArgumentParser:
     return parser
 
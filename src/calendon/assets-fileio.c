@@ -1,6 +1,7 @@
 #include "assets-fileio.h"
 
 #include "log.h"
+#include "profile.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,19 +23,23 @@ extern CnLogHandle LogSysAssets;
  */
 bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *buffer)
 {
+	CN_PROFILE_BEGIN(__func__);
 	if (!filename) {
 		CN_ERROR(LogSysAssets, "Cannot read a null filename");
+		CN_PROFILE_END();
 		return false;
 	}
 
 	if (!buffer) {
 		CN_ERROR(LogSysAssets, "Cannot write file contents to a null buffer");
+		CN_PROFILE_END();
 		return false;
 	}
 
 	if (format != CnFileTypeBinary && format != CnFileTypeText) {
 		CN_ERROR(LogSysAssets, "Invalid file type constant. "
 			"Must be CnFileTypeBinary or CnFileTypeText");
+		CN_PROFILE_END();
 		return false;
 	}
 
@@ -42,6 +47,7 @@ bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *b
 	FILE* file = fopen(filename, readMode);
 	if (!file) {
 		CN_ERROR(LogSysAssets, "Cannot open file: %s", filename);
+		CN_PROFILE_END();
 		return false;
 	}
 
@@ -50,6 +56,7 @@ bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *b
 	if (fileLength > UINT32_MAX) {
 		CN_ERROR(LogSysMain, "File '%s' is too large to load into dynamic buffer: %li KiB",
 			filename, fileLength / 1024L);
+		CN_PROFILE_END();
 		return false;
 	}
 	if (format == CnFileTypeText) {
@@ -75,6 +82,7 @@ bool cnAssets_ReadFile(const char *filename, uint32_t format, CnDynamicBuffer *b
 
 	buffer->size = (uint32_t)amountRead;
 
+	CN_PROFILE_END();
 	return true;
 }
 
@@ -0,0 +1,174 @@
+#ifndef CN_ATOMIC_H
+#define CN_ATOMIC_H
+
+/**
+ * @file atomic.h
+ *
+ * Operations on integers shared between threads, which happen all at once as
+ * seen by other threads.
+ *
+ * C99 has no atomics, so these wrap compiler intrinsics.  Loads acquire and
+ * stores release, so writes made before storing a value are visible to a
+ * thread which loads that value.  Read-modify-write operations are sequentially
+ * consistent.
+ */
+
+#include <calendon/cn.h>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static CN_INLINE uint32_t cnAtomic_LoadU32(const volatile uint32_t* target)
+{
+#if defined(_MSC_VER)
+	// Volatile accesses have acquire and release semantics with /volatile:ms,
+	// which is the default on x86 and x64.
+	return *target;
+#else
+	return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static CN_INLINE void cnAtomic_StoreU32(volatile uint32_t* target, uint32_t value)
+{
+#if defined(_MSC_VER)
+	*target = value;
+#else
+	__atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * Adds to the target, returning the value before the addition.
+ */
+static CN_INLINE uint32_t cnAtomic_FetchAddU32(volatile uint32_t* target, uint32_t value)
+{
+#if defined(_MSC_VER)
+	return (uint32_t)_InterlockedExchangeAdd((volatile long*)target, (long)value);
+#else
+	return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Subtracts from the target, returning the value before the subtraction.
+ */
+static CN_INLINE uint32_t cnAtomic_FetchSubU32(volatile uint32_t* target, uint32_t value)
+{
+#if defined(_MSC_VER)
+	return (uint32_t)_InterlockedExchangeAdd((volatile long*)target, -(long)value);
+#else
+	return __atomic_fetch_sub(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Replaces the target with `desired` only if it is currently `expected`.
+ * Returns true if the replacement happened.
+ */
+static CN_INLINE bool cnAtomic_CompareExchangeU32(volatile uint32_t* target, uint32_t expected, uint32_t desired)
+{
+#if defined(_MSC_VER)
+	return (uint32_t)_InterlockedCompareExchange((volatile long*)target, (long)desired, (long)expected) == expected;
+#else
+	return __atomic_compare_exchange_n(target, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static CN_INLINE uint64_t cnAtomic_LoadU64(const volatile uint64_t* target)
+{
+#if defined(_MSC_VER)
+	return *target;
+#else
+	return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * Adds to the target, returning the value before the addition.
+ */
+static CN_INLINE uint64_t cnAtomic_FetchAddU64(volatile uint64_t* target, uint64_t value)
+{
+#if defined(_MSC_VER)
+	return (uint64_t)_InterlockedExchangeAdd64((volatile long long*)target, (long long)value);
+#else
+	return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Subtracts from the target, returning the value before the subtraction.
+ */
+static CN_INLINE uint64_t cnAtomic_FetchSubU64(volatile uint64_t* target, uint64_t value)
+{
+#if defined(_MSC_VER)
+	return (uint64_t)_InterlockedExchangeAdd64((volatile long long*)target, -(long long)value);
+#else
+	return __atomic_fetch_sub(target, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Replaces the target with `desired` only if it is currently `expected`.
+ * Returns true if the replacement happened.
+ */
+static CN_INLINE bool cnAtomic_CompareExchangeU64(volatile uint64_t* target, uint64_t expected, uint64_t desired)
+{
+#if defined(_MSC_VER)
+	return (uint64_t)_InterlockedCompareExchange64((volatile long long*)target, (long long)desired, (long long)expected) == expected;
+#else
+	return __atomic_compare_exchange_n(target, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static CN_INLINE int64_t cnAtomic_LoadI64(const volatile int64_t* target)
+{
+#if defined(_MSC_VER)
+	return *target;
+#else
+	return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static CN_INLINE void cnAtomic_StoreI64(volatile int64_t* target, int64_t value)
+{
+#if defined(_MSC_VER)
+	*target = value;
+#else
+	__atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static CN_INLINE bool cnAtomic_CompareExchangeI64(volatile int64_t* target, int64_t expected, int64_t desired)
+{
+#if defined(_MSC_VER)
+	return _InterlockedCompareExchange64((volatile long long*)target, desired, expected) == expected;
+#else
+	return __atomic_compare_exchange_n(target, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Prevents any loads or stores from moving across this point, including a
+ * store followed by a load of a different variable, which acquire and release
+ * ordering allows.
+ */
+static CN_INLINE void cnAtomic_ThreadFence(void)
+{
+#if defined(_MSC_VER)
+	_mm_mfence();
+#else
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_ATOMIC_H */
@@ -20,6 +20,14 @@ extern "C" {
  */
 typedef struct {
 	CnTime dt;
+
+	/**
+	 * How far between the previous and current simulated states to draw, from
+	 * 0 to 1.  This is always 1 unless ticking at a fixed rate, when time left
+	 * over which isn't enough for another tick puts the drawn state partway
+	 * between the last two ticks.
+	 */
+	float alpha;
 } CnFrameEvent;
 
 /**
@@ -0,0 +1,134 @@
+#include "bench.h"
+
+#include <calendon/frame-stats.h>
+#include <calendon/json.h>
+#include <calendon/memory.h>
+#include <calendon/process.h>
+#include <calendon/render.h>
+#include <calendon/tick-limits.h>
+
+#include <stdio.h>
+
+static double cnBench_Ms(uint64_t ns)
+{
+	return (double)ns / 1000000.0;
+}
+
+static void cnBench_WriteFrames(FILE* file)
+{
+	const struct {
+		double percentile;
+		const char* name;
+	} percentiles[] = {
+		{ 50.0, "p50Ms" },
+		{ 90.0, "p90Ms" },
+		{ 99.0, "p99Ms" },
+		{ 99.9, "p99_9Ms" }
+	};
+
+	fprintf(file, "\t\"frames\": {\n");
+	for (uint32_t phase = 0; phase < CnFramePhaseNum; ++phase) {
+		const CnHistogram* h = cnFrameStats_Histogram((CnFramePhase)phase);
+		fprintf(file, "\t\t\"%s\": { \"count\": %" PRIu64, cnFrameStats_PhaseName((CnFramePhase)phase), h->numValues);
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(percentiles); ++i) {
+			fprintf(file, ", \"%s\": %.4f", percentiles[i].name,
+				cnBench_Ms(cnHistogram_Percentile(h, percentiles[i].percentile)));
+		}
+		fprintf(file, ", \"maxMs\": %.4f }%s\n", cnBench_Ms(h->max),
+			phase + 1 < CnFramePhaseNum ? "," : "");
+	}
+	fprintf(file, "\t},\n");
+}
+
+static void cnBench_WriteSystems(FILE* file)
+{
+	fprintf(file, "\t\"systems\": [");
+	bool firstSystem = true;
+	for (uint32_t system = 0; system < CN_FRAME_STATS_MAX_SYSTEMS; ++system) {
+		const char* name = cnFrameStats_SystemName(system);
+		if (!name) {
+			continue;
+		}
+
+		fprintf(file, "%s\n\t\t{ \"name\": ", firstSystem ? "" : ",");
+		cnJSON_WriteString(file, name);
+		firstSystem = false;
+
+		for (uint32_t phase = 0; phase < CnFramePhaseNum; ++phase) {
+			const CnPhaseTimes* times = cnFrameStats_SystemPhaseAt(system, (CnFramePhase)phase);
+			if (times->numCalls == 0) {
+				continue;
+			}
+			fprintf(file, ", \"%s\": { \"calls\": %" PRIu64 ", \"meanMs\": %.4f, \"maxMs\": %.4f }",
+				cnFrameStats_PhaseName((CnFramePhase)phase), times->numCalls,
+				cnBench_Ms(cnPhaseTimes_Mean(times).native), cnBench_Ms(times->maxNs));
+		}
+		fprintf(file, " }");
+	}
+	fprintf(file, "\n\t],\n");
+}
+
+static void cnBench_WriteRender(FILE* file, bool headless)
+{
+	if (headless) {
+		fprintf(file, "\t\"render\": null,\n");
+		return;
+	}
+
+	const CnRenderStats stats = cnR_Stats();
+	fprintf(file, "\t\"render\": {\n");
+	fprintf(file, "\t\t\"drawCalls\": %" PRIu32 ",\n", stats.drawCalls);
+	fprintf(file, "\t\t\"opaqueDraws\": %" PRIu32 ",\n", stats.opaqueDraws);
+	fprintf(file, "\t\t\"translucentDraws\": %" PRIu32 ",\n", stats.translucentDraws);
+	fprintf(file, "\t\t\"pixelsCovered\": %" PRIu64 ",\n", stats.pixelsCovered);
+	fprintf(file, "\t\t\"samplesPassed\": %" PRIu64 ",\n", stats.samplesPassed);
+	fprintf(file, "\t\t\"pixelsInFrame\": %" PRIu64 "\n", stats.pixelsInFrame);
+	fprintf(file, "\t},\n");
+}
+
+static void cnBench_WriteMemory(FILE* file)
+{
+	const CnMemoryStats stats = cnMemory_Stats();
+	fprintf(file, "\t\"memory\": {\n");
+	fprintf(file, "\t\t\"peakProcessBytes\": %" PRIu64 ",\n", cnProc_PeakMemoryBytes());
+	fprintf(file, "\t\t\"allocations\": %" PRIu64 ",\n", stats.numAllocations);
+	fprintf(file, "\t\t\"frees\": %" PRIu64 ",\n", stats.numFrees);
+	fprintf(file, "\t\t\"peakAllocatedBytes\": %" PRIu64 ",\n", stats.peakBytes);
+	fprintf(file, "\t\t\"frameArenaPeakBytes\": %" PRIu64 ",\n", stats.frameArenaPeakBytes);
+	fprintf(file, "\t\t\"outstandingPoolBlocks\": %" PRIu64 "\n", stats.outstandingPoolBlocks);
+	fprintf(file, "\t},\n");
+}
+
+/**
+ * Writes the stats of the run so far to a JSON file.  Render stats must be
+ * read before the renderer shuts down.
+ */
+bool cnBench_Write(const char* path, const CnBenchRun* run)
+{
+	CN_ASSERT_PTR(path);
+	CN_ASSERT_PTR(run);
+
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		return false;
+	}
+
+	fprintf(file, "{\n\t\"game\": ");
+	cnJSON_WriteString(file, run->game);
+	fprintf(file, ",\n");
+	fprintf(file, "\t\"headless\": %s,\n", run->headless ? "true" : "false");
+	fprintf(file, "\t\"ticks\": %" PRIu64 ",\n", cnMain_TicksCompleted());
+	fprintf(file, "\t\"startupMs\": %.4f,\n", cnBench_Ms(run->startup.native));
+	fprintf(file, "\t\"runMs\": %.4f,\n", cnBench_Ms(run->run.native));
+
+	cnBench_WriteFrames(file);
+	cnBench_WriteSystems(file);
+	cnBench_WriteRender(file, run->headless);
+	cnBench_WriteMemory(file);
+
+	// Ends the object without a trailing comma after the last member.
+	fprintf(file, "\t\"version\": 1\n}\n");
+
+	const bool written = !ferror(file);
+	return fclose(file) == 0 && written;
+}
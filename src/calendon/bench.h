@@ -0,0 +1,49 @@
+#ifndef CN_BENCH_H
+#define CN_BENCH_H
+
+/**
+ * @file bench.h
+ *
+ * Writes the measurements of a run as JSON, so runs can be compared by tools
+ * to catch performance regressions.
+ *
+ * Durations are in milliseconds and sizes in bytes.  The file contains:
+ *
+ * - `frames`: count, percentiles and max of each frame phase
+ * - `systems`: calls, mean and max of each phase each system ran in
+ * - `render`: draw counts of the last frame drawn, or null when headless
+ * - `memory`: peak memory used by the process, and dynamic buffer allocations
+ * - `startupMs`: time from startup until the first frame
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Details of a run which aren't kept in the stats of other systems.
+ */
+typedef struct {
+	/** Path of the game library which ran. */
+	const char* game;
+
+	/** Time from startup until the main loop started. */
+	CnTime startup;
+
+	/** Time spent in the main loop. */
+	CnTime run;
+
+	bool headless;
+} CnBenchRun;
+
+CN_API bool cnBench_Write(const char* path, const CnBenchRun* run);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_BENCH_H */
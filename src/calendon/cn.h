@@ -270,6 +270,15 @@ CN_API void cnFatalError(const char* msg, ...);
  */
 #define CN_INLINE inline
 
+/**
+ * Gives each thread its own copy of a global or static variable.
+ */
+#if defined(_MSC_VER)
+	#define CN_THREAD_LOCAL __declspec(thread)
+#else
+	#define CN_THREAD_LOCAL __thread
+#endif
+
 /*
  * Macro to be used while writing code to indicate that this code should never
  * be submitted for real.  Define to something meaningless in production to
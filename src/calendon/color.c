@@ -1,5 +1,7 @@
 #include "color.h"
 
+#include <calendon/float.h>
+
 CnOpaqueColor cnOpaqueColor_MakeRGBf(float red, float green, float blue)
 {
 	return (CnOpaqueColor) { .red = red, .green = green, .blue = blue };
@@ -12,3 +14,22 @@ CnOpaqueColor cnOpaqueColor_MakeRGBu8(uint8_t red, uint8_t green, uint8_t blue)
 		(float)green / 255.0f,
 		(float)blue / 255.0f);
 }
+
+static uint8_t cnOpaqueColor_ChannelToU8(float channel)
+{
+	return (uint8_t)(cnFloat_Clamp(channel, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+/**
+ * Packs a color into 8 bits per channel, such as for a vertex attribute.
+ * Channels outside of [0, 1] are clamped.
+ */
+CnRGBA8u cnOpaqueColor_ToRGBA8u(CnOpaqueColor color)
+{
+	return (CnRGBA8u) {
+		.red = cnOpaqueColor_ChannelToU8(color.red),
+		.green = cnOpaqueColor_ChannelToU8(color.green),
+		.blue = cnOpaqueColor_ChannelToU8(color.blue),
+		.alpha = 255
+	};
+}
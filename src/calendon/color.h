@@ -31,6 +31,7 @@ typedef struct {
 
 CN_API CnOpaqueColor cnOpaqueColor_MakeRGBf(float red, float green, float blue);
 CN_API CnOpaqueColor cnOpaqueColor_MakeRGBu8(uint8_t red, uint8_t green, uint8_t blue);
+CN_API CnRGBA8u      cnOpaqueColor_ToRGBA8u(CnOpaqueColor color);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,43 @@
+#include "fixed-step.h"
+
+void cnFixedStep_Init(CnFixedStep* fs, CnTime step, uint32_t maxStepsPerFrame)
+{
+	CN_ASSERT_PTR(fs);
+	CN_ASSERT(!cnTime_IsZero(step), "Fixed steps must be non-zero.");
+	CN_ASSERT(maxStepsPerFrame > 0, "Must allow at least one step per frame.");
+
+	fs->step = step;
+	fs->accumulated = cnTime_MakeZero();
+	fs->maxStepsPerFrame = maxStepsPerFrame;
+}
+
+/**
+ * Adds elapsed time, and returns the number of steps to simulate for it.
+ */
+uint32_t cnFixedStep_Advance(CnFixedStep* fs, CnTime elapsed)
+{
+	CN_ASSERT_PTR(fs);
+
+	fs->accumulated = cnTime_Add(fs->accumulated, elapsed);
+
+	const uint64_t dueSteps = fs->accumulated.native / fs->step.native;
+	const uint32_t steps = dueSteps < fs->maxStepsPerFrame
+		? (uint32_t)dueSteps : fs->maxStepsPerFrame;
+
+	// Time which couldn't be caught up on is dropped, but the partial step is
+	// kept so interpolation stays smooth.
+	fs->accumulated.native = dueSteps > steps
+		? fs->accumulated.native % fs->step.native
+		: fs->accumulated.native - steps * fs->step.native;
+	return steps;
+}
+
+/**
+ * How far the accumulated time is into the next step, from 0 to 1.  Drawing
+ * should blend this far from the previous simulated state to the current one.
+ */
+float cnFixedStep_Alpha(const CnFixedStep* fs)
+{
+	CN_ASSERT_PTR(fs);
+	return (float)fs->accumulated.native / (float)fs->step.native;
+}
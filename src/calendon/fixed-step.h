@@ -0,0 +1,42 @@
+#ifndef CN_FIXED_STEP_H
+#define CN_FIXED_STEP_H
+
+/**
+ * @file fixed-step.h
+ *
+ * Converts elapsed real time into a whole number of equally sized simulation
+ * steps.  Time left over carries into the next frame, and how far it is into
+ * the next step is used to interpolate between the last two simulated states
+ * when drawing.
+ *
+ * Frames which fall far behind only run a limited number of steps to catch up,
+ * and the rest of the time is dropped.  The simulation slows down instead of
+ * each frame taking longer than the last trying to catch up.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	CnTime step;
+
+	/** Time elapsed which hasn't been simulated yet, always less than a step. */
+	CnTime accumulated;
+
+	uint32_t maxStepsPerFrame;
+} CnFixedStep;
+
+CN_API void     cnFixedStep_Init(CnFixedStep* fs, CnTime step, uint32_t maxStepsPerFrame);
+CN_API uint32_t cnFixedStep_Advance(CnFixedStep* fs, CnTime elapsed);
+CN_API float    cnFixedStep_Alpha(const CnFixedStep* fs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_FIXED_STEP_H */
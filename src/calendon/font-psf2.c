@@ -4,6 +4,7 @@
 
 #include <calendon/assets-fileio.h>
 #include <calendon/log.h>
+#include <calendon/profile.h>
 
 #include <string.h>
 
@@ -184,6 +185,7 @@ static void cnFont_PSF2ReadAndAllocateTextureAtlas(const CnPSF2Header* header, C
  */
 bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path)
 {
+	CN_PROFILE_BEGIN(__func__);
 	CnDynamicBuffer fileBuffer;
 	if (!cnAssets_ReadFile(path, CnFileTypeBinary, &fileBuffer)) {
 		CN_FATAL_ERROR("Unable to load font from %s", path);
@@ -216,6 +218,7 @@ bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path)
 		// If there is no unicode table, there is no way to determine which
 		// glypheme maps to which glyph.
 		CN_TRACE(LogSysMain, "No unicode table");
+		CN_PROFILE_END();
 		return false;
 	}
 	const uint8_t* const bitmapStart = (uint8_t*)header + header->bitmapOffset;
@@ -224,6 +227,7 @@ bool cnFont_PSF2Allocate(CnFontPSF2* font, const char* path)
 	const uint8_t* const unicodeTableEnd = (uint8_t*)fileBuffer.contents + fileBuffer.size;
 	cnFont_PSF2ReadUnicodeTableIntoGlyphMap(&font->map, unicodeTableStart, unicodeTableEnd);
 	cnDynamicBuffer_Free(&fileBuffer);
+	CN_PROFILE_END();
 	return true;
 }
 
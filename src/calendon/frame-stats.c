@@ -0,0 +1,296 @@
+#include "frame-stats.h"
+
+#include <string.h>
+
+static CnHistogram s_phases[CnFramePhaseNum];
+
+static const char* s_systemNames[CN_FRAME_STATS_MAX_SYSTEMS];
+static CnPhaseTimes s_systemPhases[CN_FRAME_STATS_MAX_SYSTEMS][CnFramePhaseNum];
+
+/**
+ * Sums of render stats over drawn frames, which are too large for the 32-bit
+ * counts of a single frame.
+ */
+static struct {
+	uint64_t numFrames;
+	uint64_t drawCalls;
+	uint64_t opaqueDraws;
+	uint64_t translucentDraws;
+	uint64_t pixelsCovered;
+	uint64_t samplesPassed;
+	uint64_t pixelsInFrame;
+	uint64_t gpuNs;
+} s_renderTotals;
+
+static const char* s_phaseNames[CnFramePhaseNum] = {
+	"Begin",
+	"Tick",
+	"Draw",
+	"End",
+	"Total"
+};
+
+void cnFrameStats_Clear(void)
+{
+	for (uint32_t i = 0; i < CnFramePhaseNum; ++i) {
+		cnHistogram_Clear(&s_phases[i]);
+	}
+	memset(s_systemPhases, 0, sizeof(s_systemPhases));
+	memset(&s_renderTotals, 0, sizeof(s_renderTotals));
+}
+
+void cnFrameStats_Record(CnFramePhase phase, CnTime duration)
+{
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+	cnHistogram_Record(&s_phases[phase], duration.native);
+}
+
+/**
+ * Duration which `percentile` percent of the frames recorded for a phase took
+ * at most.  Phases only count frames in which they ran.
+ */
+CnTime cnFrameStats_Percentile(CnFramePhase phase, double percentile)
+{
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+	return (CnTime) { .native = cnHistogram_Percentile(&s_phases[phase], percentile) };
+}
+
+const CnHistogram* cnFrameStats_Histogram(CnFramePhase phase)
+{
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+	return &s_phases[phase];
+}
+
+const char* cnFrameStats_PhaseName(CnFramePhase phase)
+{
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+	return s_phaseNames[phase];
+}
+
+static float cnFrameStats_Ms(uint64_t ns)
+{
+	return (float)ns / 1000000.0f;
+}
+
+void cnFrameStats_Print(void)
+{
+	const int phaseColumnWidth = 10;
+	const int countColumnWidth = 10;
+	const int timeColumnWidth = 10;
+
+	const struct {
+		double percentile;
+		const char* name;
+	} columns[] = {
+		{ 50.0, "p50" },
+		{ 90.0, "p90" },
+		{ 99.0, "p99" },
+		{ 99.9, "p99.9" }
+	};
+
+	cnPrint("\nFrame times (ms)\n");
+
+	cnPrint("%*s    %*s", phaseColumnWidth, "", countColumnWidth, "frames");
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(columns); ++i) {
+		cnPrint("    %*s", timeColumnWidth, columns[i].name);
+	}
+	cnPrint("    %*s\n", timeColumnWidth, "max");
+
+	for (uint32_t phase = 0; phase < CnFramePhaseNum; ++phase) {
+		const CnHistogram* h = &s_phases[phase];
+		cnPrint("%*s    %*" PRIu64, phaseColumnWidth, s_phaseNames[phase], countColumnWidth, h->numValues);
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(columns); ++i) {
+			cnPrint("    %*.3f", timeColumnWidth, cnFrameStats_Ms(cnHistogram_Percentile(h, columns[i].percentile)));
+		}
+		cnPrint("    %*.3f\n", timeColumnWidth, cnFrameStats_Ms(h->max));
+	}
+}
+
+/**
+ * Names the system at an index, for printing and looking up its times.  The
+ * name must outlive the stats.
+ */
+void cnFrameStats_SetSystemName(uint32_t systemIndex, const char* name)
+{
+	CN_ASSERT(systemIndex < CN_FRAME_STATS_MAX_SYSTEMS, "System index out of range: %" PRIu32, systemIndex);
+	CN_ASSERT_PTR(name);
+	s_systemNames[systemIndex] = name;
+}
+
+void cnFrameStats_RecordSystem(uint32_t systemIndex, CnFramePhase phase, CnTime duration)
+{
+	CN_ASSERT(systemIndex < CN_FRAME_STATS_MAX_SYSTEMS, "System index out of range: %" PRIu32, systemIndex);
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+
+	CnPhaseTimes* times = &s_systemPhases[systemIndex][phase];
+	++times->numCalls;
+	times->totalNs += duration.native;
+	if (duration.native > times->maxNs) {
+		times->maxNs = duration.native;
+	}
+	times->recentNs[times->nextRecent] = duration.native;
+	times->nextRecent = (times->nextRecent + 1) % CN_FRAME_STATS_RECENT;
+}
+
+/**
+ * Times of a phase for the system with the given name, or NULL if there is no
+ * such system.
+ */
+const CnPhaseTimes* cnFrameStats_SystemPhase(const char* systemName, CnFramePhase phase)
+{
+	CN_ASSERT_PTR(systemName);
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+
+	for (uint32_t i = 0; i < CN_FRAME_STATS_MAX_SYSTEMS; ++i) {
+		if (s_systemNames[i] && strcmp(s_systemNames[i], systemName) == 0) {
+			return &s_systemPhases[i][phase];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Name of the system at an index, or NULL if no system has that index.
+ */
+const char* cnFrameStats_SystemName(uint32_t systemIndex)
+{
+	CN_ASSERT(systemIndex < CN_FRAME_STATS_MAX_SYSTEMS, "System index out of range: %" PRIu32, systemIndex);
+	return s_systemNames[systemIndex];
+}
+
+const CnPhaseTimes* cnFrameStats_SystemPhaseAt(uint32_t systemIndex, CnFramePhase phase)
+{
+	CN_ASSERT(systemIndex < CN_FRAME_STATS_MAX_SYSTEMS, "System index out of range: %" PRIu32, systemIndex);
+	CN_ASSERT(phase < CnFramePhaseNum, "Invalid frame phase: %d", (int)phase);
+	return &s_systemPhases[systemIndex][phase];
+}
+
+CnTime cnPhaseTimes_Mean(const CnPhaseTimes* times)
+{
+	CN_ASSERT_PTR(times);
+	if (times->numCalls == 0) {
+		return cnTime_MakeZero();
+	}
+	return (CnTime) { .native = times->totalNs / times->numCalls };
+}
+
+/**
+ * Mean of the last `CN_FRAME_STATS_RECENT` durations.
+ */
+CnTime cnPhaseTimes_RecentMean(const CnPhaseTimes* times)
+{
+	CN_ASSERT_PTR(times);
+	const uint64_t numRecent = times->numCalls < CN_FRAME_STATS_RECENT
+		? times->numCalls : CN_FRAME_STATS_RECENT;
+	if (numRecent == 0) {
+		return cnTime_MakeZero();
+	}
+
+	uint64_t total = 0;
+	for (uint32_t i = 0; i < numRecent; ++i) {
+		total += times->recentNs[i];
+	}
+	return (CnTime) { .native = total / numRecent };
+}
+
+CnTime cnPhaseTimes_Max(const CnPhaseTimes* times)
+{
+	CN_ASSERT_PTR(times);
+	return (CnTime) { .native = times->maxNs };
+}
+
+void cnFrameStats_PrintSystems(void)
+{
+	const int systemColumnWidth = 20;
+	const int phaseColumnWidth = 8;
+	const int countColumnWidth = 10;
+	const int timeColumnWidth = 10;
+
+	cnPrint("\nSystem frame times (ms)\n");
+	cnPrint("%*s    %*s    %*s    %*s    %*s    %*s\n",
+		systemColumnWidth, "system", phaseColumnWidth, "phase", countColumnWidth, "calls",
+		timeColumnWidth, "mean", timeColumnWidth, "recent", timeColumnWidth, "max");
+
+	for (uint32_t system = 0; system < CN_FRAME_STATS_MAX_SYSTEMS; ++system) {
+		if (!s_systemNames[system]) {
+			continue;
+		}
+
+		for (uint32_t phase = 0; phase < CnFramePhaseNum; ++phase) {
+			const CnPhaseTimes* times = &s_systemPhases[system][phase];
+			if (times->numCalls == 0) {
+				continue;
+			}
+			cnPrint("%*s    %*s    %*" PRIu64 "    %*.3f    %*.3f    %*.3f\n",
+				systemColumnWidth, s_systemNames[system], phaseColumnWidth, s_phaseNames[phase],
+				countColumnWidth, times->numCalls,
+				timeColumnWidth, cnFrameStats_Ms(cnPhaseTimes_Mean(times).native),
+				timeColumnWidth, cnFrameStats_Ms(cnPhaseTimes_RecentMean(times).native),
+				timeColumnWidth, cnFrameStats_Ms(times->maxNs));
+		}
+	}
+}
+
+/**
+ * Adds the render stats of a drawn frame.  The renderer's stats lag a few
+ * frames behind, so this should be the most recent stats available.  Stats
+ * from before the renderer has finished any frames are empty, and skipped.
+ */
+void cnFrameStats_RecordRender(CnRenderStats stats)
+{
+	if (stats.pixelsInFrame == 0) {
+		return;
+	}
+
+	++s_renderTotals.numFrames;
+	s_renderTotals.drawCalls += stats.drawCalls;
+	s_renderTotals.opaqueDraws += stats.opaqueDraws;
+	s_renderTotals.translucentDraws += stats.translucentDraws;
+	s_renderTotals.pixelsCovered += stats.pixelsCovered;
+	s_renderTotals.samplesPassed += stats.samplesPassed;
+	s_renderTotals.pixelsInFrame += stats.pixelsInFrame;
+	s_renderTotals.gpuNs += stats.gpuNs;
+}
+
+/**
+ * Render stats averaged over all drawn frames, or all zeroes if none were.
+ */
+CnRenderStats cnFrameStats_RenderMean(void)
+{
+	const uint64_t n = s_renderTotals.numFrames;
+	if (n == 0) {
+		return (CnRenderStats) { 0 };
+	}
+	return (CnRenderStats) {
+		.drawCalls = (uint32_t)(s_renderTotals.drawCalls / n),
+		.opaqueDraws = (uint32_t)(s_renderTotals.opaqueDraws / n),
+		.translucentDraws = (uint32_t)(s_renderTotals.translucentDraws / n),
+		.pixelsCovered = s_renderTotals.pixelsCovered / n,
+		.samplesPassed = s_renderTotals.samplesPassed / n,
+		.pixelsInFrame = s_renderTotals.pixelsInFrame / n,
+		.gpuNs = s_renderTotals.gpuNs / n
+	};
+}
+
+/**
+ * Prints draw counts and overdraw per frame.  Overdraw is the pixels covered
+ * or shaded as a multiple of the pixels in the frame, so 1.0 means each pixel
+ * was drawn once.
+ */
+void cnFrameStats_PrintRender(void)
+{
+	if (s_renderTotals.numFrames == 0) {
+		return;
+	}
+
+	const CnRenderStats mean = cnFrameStats_RenderMean();
+	const double pixelsInFrame = mean.pixelsInFrame != 0 ? (double)mean.pixelsInFrame : 1.0;
+
+	cnPrint("\nRender stats (mean of %" PRIu64 " frames)\n", s_renderTotals.numFrames);
+	cnPrint("%20s    %10" PRIu32 "\n", "draw calls", mean.drawCalls);
+	cnPrint("%20s    %10" PRIu32 "\n", "opaque draws", mean.opaqueDraws);
+	cnPrint("%20s    %10" PRIu32 "\n", "translucent draws", mean.translucentDraws);
+	cnPrint("%20s    %10.3f\n", "overdraw covered", (double)mean.pixelsCovered / pixelsInFrame);
+	cnPrint("%20s    %10.3f\n", "overdraw shaded", (double)mean.samplesPassed / pixelsInFrame);
+	cnPrint("%20s    %10.3f\n", "GPU time (ms)", cnFrameStats_Ms(mean.gpuNs));
+}
@@ -0,0 +1,93 @@
+#ifndef CN_FRAME_STATS_H
+#define CN_FRAME_STATS_H
+
+/**
+ * @file frame-stats.h
+ *
+ * Distributions of how long each part of a frame takes.  Tail percentiles show
+ * occasional hitches which averages hide.
+ *
+ * Each system's share of each phase is also tracked, to find which system is
+ * responsible when a phase gets slower.
+ *
+ * Draw counts and overdraw from the renderer are averaged over drawn frames.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/histogram.h>
+#include <calendon/render-resources.h>
+#include <calendon/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	CnFramePhaseBegin,
+	CnFramePhaseTick,
+	CnFramePhaseDraw,
+	CnFramePhaseEnd,
+
+	/**
+	 * Time from the start of one frame to the start of the next, including
+	 * waiting for VSync or the next tick.
+	 */
+	CnFramePhaseTotal,
+
+	CnFramePhaseNum
+} CnFramePhase;
+
+/**
+ * Systems which can have their phases timed.
+ */
+#define CN_FRAME_STATS_MAX_SYSTEMS 16
+
+/**
+ * Number of most recent durations kept, to see current behavior separately
+ * from the whole run.
+ */
+#define CN_FRAME_STATS_RECENT 120
+
+/**
+ * Durations of one phase of one system, in nanoseconds.
+ */
+typedef struct {
+	uint64_t numCalls;
+	uint64_t totalNs;
+	uint64_t maxNs;
+
+	/** Ring of the most recent durations, with the oldest at `nextRecent`. */
+	uint64_t recentNs[CN_FRAME_STATS_RECENT];
+	uint32_t nextRecent;
+} CnPhaseTimes;
+
+CN_TEST_API void cnFrameStats_Clear(void);
+void cnFrameStats_Record(CnFramePhase phase, CnTime duration);
+void cnFrameStats_Print(void);
+
+CN_TEST_API void cnFrameStats_SetSystemName(uint32_t systemIndex, const char* name);
+CN_TEST_API void cnFrameStats_RecordSystem(uint32_t systemIndex, CnFramePhase phase, CnTime duration);
+void cnFrameStats_PrintSystems(void);
+
+CN_TEST_API void cnFrameStats_RecordRender(CnRenderStats stats);
+CN_API CnRenderStats cnFrameStats_RenderMean(void);
+void cnFrameStats_PrintRender(void);
+
+CN_API CnTime cnFrameStats_Percentile(CnFramePhase phase, double percentile);
+CN_API const CnHistogram* cnFrameStats_Histogram(CnFramePhase phase);
+
+CN_API const char* cnFrameStats_PhaseName(CnFramePhase phase);
+CN_API const char* cnFrameStats_SystemName(uint32_t systemIndex);
+
+CN_API const CnPhaseTimes* cnFrameStats_SystemPhase(const char* systemName, CnFramePhase phase);
+CN_API const CnPhaseTimes* cnFrameStats_SystemPhaseAt(uint32_t systemIndex, CnFramePhase phase);
+CN_API CnTime cnPhaseTimes_Mean(const CnPhaseTimes* times);
+CN_API CnTime cnPhaseTimes_RecentMean(const CnPhaseTimes* times);
+CN_API CnTime cnPhaseTimes_Max(const CnPhaseTimes* times);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_FRAME_STATS_H */
@@ -12,27 +12,43 @@ extern "C" {
 #endif
 
 /**
- * Declares a new handle type with its own initialization and create function.
+ * Declares a new handle type with its own initialization, create and release
+ * functions.
  */
 #define CN_DEFINE_HANDLE_TYPE(Type, Prefix, HandleName) \
 	void Prefix ## HandleName ## Init(void); \
-	bool Prefix ## Create ## HandleName(Type* t);
+	bool Prefix ## Create ## HandleName(Type* t); \
+	void Prefix ## Release ## HandleName(Type t);
 
 /**
  * Defines a new type with associated handle counter, maximum value and
- * increment function.
+ * increment function.  Released handles are handed out again before new ones.
  */
 #define CN_DECLARE_HANDLE_TYPE(Type, Prefix, HandleName, maxValue) \
 	static Type next ## HandleName ## Id; \
 	enum { Max ## HandleName ## Id = maxValue }; \
+	static Type released ## HandleName ## Ids[maxValue]; \
+	static uint32_t numReleased ## HandleName ## Ids; \
 	void Prefix ## HandleName ## Init(void) { \
 		next ## HandleName ## Id = 0; \
+		numReleased ## HandleName ## Ids = 0; \
 	} \
 	bool Prefix ## Create ## HandleName (Type* t) { \
 		CN_ASSERT(t != NULL, "Cannot assign a " #HandleName " to a NULL."); \
+		if (numReleased ## HandleName ## Ids > 0) { \
+			*t = released ## HandleName ## Ids[--numReleased ## HandleName ## Ids]; \
+			return true; \
+		} \
 		++ next ## HandleName ## Id; \
 		*t = next ## HandleName ## Id; \
 		return true; \
+	} \
+	void Prefix ## Release ## HandleName (Type t) { \
+		CN_ASSERT(t != 0 && t <= next ## HandleName ## Id, "Cannot release unknown " \
+			#HandleName " %" PRIu32, (uint32_t)t); \
+		CN_ASSERT(numReleased ## HandleName ## Ids < maxValue, "Too many " #HandleName \
+			" handles released."); \
+		released ## HandleName ## Ids[numReleased ## HandleName ## Ids++] = t; \
 	}
 
 #ifdef __cplusplus
@@ -0,0 +1,109 @@
+#include "histogram.h"
+
+#include <string.h>
+
+#define CN_HISTOGRAM_SUB_BUCKETS (1u << CN_HISTOGRAM_SUB_BUCKET_BITS)
+
+/**
+ * Index of the highest set bit.  `value` must be non-zero.
+ */
+static uint32_t cnHistogram_HighestBit(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return 63 - (uint32_t)__builtin_clzll(value);
+#else
+	uint32_t bit = 0;
+	while (value >>= 1) {
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+/**
+ * Small values each get their own bucket.  Larger values are grouped by their
+ * highest bit, and then split by the bits right below it.
+ */
+uint32_t cnHistogram_BucketIndex(uint64_t value)
+{
+	if (value < CN_HISTOGRAM_SUB_BUCKETS) {
+		return (uint32_t)value;
+	}
+
+	const uint32_t highestBit = cnHistogram_HighestBit(value);
+	if (highestBit >= CN_HISTOGRAM_MAX_BITS) {
+		return CN_HISTOGRAM_NUM_BUCKETS - 1;
+	}
+
+	const uint32_t shift = highestBit - CN_HISTOGRAM_SUB_BUCKET_BITS;
+	const uint32_t subBucket = (uint32_t)(value >> shift) & (CN_HISTOGRAM_SUB_BUCKETS - 1);
+	return ((shift + 1) << CN_HISTOGRAM_SUB_BUCKET_BITS) + subBucket;
+}
+
+/**
+ * The largest value which goes into a bucket.
+ */
+uint64_t cnHistogram_BucketUpperBound(uint32_t bucketIndex)
+{
+	CN_ASSERT(bucketIndex < CN_HISTOGRAM_NUM_BUCKETS, "Bucket index out of range: %" PRIu32, bucketIndex);
+
+	if (bucketIndex < CN_HISTOGRAM_SUB_BUCKETS) {
+		return bucketIndex;
+	}
+	if (bucketIndex == CN_HISTOGRAM_NUM_BUCKETS - 1) {
+		return UINT64_MAX;
+	}
+
+	const uint32_t shift = (bucketIndex >> CN_HISTOGRAM_SUB_BUCKET_BITS) - 1;
+	const uint64_t subBucket = bucketIndex & (CN_HISTOGRAM_SUB_BUCKETS - 1);
+	return ((CN_HISTOGRAM_SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+void cnHistogram_Clear(CnHistogram* h)
+{
+	CN_ASSERT_PTR(h);
+	memset(h, 0, sizeof(CnHistogram));
+	h->min = UINT64_MAX;
+}
+
+void cnHistogram_Record(CnHistogram* h, uint64_t value)
+{
+	CN_ASSERT_PTR(h);
+
+	++h->counts[cnHistogram_BucketIndex(value)];
+	++h->numValues;
+	if (value < h->min) h->min = value;
+	if (value > h->max) h->max = value;
+}
+
+/**
+ * The value which `percentile` percent of recorded values are at or below,
+ * such as 99.9 for the slowest one in a thousand frames.  Values are rounded up
+ * to the top of their bucket, but never past the largest value recorded.
+ *
+ * Returns 0 if nothing has been recorded.
+ */
+uint64_t cnHistogram_Percentile(const CnHistogram* h, double percentile)
+{
+	CN_ASSERT_PTR(h);
+	CN_ASSERT(percentile >= 0.0 && percentile <= 100.0, "Percentile out of range: %f", percentile);
+
+	if (h->numValues == 0) {
+		return 0;
+	}
+
+	// The rank of the value to find, counting from 1.
+	uint64_t rank = (uint64_t)(percentile / 100.0 * (double)h->numValues + 0.5);
+	if (rank == 0) rank = 1;
+	if (rank > h->numValues) rank = h->numValues;
+
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < CN_HISTOGRAM_NUM_BUCKETS; ++i) {
+		seen += h->counts[i];
+		if (seen >= rank) {
+			const uint64_t upperBound = cnHistogram_BucketUpperBound(i);
+			return upperBound < h->max ? upperBound : h->max;
+		}
+	}
+	return h->max;
+}
@@ -0,0 +1,55 @@
+#ifndef CN_HISTOGRAM_H
+#define CN_HISTOGRAM_H
+
+/**
+ * @file histogram.h
+ *
+ * Counts of values in fixed buckets which grow logarithmically, to find
+ * percentiles of things like frame times without storing every sample.
+ *
+ * Each power of two is split into a few equally sized buckets, so any value is
+ * reported within about 12% of its actual value, regardless of magnitude.
+ * Recording is constant time and the histogram never allocates.
+ */
+
+#include <calendon/cn.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Each power of two range is split into 2^CN_HISTOGRAM_SUB_BUCKET_BITS buckets.
+ */
+#define CN_HISTOGRAM_SUB_BUCKET_BITS 3
+
+/**
+ * Values at or above 2^CN_HISTOGRAM_MAX_BITS are all counted in the last
+ * bucket.  In nanoseconds, this is over 18 minutes.
+ */
+#define CN_HISTOGRAM_MAX_BITS 40
+
+#define CN_HISTOGRAM_NUM_BUCKETS \
+	((CN_HISTOGRAM_MAX_BITS - CN_HISTOGRAM_SUB_BUCKET_BITS + 1) << CN_HISTOGRAM_SUB_BUCKET_BITS)
+
+typedef struct {
+	uint64_t counts[CN_HISTOGRAM_NUM_BUCKETS];
+	uint64_t numValues;
+
+	/** Exact extremes, since the buckets only have approximate values. */
+	uint64_t min;
+	uint64_t max;
+} CnHistogram;
+
+CN_API void     cnHistogram_Clear(CnHistogram* h);
+CN_API void     cnHistogram_Record(CnHistogram* h, uint64_t value);
+CN_API uint64_t cnHistogram_Percentile(const CnHistogram* h, double percentile);
+
+CN_TEST_API uint32_t cnHistogram_BucketIndex(uint64_t value);
+CN_TEST_API uint64_t cnHistogram_BucketUpperBound(uint32_t bucketIndex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_HISTOGRAM_H */
@@ -5,6 +5,7 @@
 #include <calendon/assets-fileio.h>
 #include <calendon/compat-spng.h>
 #include <calendon/log.h>
+#include <calendon/profile.h>
 #include <string.h>
 
 extern CnLogHandle LogSysAssets;
@@ -16,9 +17,6 @@ void cnImageRGBA8_Flip(CnImageRGBA8* image)
 	CN_ASSERT(image->width > 0, "Cannot flip an image with no width.");
 	CN_ASSERT(image->height > 0, "Cannot flip an image with no height.");
 
-	CnDynamicBuffer flippedImage;
-	cnDynamicBuffer_Allocate(&flippedImage, image->pixels.size);
-
 	// Assume RGBA8 encoding.
 	const uint32_t pixelSize = 4 * sizeof(uint8_t);
 
@@ -30,22 +28,16 @@ void cnImageRGBA8_Flip(CnImageRGBA8* image)
 
 	const uint32_t rowSize = pixelSize * image->width;
 
-	uint8_t* from = NULL;
-	uint8_t* to = NULL;
-
-	// Flip one row at a time.
-	for (uint32_t i = 0; i < image->height; ++i) {
-		from = (uint8_t*)flippedImage.contents + rowSize * (image->height - i - 1);
-		to = (uint8_t*)image->pixels.contents + rowSize * i;
-		memcpy(from, to, rowSize);
+	// Swap rows from the top and bottom in place, so only a single row of
+	// scratch space is needed.
+	uint8_t* scratch = cnFrameArena_Alloc(rowSize, 16);
+	for (uint32_t i = 0; i < image->height / 2; ++i) {
+		uint8_t* top = (uint8_t*)image->pixels.contents + rowSize * i;
+		uint8_t* bottom = (uint8_t*)image->pixels.contents + rowSize * (image->height - i - 1);
+		memcpy(scratch, top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, scratch, rowSize);
 	}
-
-	// Swap the buffer content pointers.
-	char* temp = image->pixels.contents;
-	image->pixels.contents = flippedImage.contents;
-	flippedImage.contents = temp;
-
-	cnDynamicBuffer_Free(&flippedImage);
 }
 
 /**
@@ -56,12 +48,14 @@ void cnImageRGBA8_Flip(CnImageRGBA8* image)
  */
 bool cnImageRGBA8_Allocate(CnImageRGBA8* image, const char* fileName)
 {
+	CN_PROFILE_BEGIN(__func__);
 	CN_ASSERT(image != NULL, "Cannot load data into a null image.");
 	CN_ASSERT(fileName != NULL, "Cannot load an image with a null file name.");
 	CnDynamicBuffer fileBuffer;
 
 	if (!cnAssets_ReadFile(fileName, CnFileTypeBinary, &fileBuffer)) {
 		CN_WARN(LogSysAssets, "Unable to load image from %s", fileName);
+		CN_PROFILE_END();
 		return false;
 	}
 
@@ -93,6 +87,7 @@ bool cnImageRGBA8_Allocate(CnImageRGBA8* image, const char* fileName)
 
 	cnDynamicBuffer_Free(&fileBuffer);
 
+	CN_PROFILE_END();
 	return true;
 }
 
@@ -0,0 +1,56 @@
+#include "input-events.h"
+
+#define CN_INPUT_EVENT_QUEUE_MASK (CN_INPUT_EVENT_QUEUE_CAPACITY - 1)
+
+CN_STATIC_ASSERT((CN_INPUT_EVENT_QUEUE_CAPACITY & CN_INPUT_EVENT_QUEUE_MASK) == 0,
+	"Input event queue capacity must be a power of two.");
+
+void cnInputEventQueue_Clear(CnInputEventQueue* queue)
+{
+	CN_ASSERT_PTR(queue);
+	queue->head = 0;
+	queue->count = 0;
+	queue->numDropped = 0;
+}
+
+/**
+ * Adds an event after all others, dropping the oldest event if full.
+ */
+void cnInputEventQueue_Push(CnInputEventQueue* queue, const CnInputEvent* event)
+{
+	CN_ASSERT_PTR(queue);
+	CN_ASSERT_PTR(event);
+
+	if (queue->count == CN_INPUT_EVENT_QUEUE_CAPACITY) {
+		queue->head = (queue->head + 1) & CN_INPUT_EVENT_QUEUE_MASK;
+		--queue->count;
+		++queue->numDropped;
+	}
+
+	queue->events[(queue->head + queue->count) & CN_INPUT_EVENT_QUEUE_MASK] = *event;
+	++queue->count;
+}
+
+/**
+ * Removes the oldest event.  Returns false if there are no events.
+ */
+bool cnInputEventQueue_Pop(CnInputEventQueue* queue, CnInputEvent* event)
+{
+	CN_ASSERT_PTR(queue);
+	CN_ASSERT_PTR(event);
+
+	if (queue->count == 0) {
+		return false;
+	}
+
+	*event = queue->events[queue->head];
+	queue->head = (queue->head + 1) & CN_INPUT_EVENT_QUEUE_MASK;
+	--queue->count;
+	return true;
+}
+
+uint32_t cnInputEventQueue_Count(const CnInputEventQueue* queue)
+{
+	CN_ASSERT_PTR(queue);
+	return queue->count;
+}
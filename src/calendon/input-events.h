@@ -0,0 +1,84 @@
+#ifndef CN_INPUT_EVENTS_H
+#define CN_INPUT_EVENTS_H
+
+/**
+ * @file input-events.h
+ *
+ * Individual input events in the order they happened, each with the time it
+ * happened.
+ *
+ * Key sets and the mouse only show the latest state, so a key pressed and
+ * released within one frame is never seen.  Events keep every change, and
+ * their times allow measuring how long input waits before being acted on.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/compat-sdl.h>
+#include <calendon/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Events held before the oldest start being dropped.  Must be a power of two.
+ */
+#define CN_INPUT_EVENT_QUEUE_CAPACITY 256
+
+typedef enum {
+	CnInputEventKeyDown,
+	CnInputEventKeyUp,
+	CnInputEventMouseMove,
+	CnInputEventMouseButtonDown,
+	CnInputEventMouseButtonUp,
+	CnInputEventMouseWheel
+} CnInputEventType;
+
+typedef struct {
+	CnInputEventType type;
+
+	/** When the event happened, on the same clock as `cnTime_MakeNow`. */
+	CnTime time;
+
+	/** The key for key events. */
+	SDL_Keycode key;
+
+	/** True for key downs generated by a key being held. */
+	bool repeat;
+
+	/** The SDL button number for mouse button events. */
+	uint8_t button;
+
+	/** Mouse position for mouse events, with the origin in the bottom left. */
+	int32_t x, y;
+
+	/** Mouse movement, or wheel scrolling. */
+	int32_t dx, dy;
+} CnInputEvent;
+
+/**
+ * A ring buffer of events.  When full, the oldest event is dropped to make
+ * room for a new one.
+ */
+typedef struct {
+	CnInputEvent events[CN_INPUT_EVENT_QUEUE_CAPACITY];
+
+	/** Index of the oldest event. */
+	uint32_t head;
+	uint32_t count;
+
+	/** Events dropped because the queue was full. */
+	uint64_t numDropped;
+} CnInputEventQueue;
+
+CN_API void     cnInputEventQueue_Clear(CnInputEventQueue* queue);
+CN_API void     cnInputEventQueue_Push(CnInputEventQueue* queue, const CnInputEvent* event);
+CN_API bool     cnInputEventQueue_Pop(CnInputEventQueue* queue, CnInputEvent* event);
+CN_API uint32_t cnInputEventQueue_Count(const CnInputEventQueue* queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_INPUT_EVENTS_H */
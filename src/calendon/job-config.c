@@ -0,0 +1,65 @@
+#include "job-config.h"
+
+#include <calendon/cn.h>
+
+#include <errno.h>
+
+int32_t cnJob_OptionThreads(const CnCommandLineParse* parse, void* c);
+
+static CnJobConfig s_config;
+static CnCommandLineOption options[] = {
+	{
+		"\t--job-threads NUM_THREADS\n"
+			"\t\tRun jobs on NUM_THREADS threads, including the main thread.\n"
+			"\t\tDefaults to one per core.\n",
+		NULL,
+		"--job-threads",
+		cnJob_OptionThreads
+	},
+};
+
+CnCommandLineOptionList cnJob_CommandLineOptionList(void) {
+	CnCommandLineOptionList optionList;
+	optionList.options = options;
+	optionList.numOptions = 1;
+	return optionList;
+}
+
+int32_t cnJob_OptionThreads(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnJobConfig* config = (CnJobConfig*)c;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a number of threads to run jobs on.\n");
+		return CnOptionParseError;
+	}
+
+	const char* threadsString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(threadsString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse number of job threads: %s\n", threadsString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue <= 0 || parsedValue > 64) {
+		cnPrint("Job threads must be between 1 and 64: %s\n", threadsString);
+		return CnOptionParseError;
+	}
+	config->numThreads = (uint32_t)parsedValue;
+	return 2;
+}
+
+void* cnJob_Config(void) {
+	return &s_config;
+}
+
+void cnJob_SetDefaultConfig(void* config)
+{
+	CnJobConfig* c = (CnJobConfig*)config;
+	c->numThreads = 0;
+}
@@ -0,0 +1,19 @@
+#ifndef CN_JOB_CONFIG_H
+#define CN_JOB_CONFIG_H
+
+#include <calendon/cn.h>
+#include <calendon/system.h>
+
+typedef struct {
+	/**
+	 * Threads running jobs, including the main thread, or zero for one per
+	 * core.
+	 */
+	uint32_t numThreads;
+} CnJobConfig;
+
+CnCommandLineOptionList cnJob_CommandLineOptionList(void);
+void* cnJob_Config(void);
+void cnJob_SetDefaultConfig(void* config);
+
+#endif /* CN_JOB_CONFIG_H */
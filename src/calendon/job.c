@@ -0,0 +1,580 @@
+#include "job.h"
+
+#include <calendon/atomic.h>
+#include <calendon/job-config.h>
+
+#ifdef _WIN32
+#include <calendon/compat-windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Most threads which can run jobs, including the main thread.
+ */
+#define CN_JOB_MAX_THREADS 64
+
+/**
+ * Jobs which can be queued on a single thread.  Jobs started while its queue is
+ * full run immediately instead.  Must be a power of two.
+ */
+#define CN_JOB_QUEUE_CAPACITY 4096
+#define CN_JOB_QUEUE_MASK (CN_JOB_QUEUE_CAPACITY - 1)
+
+/**
+ * Jobs a thread can set aside while their dependencies finish.  Once full, the
+ * thread helps finish the dependency instead.
+ */
+#define CN_JOB_DEFERRED_CAPACITY 64
+
+/**
+ * Number of times an idle worker looks for work before going to sleep.
+ */
+#define CN_JOB_IDLE_SPINS 64
+
+/**
+ * Thread index of threads which aren't part of the job system.
+ */
+#define CN_JOB_NOT_A_WORKER UINT32_MAX
+
+typedef struct {
+	CnJobFn fn;
+
+	/** Set instead of `fn` for jobs processing part of a range. */
+	CnJobRangeFn rangeFn;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t grain;
+
+	void* context;
+
+	/** Decremented when the job finishes, may be NULL. */
+	CnJobCounter* counter;
+
+	/** The job doesn't start until this counter reaches zero, may be NULL. */
+	const CnJobCounter* dependency;
+} CnJob;
+
+/**
+ * A Chase-Lev work-stealing deque.  The owning thread pushes and takes jobs at
+ * the bottom, other threads steal from the top.  Only stealing and taking the
+ * last job need an atomic exchange.
+ *
+ * "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al. 2013
+ */
+typedef struct {
+	volatile int64_t top;
+
+	/** Keeps thieves writing `top` from invalidating the owner's `bottom`. */
+	char padding[64 - sizeof(int64_t)];
+
+	volatile int64_t bottom;
+	CnJob jobs[CN_JOB_QUEUE_CAPACITY];
+
+	/**
+	 * Jobs found waiting on a dependency, only touched by the owning thread.
+	 * Keeping them out of the queue lets the thread get to runnable jobs
+	 * beneath them, rather than taking the same blocked job over and over.
+	 */
+	CnJob deferred[CN_JOB_DEFERRED_CAPACITY];
+	uint32_t numDeferred;
+} CnJobQueue;
+
+static CnJobQueue* s_queues[CN_JOB_MAX_THREADS];
+static uint32_t s_numThreads;
+static volatile uint32_t s_running;
+
+/**
+ * Jobs queued but not yet taken, so sleeping workers know when to wake up.
+ */
+static volatile uint32_t s_numQueued;
+static volatile uint32_t s_numSleeping;
+
+static CN_THREAD_LOCAL uint32_t t_threadIndex = CN_JOB_NOT_A_WORKER;
+static CN_THREAD_LOCAL uint32_t t_nextVictim;
+
+#ifdef _WIN32
+
+static HANDLE s_threads[CN_JOB_MAX_THREADS];
+static SRWLOCK s_sleepLock = SRWLOCK_INIT;
+static CONDITION_VARIABLE s_wakeUp = CONDITION_VARIABLE_INIT;
+
+static uint32_t cnJob_NumCores(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (uint32_t)info.dwNumberOfProcessors;
+}
+
+static void cnJob_Yield(void)
+{
+	SwitchToThread();
+}
+
+static void cnJob_Lock(void)   { AcquireSRWLockExclusive(&s_sleepLock); }
+static void cnJob_Unlock(void) { ReleaseSRWLockExclusive(&s_sleepLock); }
+static void cnJob_Sleep(void)  { SleepConditionVariableSRW(&s_wakeUp, &s_sleepLock, INFINITE, 0); }
+static void cnJob_WakeOne(void) { WakeConditionVariable(&s_wakeUp); }
+static void cnJob_WakeAll(void) { WakeAllConditionVariable(&s_wakeUp); }
+
+static void cnJob_WorkerMain(uint32_t threadIndex);
+
+static DWORD WINAPI cnJob_ThreadMain(LPVOID param)
+{
+	cnJob_WorkerMain((uint32_t)(uintptr_t)param);
+	return 0;
+}
+
+static bool cnJob_StartThread(uint32_t threadIndex)
+{
+	s_threads[threadIndex] = CreateThread(NULL, 0, cnJob_ThreadMain,
+		(LPVOID)(uintptr_t)threadIndex, 0, NULL);
+	return s_threads[threadIndex] != NULL;
+}
+
+static void cnJob_JoinThread(uint32_t threadIndex)
+{
+	WaitForSingleObject(s_threads[threadIndex], INFINITE);
+	CloseHandle(s_threads[threadIndex]);
+}
+
+#else
+
+static pthread_t s_threads[CN_JOB_MAX_THREADS];
+static pthread_mutex_t s_sleepLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_wakeUp = PTHREAD_COND_INITIALIZER;
+
+static uint32_t cnJob_NumCores(void)
+{
+	const long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+	return numCores > 0 ? (uint32_t)numCores : 1;
+}
+
+static void cnJob_Yield(void)
+{
+	sched_yield();
+}
+
+static void cnJob_Lock(void)   { pthread_mutex_lock(&s_sleepLock); }
+static void cnJob_Unlock(void) { pthread_mutex_unlock(&s_sleepLock); }
+static void cnJob_Sleep(void)  { pthread_cond_wait(&s_wakeUp, &s_sleepLock); }
+static void cnJob_WakeOne(void) { pthread_cond_signal(&s_wakeUp); }
+static void cnJob_WakeAll(void) { pthread_cond_broadcast(&s_wakeUp); }
+
+static void cnJob_WorkerMain(uint32_t threadIndex);
+
+static void* cnJob_ThreadMain(void* param)
+{
+	cnJob_WorkerMain((uint32_t)(uintptr_t)param);
+	return NULL;
+}
+
+static bool cnJob_StartThread(uint32_t threadIndex)
+{
+	return pthread_create(&s_threads[threadIndex], NULL, cnJob_ThreadMain,
+		(void*)(uintptr_t)threadIndex) == 0;
+}
+
+static void cnJob_JoinThread(uint32_t threadIndex)
+{
+	pthread_join(s_threads[threadIndex], NULL);
+}
+
+#endif /* _WIN32 */
+
+/**
+ * Adds a job to the bottom of the calling thread's own queue.  Returns false if
+ * the queue is full.
+ */
+static bool cnJobQueue_Push(CnJobQueue* queue, const CnJob* job)
+{
+	const int64_t bottom = cnAtomic_LoadI64(&queue->bottom);
+	const int64_t top = cnAtomic_LoadI64(&queue->top);
+	if (bottom - top >= CN_JOB_QUEUE_CAPACITY) {
+		return false;
+	}
+
+	queue->jobs[bottom & CN_JOB_QUEUE_MASK] = *job;
+
+	// Releasing the new bottom publishes the job to thieves.
+	cnAtomic_StoreI64(&queue->bottom, bottom + 1);
+	return true;
+}
+
+/**
+ * Takes the most recently pushed job from the calling thread's own queue.
+ */
+static bool cnJobQueue_Take(CnJobQueue* queue, CnJob* job)
+{
+	const int64_t bottom = cnAtomic_LoadI64(&queue->bottom) - 1;
+	cnAtomic_StoreI64(&queue->bottom, bottom);
+
+	// Claiming the bottom job must be visible before checking for thieves
+	// going after it.
+	cnAtomic_ThreadFence();
+	const int64_t top = cnAtomic_LoadI64(&queue->top);
+
+	if (top > bottom) {
+		// Empty.
+		cnAtomic_StoreI64(&queue->bottom, bottom + 1);
+		return false;
+	}
+
+	*job = queue->jobs[bottom & CN_JOB_QUEUE_MASK];
+	if (top < bottom) {
+		return true;
+	}
+
+	// Racing thieves for the last job.
+	const bool taken = cnAtomic_CompareExchangeI64(&queue->top, top, top + 1);
+	cnAtomic_StoreI64(&queue->bottom, bottom + 1);
+	return taken;
+}
+
+/**
+ * Takes the oldest job from another thread's queue.
+ */
+static bool cnJobQueue_Steal(CnJobQueue* queue, CnJob* job)
+{
+	const int64_t top = cnAtomic_LoadI64(&queue->top);
+	cnAtomic_ThreadFence();
+	const int64_t bottom = cnAtomic_LoadI64(&queue->bottom);
+	if (top >= bottom) {
+		return false;
+	}
+
+	// The copy might be overwritten while being made, but only if another
+	// thread took this job first, in which case the exchange fails.
+	*job = queue->jobs[top & CN_JOB_QUEUE_MASK];
+	return cnAtomic_CompareExchangeI64(&queue->top, top, top + 1);
+}
+
+static bool cnJob_IsParallel(void)
+{
+	return s_numThreads > 1 && t_threadIndex != CN_JOB_NOT_A_WORKER;
+}
+
+static void cnJob_Execute(CnJob* job);
+
+/**
+ * Queues a job on the calling thread, or runs it immediately if it can't be
+ * queued.
+ */
+static void cnJob_Submit(CnJob* job)
+{
+	if (job->counter) {
+		cnAtomic_FetchAddU32(&job->counter->remaining, 1);
+	}
+
+	if (!cnJob_IsParallel() || !cnJobQueue_Push(s_queues[t_threadIndex], job)) {
+		if (job->dependency) {
+			cnJob_Wait((CnJobCounter*)job->dependency);
+		}
+		cnJob_Execute(job);
+		return;
+	}
+
+	cnAtomic_FetchAddU32(&s_numQueued, 1);
+
+	// Pairs with the fence in cnJob_WorkerSleep, so either the sleeper sees
+	// the new job, or this sees the sleeper.
+	cnAtomic_ThreadFence();
+	if (cnAtomic_LoadU32(&s_numSleeping) != 0) {
+		cnJob_Lock();
+		cnJob_WakeOne();
+		cnJob_Unlock();
+	}
+}
+
+static void cnJob_Execute(CnJob* job)
+{
+	if (job->rangeFn) {
+		// Give away the upper half of large ranges, so idle threads steal big
+		// pieces of work rather than many small ones.
+		while (job->end - job->begin > job->grain) {
+			CnJob upper = *job;
+			upper.begin = job->begin + (job->end - job->begin) / 2;
+			job->end = upper.begin;
+			cnJob_Submit(&upper);
+		}
+		job->rangeFn(job->begin, job->end, job->context);
+	}
+	else {
+		job->fn(job->context);
+	}
+
+	if (job->counter) {
+		cnAtomic_FetchSubU32(&job->counter->remaining, 1);
+	}
+}
+
+/**
+ * Takes a job from the calling thread's queue, or from another thread's if its
+ * own is empty.
+ */
+static bool cnJob_Find(CnJob* job)
+{
+	bool found = cnJobQueue_Take(s_queues[t_threadIndex], job);
+	for (uint32_t i = 0; !found && i < s_numThreads - 1; ++i) {
+		t_nextVictim = (t_nextVictim + 1) % s_numThreads;
+		if (t_nextVictim != t_threadIndex) {
+			found = cnJobQueue_Steal(s_queues[t_nextVictim], job);
+		}
+	}
+	if (found) {
+		cnAtomic_FetchSubU32(&s_numQueued, 1);
+	}
+	return found;
+}
+
+/**
+ * Runs one job which is ready, either one set aside earlier whose dependency
+ * has since finished, or a new one from a queue.  Returns false if there was
+ * nothing which could be run.
+ */
+static bool cnJob_RunOne(void)
+{
+	CnJobQueue* own = s_queues[t_threadIndex];
+
+	CnJob job;
+	for (uint32_t i = 0; i < own->numDeferred; ++i) {
+		if (cnJob_IsDone(own->deferred[i].dependency)) {
+			job = own->deferred[i];
+			own->deferred[i] = own->deferred[--own->numDeferred];
+			cnJob_Execute(&job);
+			return true;
+		}
+	}
+
+	while (cnJob_Find(&job)) {
+		if (!job.dependency || cnJob_IsDone(job.dependency)) {
+			cnJob_Execute(&job);
+			return true;
+		}
+
+		// Set it aside and look for other work, unless there's no room, in
+		// which case help finish the dependency instead.
+		if (own->numDeferred < CN_JOB_DEFERRED_CAPACITY) {
+			own->deferred[own->numDeferred++] = job;
+			continue;
+		}
+		cnJob_Wait((CnJobCounter*)job.dependency);
+		cnJob_Execute(&job);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Returns jobs set aside by this thread to its queue, so other threads can run
+ * them once they are ready.
+ */
+static void cnJob_ReturnDeferred(void)
+{
+	CnJobQueue* own = s_queues[t_threadIndex];
+	while (own->numDeferred > 0) {
+		CnJob* job = &own->deferred[own->numDeferred - 1];
+		if (!cnJobQueue_Push(own, job)) {
+			return;
+		}
+		--own->numDeferred;
+		cnAtomic_FetchAddU32(&s_numQueued, 1);
+	}
+}
+
+static void cnJob_WorkerSleep(void)
+{
+	cnJob_Lock();
+	cnAtomic_FetchAddU32(&s_numSleeping, 1);
+	cnAtomic_ThreadFence();
+	while (cnAtomic_LoadU32(&s_running) && cnAtomic_LoadU32(&s_numQueued) == 0) {
+		cnJob_Sleep();
+	}
+	cnAtomic_FetchSubU32(&s_numSleeping, 1);
+	cnJob_Unlock();
+}
+
+static void cnJob_WorkerMain(uint32_t threadIndex)
+{
+	t_threadIndex = threadIndex;
+	t_nextVictim = threadIndex;
+
+	uint32_t idleSpins = 0;
+	while (cnAtomic_LoadU32(&s_running)) {
+		if (cnJob_RunOne()) {
+			idleSpins = 0;
+			continue;
+		}
+
+		// Sleeping with jobs set aside could leave them stranded, so keep
+		// checking on their dependencies instead.
+		if (++idleSpins < CN_JOB_IDLE_SPINS || s_queues[threadIndex]->numDeferred != 0) {
+			cnJob_Yield();
+		}
+		else {
+			cnJob_WorkerSleep();
+			idleSpins = 0;
+		}
+	}
+}
+
+/**
+ * Threads running jobs, including the main thread.
+ */
+uint32_t cnJob_NumThreads(void)
+{
+	return s_numThreads > 0 ? s_numThreads : 1;
+}
+
+/**
+ * Starts a job.  If `counter` is provided, it is incremented now and
+ * decremented once the job finishes.
+ */
+void cnJob_Run(CnJobFn fn, void* context, CnJobCounter* counter)
+{
+	cnJob_RunAfter(fn, context, counter, NULL);
+}
+
+/**
+ * Starts a job which won't run until all jobs counted by `dependency` finish.
+ */
+void cnJob_RunAfter(CnJobFn fn, void* context, CnJobCounter* counter, const CnJobCounter* dependency)
+{
+	CN_ASSERT_PTR(fn);
+
+	CnJob job = {
+		.fn = fn,
+		.context = context,
+		.counter = counter,
+		.dependency = dependency
+	};
+	cnJob_Submit(&job);
+}
+
+bool cnJob_IsDone(const CnJobCounter* counter)
+{
+	CN_ASSERT_PTR(counter);
+	return cnAtomic_LoadU32(&counter->remaining) == 0;
+}
+
+/**
+ * Waits for all jobs started with `counter` to finish, running other jobs in
+ * the meantime.
+ */
+void cnJob_Wait(CnJobCounter* counter)
+{
+	CN_ASSERT_PTR(counter);
+
+	while (!cnJob_IsDone(counter)) {
+		if (!cnJob_IsParallel() || !cnJob_RunOne()) {
+			cnJob_Yield();
+		}
+	}
+
+	// The caller might not run jobs again for a while.
+	if (cnJob_IsParallel()) {
+		cnJob_ReturnDeferred();
+	}
+}
+
+/**
+ * Calls `fn` over `[0, count)` split into pieces of at most `grain` elements,
+ * spread across threads, and returns once they have all finished.  The grain
+ * should be large enough that each piece is worth the overhead of a job.
+ */
+void cnJob_ParallelFor(uint32_t count, uint32_t grain, CnJobRangeFn fn, void* context)
+{
+	CN_ASSERT_PTR(fn);
+	CN_ASSERT(grain > 0, "Parallel for must have a non-zero grain size.");
+
+	if (count == 0) {
+		return;
+	}
+
+	CnJobCounter counter = { 0 };
+	CnJob job = {
+		.rangeFn = fn,
+		.begin = 0,
+		.end = count,
+		.grain = grain,
+		.context = context,
+		.counter = &counter
+	};
+
+	// The calling thread does the first piece itself.
+	counter.remaining = 1;
+	cnJob_Execute(&job);
+	cnJob_Wait(&counter);
+}
+
+static bool cnJob_Init(void)
+{
+	const CnJobConfig* config = (CnJobConfig*)cnJob_Config();
+	uint32_t numThreads = config->numThreads != 0 ? config->numThreads : cnJob_NumCores();
+	if (numThreads > CN_JOB_MAX_THREADS) {
+		numThreads = CN_JOB_MAX_THREADS;
+	}
+
+	for (uint32_t i = 0; i < numThreads; ++i) {
+		s_queues[i] = calloc(1, sizeof(CnJobQueue));
+		if (!s_queues[i]) {
+			CN_FATAL_ERROR("Unable to allocate job queue.");
+		}
+	}
+
+	// The main thread is the first to run jobs, and does so while waiting.
+	s_numThreads = numThreads;
+	t_threadIndex = 0;
+	t_nextVictim = 0;
+	s_numQueued = 0;
+	s_numSleeping = 0;
+	cnAtomic_StoreU32(&s_running, 1);
+
+	for (uint32_t i = 1; i < numThreads; ++i) {
+		if (!cnJob_StartThread(i)) {
+			CN_FATAL_ERROR("Unable to start job thread %" PRIu32, i);
+		}
+	}
+	return true;
+}
+
+static void cnJob_Shutdown(void)
+{
+	cnAtomic_StoreU32(&s_running, 0);
+	cnJob_Lock();
+	cnJob_WakeAll();
+	cnJob_Unlock();
+
+	for (uint32_t i = 1; i < s_numThreads; ++i) {
+		cnJob_JoinThread(i);
+	}
+	for (uint32_t i = 0; i < s_numThreads; ++i) {
+		free(s_queues[i]);
+		s_queues[i] = NULL;
+	}
+	s_numThreads = 0;
+	t_threadIndex = CN_JOB_NOT_A_WORKER;
+}
+
+static const char* cnJob_Name(void)
+{
+	return "Job";
+}
+
+CnSystem cnJob_System(void)
+{
+	return (CnSystem) {
+		.name             = cnJob_Name,
+		.options          = cnJob_CommandLineOptionList,
+		.config           = cnJob_Config,
+		.setDefaultConfig = cnJob_SetDefaultConfig,
+
+		.init             = cnJob_Init,
+		.shutdown         = cnJob_Shutdown,
+		.sharedLibrary    = NULL,
+
+		.behavior         = cnSystem_NoBehavior()
+	};
+}
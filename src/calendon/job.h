@@ -0,0 +1,58 @@
+#ifndef CN_JOB_H
+#define CN_JOB_H
+
+/**
+ * @file job.h
+ *
+ * Runs small functions (jobs) on a pool of worker threads, one per core.
+ *
+ * Each thread keeps its own queue of jobs, and threads which run out of jobs
+ * steal from the others.  Jobs started together share a counter, and waiting
+ * on the counter runs queued jobs until they have all finished, so the waiting
+ * thread helps rather than blocking.  This makes it safe for jobs to start and
+ * wait on other jobs.
+ *
+ * Jobs can only be started from the main thread or from within other jobs.
+ * With a single thread, or before the job system starts, jobs run immediately
+ * on the calling thread.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/system.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*CnJobFn)(void* context);
+
+/**
+ * Processes elements `[begin, end)` of a range being split across threads.
+ */
+typedef void (*CnJobRangeFn)(uint32_t begin, uint32_t end, void* context);
+
+/**
+ * Jobs started with a counter which haven't finished.  Zero initialize before
+ * use.
+ */
+typedef struct {
+	volatile uint32_t remaining;
+} CnJobCounter;
+
+CN_API CnSystem cnJob_System(void);
+
+CN_API uint32_t cnJob_NumThreads(void);
+
+CN_API void cnJob_Run(CnJobFn fn, void* context, CnJobCounter* counter);
+CN_API void cnJob_RunAfter(CnJobFn fn, void* context, CnJobCounter* counter, const CnJobCounter* dependency);
+CN_API bool cnJob_IsDone(const CnJobCounter* counter);
+CN_API void cnJob_Wait(CnJobCounter* counter);
+
+CN_API void cnJob_ParallelFor(uint32_t count, uint32_t grain, CnJobRangeFn fn, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_JOB_H */
@@ -0,0 +1,26 @@
+#include "json.h"
+
+/**
+ * Writes a string with quotes, escaping characters JSON doesn't allow as-is,
+ * such as the backslashes in Windows paths.
+ */
+void cnJSON_WriteString(FILE* file, const char* str)
+{
+	CN_ASSERT_PTR(file);
+	CN_ASSERT_PTR(str);
+
+	fputc('"', file);
+	for (const char* c = str; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', file);
+			fputc(*c, file);
+		}
+		else if ((unsigned char)*c < 0x20) {
+			fprintf(file, "\\u%04x", (unsigned int)(unsigned char)*c);
+		}
+		else {
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
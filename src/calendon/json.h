@@ -0,0 +1,24 @@
+#ifndef CN_JSON_H
+#define CN_JSON_H
+
+/**
+ * @file json.h
+ *
+ * Helpers for writing JSON files, such as traces and benchmark results.
+ */
+
+#include <calendon/cn.h>
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CN_TEST_API void cnJSON_WriteString(FILE* file, const char* str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_JSON_H */
@@ -11,6 +11,18 @@ int32_t cnMain_OptionPrintWorkingDirectory(const CnCommandLineParse* parse, void
 int32_t cnMain_OptionPayload(const CnCommandLineParse* parse, void* c);
 int32_t cnMain_OptionTickLimit(const CnCommandLineParse* parse, void* config);
 int32_t cnMain_OptionHeadless(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionRedrawOnDemand(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionResolution(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionDynamicResolution(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionGLValidation(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionVSync(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionFrameRateCap(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionMaxFramesInFlight(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionFixedStep(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionMaxCatchUpSteps(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionSimulatedDt(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionHotReload(const CnCommandLineParse* parse, void* config);
+int32_t cnMain_OptionBench(const CnCommandLineParse* parse, void* config);
 
 static CnMainConfig s_config;
 static CnCommandLineOption s_options[] = {
@@ -41,6 +53,105 @@ static CnCommandLineOption s_options[] = {
 		NULL,
 		"--headless",
 		cnMain_OptionHeadless
+	},
+	{
+		"\t--redraw-on-demand\n"
+		"\t\tOnly draw when the game requests a redraw, such as for tools.\n",
+		NULL,
+		"--redraw-on-demand",
+		cnMain_OptionRedrawOnDemand
+	},
+	{
+		"\t--resolution WIDTHxHEIGHT\n"
+		"\t\tThe size of the window, such as 1280x720.\n",
+		NULL,
+		"--resolution",
+		cnMain_OptionResolution
+	},
+	{
+		"\t--dynamic-resolution TARGET_MS\n"
+		"\t\tLower the resolution drawn at when frames take longer than\n"
+		"\t\tTARGET_MS milliseconds, and upscale to fill the window.  Frames\n"
+		"\t\tare timed by the CPU and GPU work done to draw them, without\n"
+		"\t\twaiting for VSync or frame pacing, so any target can be used.\n",
+		NULL,
+		"--dynamic-resolution",
+		cnMain_OptionDynamicResolution
+	},
+	{
+		"\t--gl-validation off|frame|callback|paranoid\n"
+		"\t\tHow much OpenGL usage is checked: not at all, for errors once per\n"
+		"\t\tframe, with driver debug messages, or after every call.  Defaults\n"
+		"\t\tto frame in debug builds and off otherwise.\n",
+		NULL,
+		"--gl-validation",
+		cnMain_OptionGLValidation
+	},
+	{
+		"\t--vsync on|off|adaptive\n"
+		"\t\tWhether presenting waits for the display to refresh.  Adaptive\n"
+		"\t\tonly waits for frames which are on time.  Defaults to on.\n",
+		NULL,
+		"--vsync",
+		cnMain_OptionVSync
+	},
+	{
+		"\t--fps-cap FRAMES_PER_SECOND\n"
+		"\t\tLimit how many frames are drawn per second.\n",
+		NULL,
+		"--fps-cap",
+		cnMain_OptionFrameRateCap
+	},
+	{
+		"\t--max-frames-in-flight NUM_FRAMES\n"
+		"\t\tLimit how far drawing can get ahead of the GPU, from 1 to 4, or 0\n"
+		"\t\tfor no limit.  Lower values reduce input latency.  Defaults to 2.\n",
+		NULL,
+		"--max-frames-in-flight",
+		cnMain_OptionMaxFramesInFlight
+	},
+	{
+		"\t--fixed-step TICKS_PER_SECOND\n"
+		"\t\tSimulate in ticks of a fixed size, TICKS_PER_SECOND times per\n"
+		"\t\tsecond, and interpolate between them when drawing.\n",
+		NULL,
+		"--fixed-step",
+		cnMain_OptionFixedStep
+	},
+	{
+		"\t--max-catch-up-steps NUM_TICKS\n"
+		"\t\tMost fixed steps to run in one frame after falling behind, after\n"
+		"\t\twhich the simulation slows down instead.  Defaults to 5.\n",
+		NULL,
+		"--max-catch-up-steps",
+		cnMain_OptionMaxCatchUpSteps
+	},
+	{
+		"\t--sim-dt DT_MS\n"
+		"\t\tFast-forward by running ticks of DT_MS milliseconds back to back\n"
+		"\t\tas fast as possible, without drawing.  Usually combined with\n"
+		"\t\t--headless and --tick-limit.\n",
+		NULL,
+		"--sim-dt",
+		cnMain_OptionSimulatedDt
+	},
+	{
+		"\t--hot-reload\n"
+		"\t\tReload the game library when it is rebuilt, without restarting.\n"
+		"\t\tThe game is shut down and initialized again, and can keep its\n"
+		"\t\tstate by providing Demo_PreReload and Demo_PostReload.\n",
+		NULL,
+		"--hot-reload",
+		cnMain_OptionHotReload
+	},
+	{
+		"\t--bench OUT_JSON\n"
+		"\t\tWrite frame times, system times, render stats, memory use and\n"
+		"\t\tstartup time to OUT_JSON when the run ends.  Requires\n"
+		"\t\t--tick-limit, so runs are the same length.\n",
+		NULL,
+		"--bench",
+		cnMain_OptionBench
 	}
 };
 
@@ -48,7 +159,7 @@ CnCommandLineOptionList cnMain_CommandLineOptionList(void)
 {
 	return (CnCommandLineOptionList) {
 		.options = s_options,
-		.numOptions = 4
+		.numOptions = 16
 	};
 }
 
@@ -62,7 +173,19 @@ void cnMain_SetDefaultConfig(void* config)
 	CnMainConfig* c = (CnMainConfig*)config;
 	memset(c, 0, sizeof(CnMainConfig));
 	c->headless = false;
+	c->redrawOnDemand = false;
+	c->resolution = (CnDimension2u32) { .width = 1024, .height = 768 };
+	c->dynamicResolutionTargetMs = 0;
+	c->renderValidation = CN_RENDER_VALIDATION_DEFAULT;
+	c->vsync = CnVSyncOn;
+	c->frameRateCap = 0;
+	c->maxFramesInFlight = 2;
+	c->fixedStepHz = 0;
+	c->maxCatchUpSteps = 5;
+	c->simulatedDtMs = 0;
+	c->hotReload = false;
 	cnPathBuffer_Clear(&c->gameLibPath);
+	cnPathBuffer_Clear(&c->benchPath);
 }
 
 int32_t cnMain_OptionPrintWorkingDirectory(const CnCommandLineParse* parse, void* config)
@@ -153,3 +276,319 @@ int32_t cnMain_OptionHeadless(const CnCommandLineParse* parse, void* config)
 
 	return 1;
 }
+
+int32_t cnMain_OptionRedrawOnDemand(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+	mainConfig->redrawOnDemand = true;
+	return 1;
+}
+
+int32_t cnMain_OptionResolution(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a resolution, such as 1280x720.\n");
+		return CnOptionParseError;
+	}
+
+	const char* resolutionString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const long long width = strtoll(resolutionString, &readCursor, 10);
+	if (*readCursor != 'x' || errno == ERANGE) {
+		cnPrint("Unable to parse resolution: %s\n", resolutionString);
+		return CnOptionParseError;
+	}
+
+	const long long height = strtoll(readCursor + 1, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse resolution: %s\n", resolutionString);
+		return CnOptionParseError;
+	}
+
+	const long long maxDimension = 16384;
+	if (width <= 0 || height <= 0 || width > maxDimension || height > maxDimension) {
+		cnPrint("Resolution is out of range: %s\n", resolutionString);
+		return CnOptionParseError;
+	}
+
+	mainConfig->resolution = (CnDimension2u32) {
+		.width = (uint32_t)width,
+		.height = (uint32_t)height
+	};
+	return 2;
+}
+
+int32_t cnMain_OptionDynamicResolution(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a frame time target in milliseconds.\n");
+		return CnOptionParseError;
+	}
+
+	const char* targetString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(targetString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse frame time target: %s\n", targetString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue <= 0) {
+		cnPrint("Frame time target must be positive: %s\n", targetString);
+		return CnOptionParseError;
+	}
+	mainConfig->dynamicResolutionTargetMs = (uint64_t)parsedValue;
+	return 2;
+}
+
+int32_t cnMain_OptionGLValidation(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a validation level: off, frame, callback or paranoid.\n");
+		return CnOptionParseError;
+	}
+
+	const char* levelString = cnCommandLineParse_LookAhead(parse, 2);
+	if (strcmp(levelString, "off") == 0) {
+		mainConfig->renderValidation = CnRenderValidationOff;
+	}
+	else if (strcmp(levelString, "frame") == 0) {
+		mainConfig->renderValidation = CnRenderValidationFrame;
+	}
+	else if (strcmp(levelString, "callback") == 0) {
+		mainConfig->renderValidation = CnRenderValidationCallback;
+	}
+	else if (strcmp(levelString, "paranoid") == 0) {
+		mainConfig->renderValidation = CnRenderValidationParanoid;
+	}
+	else {
+		cnPrint("Unknown validation level: %s\n", levelString);
+		return CnOptionParseError;
+	}
+	return 2;
+}
+
+int32_t cnMain_OptionVSync(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a VSync mode: on, off or adaptive.\n");
+		return CnOptionParseError;
+	}
+
+	const char* modeString = cnCommandLineParse_LookAhead(parse, 2);
+	if (strcmp(modeString, "on") == 0) {
+		mainConfig->vsync = CnVSyncOn;
+	}
+	else if (strcmp(modeString, "off") == 0) {
+		mainConfig->vsync = CnVSyncOff;
+	}
+	else if (strcmp(modeString, "adaptive") == 0) {
+		mainConfig->vsync = CnVSyncAdaptive;
+	}
+	else {
+		cnPrint("Unknown VSync mode: %s\n", modeString);
+		return CnOptionParseError;
+	}
+	return 2;
+}
+
+int32_t cnMain_OptionFrameRateCap(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a maximum number of frames per second.\n");
+		return CnOptionParseError;
+	}
+
+	const char* capString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(capString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse frame rate cap: %s\n", capString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue <= 0 || parsedValue > 1000) {
+		cnPrint("Frame rate cap must be between 1 and 1000: %s\n", capString);
+		return CnOptionParseError;
+	}
+	mainConfig->frameRateCap = (uint32_t)parsedValue;
+	return 2;
+}
+
+int32_t cnMain_OptionMaxFramesInFlight(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide the maximum number of frames in flight.\n");
+		return CnOptionParseError;
+	}
+
+	const char* framesString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(framesString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse frames in flight: %s\n", framesString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue < 0 || parsedValue > 4) {
+		cnPrint("Frames in flight must be between 0 and 4: %s\n", framesString);
+		return CnOptionParseError;
+	}
+	mainConfig->maxFramesInFlight = (uint32_t)parsedValue;
+	return 2;
+}
+
+int32_t cnMain_OptionFixedStep(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a number of fixed steps per second.\n");
+		return CnOptionParseError;
+	}
+
+	const char* rateString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(rateString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse fixed step rate: %s\n", rateString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue <= 0 || parsedValue > 1000) {
+		cnPrint("Fixed step rate must be between 1 and 1000: %s\n", rateString);
+		return CnOptionParseError;
+	}
+	mainConfig->fixedStepHz = (uint32_t)parsedValue;
+	return 2;
+}
+
+int32_t cnMain_OptionMaxCatchUpSteps(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide the maximum number of steps to catch up.\n");
+		return CnOptionParseError;
+	}
+
+	const char* stepsString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(stepsString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse maximum catch up steps: %s\n", stepsString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue <= 0 || parsedValue > 100) {
+		cnPrint("Maximum catch up steps must be between 1 and 100: %s\n", stepsString);
+		return CnOptionParseError;
+	}
+	mainConfig->maxCatchUpSteps = (uint32_t)parsedValue;
+	return 2;
+}
+
+int32_t cnMain_OptionSimulatedDt(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide the time of each simulated tick in milliseconds.\n");
+		return CnOptionParseError;
+	}
+
+	const char* dtString = cnCommandLineParse_LookAhead(parse, 2);
+	char* readCursor;
+	errno = 0;
+	const int64_t parsedValue = strtoll(dtString, &readCursor, 10);
+	if (*readCursor != '\0' || errno == ERANGE) {
+		cnPrint("Unable to parse simulated tick time: %s\n", dtString);
+		return CnOptionParseError;
+	}
+
+	if (parsedValue <= 0 || parsedValue > 5000) {
+		cnPrint("Simulated tick time must be between 1 and 5000 ms: %s\n", dtString);
+		return CnOptionParseError;
+	}
+	mainConfig->simulatedDtMs = (uint64_t)parsedValue;
+	return 2;
+}
+
+int32_t cnMain_OptionHotReload(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+	mainConfig->hotReload = true;
+	return 1;
+}
+
+int32_t cnMain_OptionBench(const CnCommandLineParse* parse, void* config)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(config);
+
+	CnMainConfig* mainConfig = (CnMainConfig*)config;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a file to write benchmark results to.\n");
+		return CnOptionParseError;
+	}
+
+	const char* benchPath = cnCommandLineParse_LookAhead(parse, 2);
+	if (!cnString_FitsWithNull(benchPath, CN_MAX_TERMINATED_PATH)) {
+		cnPrint("Benchmark output path is too long.\n");
+		return CnOptionParseError;
+	}
+	cnPathBuffer_Set(&mainConfig->benchPath, benchPath);
+	return 2;
+}
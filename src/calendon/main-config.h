@@ -4,6 +4,8 @@
 #include <calendon/command-line-option.h>
 #include <calendon/path.h>
 #include <calendon/behavior.h>
+#include <calendon/dimension.h>
+#include <calendon/render-resources.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +16,56 @@ typedef struct {
 	CnPathBuffer gameLibPath;
 	int64_t tickLimit;
 	bool headless;
+	bool redrawOnDemand;
+	CnDimension2u32 resolution;
+
+	/**
+	 * Frame time to aim for by scaling the drawn resolution, or zero to always
+	 * draw at full resolution.
+	 */
+	uint64_t dynamicResolutionTargetMs;
+
+	CnRenderValidation renderValidation;
+	CnVSync vsync;
+
+	/**
+	 * Maximum frames started per second, or zero for no limit.
+	 */
+	uint32_t frameRateCap;
+
+	/**
+	 * Frames which can be submitted before the GPU finishes drawing them, or
+	 * zero to leave it up to the driver.
+	 */
+	uint32_t maxFramesInFlight;
+
+	/**
+	 * Simulation ticks per second when ticking at a fixed rate, or zero to
+	 * tick once per frame with the time elapsed since the last one.
+	 */
+	uint32_t fixedStepHz;
+
+	/**
+	 * Most fixed ticks run in a single frame to catch up after a slow frame.
+	 */
+	uint32_t maxCatchUpSteps;
+
+	/**
+	 * Time covered by each tick when fast-forwarding, or zero to tick in real
+	 * time.  Fast-forwarding runs ticks back to back without drawing.
+	 */
+	uint64_t simulatedDtMs;
+
+	/**
+	 * Reload the game library whenever it changes on disk.
+	 */
+	bool hotReload;
+
+	/**
+	 * Where to write measurements of the run as JSON when it ends, or empty
+	 * to not write them.
+	 */
+	CnPathBuffer benchPath;
 } CnMainConfig;
 
 void* cnMain_Config(void);
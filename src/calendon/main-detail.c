@@ -2,10 +2,15 @@
 
 #include <calendon/assets.h>
 #include <calendon/assets-fileio.h>
+#include <calendon/control.h>
 #include <calendon/crash.h>
+#include <calendon/fixed-step.h>
+#include <calendon/frame-stats.h>
+#include <calendon/job.h>
 #include <calendon/log.h>
 #include <calendon/main-config.h>
 #include <calendon/memory.h>
+#include <calendon/profile.h>
 #include <calendon/behavior.h>
 #ifdef _WIN32
 #include <calendon/process.h>
@@ -14,19 +19,55 @@
 #include <calendon/tick-limits.h>
 #include <calendon/time.h>
 #include <calendon/render.h>
+#include <calendon/replay.h>
 #include <calendon/ui.h>
 
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 CnTime s_lastTick;
+
+/**
+ * Prevent updating too rapidly.  Maintaining a relatively consistent timestep
+ * limits stored state and prevents precision errors due to extremely small dt.
+ */
+#define CN_MIN_TICK_SIZE_MS 8
 CnSystem s_coreSystems[CnMaxNumCoreSystems];
 uint32_t s_numCoreSystems = 0;
+CN_STATIC_ASSERT(CnMaxNumCoreSystems <= CN_FRAME_STATS_MAX_SYSTEMS,
+	"Every core system must be able to have its frame times recorded.");
+
+/**
+ * Divides frame time into ticks when ticking at a fixed rate.
+ */
+static CnFixedStep s_fixedStep;
+static bool s_fixedStepEnabled = false;
+
+/**
+ * Time given to every tick when fast-forwarding instead of using the clock.
+ */
+static CnTime s_simulatedDt;
+static bool s_simulating = false;
 
 static bool cnMain_Init(void) {
 	CnMainConfig* config = (CnMainConfig*)cnMain_Config();
 	if (config->tickLimit != 0) {
 		cnMain_SetTickLimit(config->tickLimit);
 	}
+	else if (config->benchPath.str[0] != '\0') {
+		CN_ERROR(LogSysMain, "--bench requires --tick-limit.");
+		return false;
+	}
+
+	s_fixedStepEnabled = config->fixedStepHz != 0;
+	if (s_fixedStepEnabled) {
+		const CnTime step = { .native = 1000000000ULL / config->fixedStepHz };
+		cnFixedStep_Init(&s_fixedStep, step, config->maxCatchUpSteps);
+	}
+
+	s_simulating = config->simulatedDtMs != 0;
+	s_simulatedDt = cnTime_MakeMilli(config->simulatedDtMs);
 	return true;
 }
 
@@ -58,6 +99,7 @@ CnSystem* cnMain_AddCoreSystem(CnSystem system)
 	}
 	CnSystem* assigned = &s_coreSystems[s_numCoreSystems];
 	*assigned = system;
+	cnFrameStats_SetSystemName(s_numCoreSystems, system.name ? system.name() : "(unnamed)");
 	++s_numCoreSystems;
 	return assigned;
 }
@@ -70,6 +112,9 @@ void cnMain_BuildCoreSystemList(void)
 		cnCrash_System,
 		cnMemory_System,
 		cnTime_System,
+		cnProfile_System,
+		cnJob_System,
+		cnReplay_System,
 		cnAssets_System
 	};
 
@@ -87,6 +132,116 @@ void cnMain_InitCoreSystems(void)
 	}
 }
 
+/**
+ * Name for demos which don't provide their own.
+ */
+static const char* cnMain_PayloadName(void)
+{
+	return "Demo";
+}
+
+/**
+ * How often the game library is checked for changes when hot reloading.  A
+ * change is only reloaded once the library stops changing between checks, so
+ * a library which is still being written isn't loaded.
+ */
+#define CN_HOT_RELOAD_CHECK_MS 500
+
+/**
+ * Called on the old library before a reload, returning state to give to the
+ * new library.  The state must outlive the old library's shutdown and unload,
+ * so it should be heap allocated rather than point into the library.
+ */
+typedef void* (*CnMain_PreReloadFn)(void);
+
+/**
+ * Called on the new library after it initializes, with the state from the old
+ * library, which it takes ownership of.
+ */
+typedef void (*CnMain_PostReloadFn)(void* state);
+
+static bool s_hotReload = false;
+static uint32_t s_payloadIndex;
+static CnSharedLibrary s_payloadLibrary;
+static CnPathBuffer s_payloadPath;
+
+/**
+ * The copy of the game library actually loaded when hot reloading, so the
+ * original can be overwritten by the build.
+ */
+static CnPathBuffer s_payloadCopyPath;
+static uint32_t s_numPayloadCopies = 0;
+
+static uint64_t s_payloadModified;
+static uint64_t s_pendingModified;
+static bool s_reloadPending = false;
+static CnTime s_nextReloadCheck;
+
+static bool cnMain_CopyFile(const char* from, const char* to)
+{
+	FILE* source = fopen(from, "rb");
+	if (!source) {
+		return false;
+	}
+	FILE* dest = fopen(to, "wb");
+	if (!dest) {
+		fclose(source);
+		return false;
+	}
+
+	char buffer[64 * 1024];
+	size_t numRead;
+	bool copied = true;
+	while ((numRead = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+		if (fwrite(buffer, 1, numRead, dest) != numRead) {
+			copied = false;
+			break;
+		}
+	}
+	copied = copied && !ferror(source);
+
+	fclose(source);
+	copied = fclose(dest) == 0 && copied;
+	return copied;
+}
+
+/**
+ * Loads the game library, or a fresh copy of it when hot reloading.  Loading
+ * the same path twice would only return the library already loaded.
+ */
+static CnSharedLibrary cnMain_OpenPayloadLibrary(CnPathBuffer* loadedPath)
+{
+	if (!s_hotReload) {
+		*loadedPath = s_payloadPath;
+		return cnSharedLibrary_Load(s_payloadPath.str);
+	}
+
+	cnString_Format(loadedPath->str, CN_MAX_TERMINATED_PATH, "%s.reload-%" PRIu32,
+		s_payloadPath.str, s_numPayloadCopies++);
+	if (!cnMain_CopyFile(s_payloadPath.str, loadedPath->str)) {
+		CN_WARN(LogSysMain, "Unable to copy game library to: %s", loadedPath->str);
+		return NULL;
+	}
+
+	const CnSharedLibrary library = cnSharedLibrary_Load(loadedPath->str);
+	if (!library) {
+		remove(loadedPath->str);
+	}
+	return library;
+}
+
+static bool cnMain_ResolvePayload(CnSystem* payload, CnSharedLibrary library)
+{
+	memset(payload, 0, sizeof(CnSystem));
+	if (!cnSystem_LoadFromSharedLibrary(payload, "Demo", library)) {
+		return false;
+	}
+	if (!payload->name) {
+		payload->name = cnMain_PayloadName;
+	}
+	return true;
+}
+
 void cnMain_LoadPayload(CnMainConfig* config)
 {
 	CN_ASSERT_PTR(config);
@@ -106,23 +261,175 @@ void cnMain_LoadPayload(CnMainConfig* config)
 	strftime(timeBuffer, sizeof(timeBuffer), "%c", lt);
 	CN_TRACE(LogSysMain, "Last modified time: %s", timeBuffer);
 
-	const CnSharedLibrary sharedLib = cnSharedLibrary_Load(sharedLibraryName);
+	s_hotReload = config->hotReload;
+	s_payloadPath = config->gameLibPath;
+	s_payloadModified = gameLibModified;
+	s_nextReloadCheck = cnTime_Add(cnTime_MakeNow(), cnTime_MakeMilli(CN_HOT_RELOAD_CHECK_MS));
+
+	const CnSharedLibrary sharedLib = cnMain_OpenPayloadLibrary(&s_payloadCopyPath);
 	if (!sharedLib) {
 		CN_FATAL_ERROR("Unable to load game module: %s", sharedLibraryName);
 	}
+	s_payloadLibrary = sharedLib;
 
 	if (s_numCoreSystems >= CnMaxNumCoreSystems) {
 		CN_FATAL_ERROR("Too many core systems, cannot load demo.");
 	}
 	CnSystem loaded;
-	if (!cnSystem_LoadFromSharedLibrary(&loaded, "Demo", sharedLib)) {
+	if (!cnMain_ResolvePayload(&loaded, sharedLib)) {
 		CN_FATAL_ERROR("Unable to load demo.");
 	}
 
+	s_payloadIndex = s_numCoreSystems;
 	CnSystem* demo = cnMain_AddCoreSystem(loaded);
 	demo->init();
 }
 
+/**
+ * Makes a loaded library the game library and initializes it.
+ */
+static bool cnMain_StartPayload(CnSharedLibrary library, const CnPathBuffer* path, const CnSystem* resolved)
+{
+	CnSystem* payload = &s_coreSystems[s_payloadIndex];
+	*payload = *resolved;
+	s_payloadLibrary = library;
+	s_payloadCopyPath = *path;
+
+	// The old name belonged to the old library.
+	cnFrameStats_SetSystemName(s_payloadIndex, payload->name());
+
+	return !payload->init || payload->init();
+}
+
+/**
+ * Loads the copy of the game library which was running before a failed
+ * reload, so the game keeps running while the build is fixed.
+ */
+static void cnMain_RestorePayload(const CnPathBuffer* path)
+{
+	const CnSharedLibrary library = cnSharedLibrary_Load(path->str);
+	CnSystem resolved;
+	if (!library || !cnMain_ResolvePayload(&resolved, library)) {
+		CN_FATAL_ERROR("Unable to restore previous game library: %s", path->str);
+	}
+	if (!cnMain_StartPayload(library, path, &resolved)) {
+		CN_FATAL_ERROR("Unable to initialize previous game library: %s", path->str);
+	}
+}
+
+/**
+ * Swaps in a new build of the game library.  The new library is loaded and
+ * checked before the old one is shut down, so a library which fails to load
+ * leaves the old one running.  If the new library fails to initialize, the
+ * copy of the old library is loaded again and given back its state.
+ */
+static bool cnMain_ReloadPayload(void)
+{
+	CnPathBuffer newPath;
+	const CnSharedLibrary newLibrary = cnMain_OpenPayloadLibrary(&newPath);
+	if (!newLibrary) {
+		CN_WARN(LogSysMain, "Unable to reload game library, keeping the old one: %s", s_payloadPath.str);
+		return false;
+	}
+
+	CnSystem resolved;
+	if (!cnMain_ResolvePayload(&resolved, newLibrary)) {
+		CN_WARN(LogSysMain, "Reloaded game library is missing functions, keeping the old one: %s",
+			s_payloadPath.str);
+		cnSharedLibrary_Release(newLibrary);
+		remove(newPath.str);
+		return false;
+	}
+
+	const CnMain_PreReloadFn preReload = (CnMain_PreReloadFn)
+		cnSharedLibrary_LookupFn(s_payloadLibrary, "Demo_PreReload");
+	void* state = preReload ? preReload() : NULL;
+
+	CnSystem* payload = &s_coreSystems[s_payloadIndex];
+	if (payload->shutdown) {
+		payload->shutdown();
+	}
+
+	// Keep the old copy on disk until the new library starts, in case it has
+	// to be loaded again.
+	const CnPathBuffer oldPath = s_payloadCopyPath;
+	cnSharedLibrary_Release(s_payloadLibrary);
+
+	const bool started = cnMain_StartPayload(newLibrary, &newPath, &resolved);
+	if (started) {
+		remove(oldPath.str);
+	}
+	else {
+		CN_WARN(LogSysMain, "Unable to initialize reloaded game library, restoring the old one: %s",
+			s_payloadPath.str);
+		cnSharedLibrary_Release(newLibrary);
+		remove(newPath.str);
+		cnMain_RestorePayload(&oldPath);
+	}
+
+	const CnMain_PostReloadFn postReload = (CnMain_PostReloadFn)
+		cnSharedLibrary_LookupFn(s_payloadLibrary, "Demo_PostReload");
+	if (postReload) {
+		postReload(state);
+	}
+	else if (state) {
+		CN_WARN(LogSysMain, "Reloaded game library has no Demo_PostReload, state was lost.");
+	}
+
+	if (started) {
+		CN_TRACE(LogSysMain, "Reloaded game library: %s", s_payloadPath.str);
+	}
+	return started;
+}
+
+/**
+ * Reloads the game library if hot reloading and it has changed since it was
+ * loaded.  Returns true if a new library was swapped in.
+ */
+bool cnMain_ReloadPayloadIfChanged(void)
+{
+	if (!s_hotReload) {
+		return false;
+	}
+
+	const CnTime now = cnTime_MakeNow();
+	if (cnTime_LessThan(now, s_nextReloadCheck)) {
+		return false;
+	}
+	s_nextReloadCheck = cnTime_Add(now, cnTime_MakeMilli(CN_HOT_RELOAD_CHECK_MS));
+
+	uint64_t modified;
+	if (!cnAssets_LastModifiedTime(s_payloadPath.str, &modified) || modified == s_payloadModified) {
+		// Libraries are sometimes briefly missing while being relinked.
+		s_reloadPending = false;
+		return false;
+	}
+
+	// Wait for the build to finish writing.
+	if (!s_reloadPending || modified != s_pendingModified) {
+		s_reloadPending = true;
+		s_pendingModified = modified;
+		return false;
+	}
+
+	s_reloadPending = false;
+	s_payloadModified = modified;
+	return cnMain_ReloadPayload();
+}
+
+/**
+ * Unloads the game library if it was a copy made for hot reloading, so the
+ * copy can be removed.
+ */
+void cnMain_UnloadPayload(void)
+{
+	if (s_hotReload && s_payloadLibrary) {
+		cnSharedLibrary_Release(s_payloadLibrary);
+		remove(s_payloadCopyPath.str);
+		s_payloadLibrary = NULL;
+	}
+}
+
 void cnMain_PrintUsage(int argc, char** argv)
 {
 	// Print core systems.
@@ -213,20 +520,25 @@ bool cnMain_ParseCommandLine(int argc, char** argv)
  * Small ticks do needless work, and large ticks might be due to resuming from
  * the debugger.
  *
+ * When fast-forwarding, every call generates a tick of the simulated size
+ * without looking at the clock.
+ *
  * @param[out] outDt delta time if a tick is generated (returns true), not set otherwise
  * @return true if a tick should occur
  */
 bool cnMain_GenerateTick(CnTime* outDt)
 {
+	// Recordings provide the time covered by each tick.
+	if (s_simulating || cnReplay_IsReplaying()) {
+		*outDt = s_simulatedDt;
+		return true;
+	}
+
 	const CnTime current = cnTime_Max(s_lastTick, cnTime_MakeNow());
 
-	// Prevent updating too rapidly.  Maintaining a relatively consistent
-	// timestep limits stored state and prevents precision errors due to
-	// extremely small dt.
-	//
 	// Since Calendon is single-threaded, VSync will probably ensure that the
 	// minimum tick size is never missed.
-	const CnTime minTickSize = cnTime_MakeMilli(8);
+	const CnTime minTickSize = cnTime_MakeMilli(CN_MIN_TICK_SIZE_MS);
 	const CnTime dt = cnTime_SubtractMonotonic(current, s_lastTick);
 	if (cnTime_LessThan(dt, minTickSize)) {
 		return false;
@@ -245,15 +557,61 @@ bool cnMain_GenerateTick(CnTime* outDt)
 	return true;
 }
 
+/**
+ * Determines how many ticks to run for a frame of length `frameDt`, and fills
+ * in the time each tick covers and the interpolation for drawing afterwards.
+ *
+ * Without a fixed step, this is always a single tick covering the whole frame.
+ * When playing back a recording, each frame is the next recorded tick, and the
+ * game shuts down when the recording ends.
+ */
+uint32_t cnMain_TicksForFrame(CnTime frameDt, CnFrameEvent* event)
+{
+	CN_ASSERT_PTR(event);
+
+	if (cnReplay_IsReplaying()) {
+		if (cnReplay_NextTick(event)) {
+			return 1;
+		}
+		cnMain_QueueGracefulShutdown();
+		return 0;
+	}
+
+	if (!s_fixedStepEnabled) {
+		event->dt = frameDt;
+		event->alpha = 1.0f;
+		return 1;
+	}
+
+	const uint32_t numTicks = cnFixedStep_Advance(&s_fixedStep, frameDt);
+	event->dt = s_fixedStep.step;
+	event->alpha = cnFixedStep_Alpha(&s_fixedStep);
+	return numTicks;
+}
+
+/**
+ * The earliest time at which `cnMain_GenerateTick` will generate another tick.
+ */
+CnTime cnMain_NextTickTime(void)
+{
+	return cnTime_Add(s_lastTick, cnTime_MakeMilli(CN_MIN_TICK_SIZE_MS));
+}
+
 void cnMain_StartUpUI(void)
 {
-	// TODO: Resolution should be read from config or as a a configuration option.
-	const uint32_t width = 1024;
-	const uint32_t height = 768;
+	CnMainConfig* config = (CnMainConfig*) cnMain_Config();
 
 	CnUIInitParams uiInitParams;
-	uiInitParams.resolution = (CnDimension2u32) { .width = width, .height = height };
+	uiInitParams.resolution = config->resolution;
 
 	cnUI_Init(&uiInitParams);
+	cnR_SetValidation(config->renderValidation);
+	cnR_SetVSync(config->vsync);
 	cnR_Init(uiInitParams.resolution);
+	cnR_SetFrameRateCap(config->frameRateCap);
+	cnR_SetMaxFramesInFlight(config->maxFramesInFlight);
+
+	if (config->dynamicResolutionTargetMs != 0) {
+		cnR_SetDynamicResolution(true, cnTime_MakeMilli(config->dynamicResolutionTargetMs));
+	}
 }
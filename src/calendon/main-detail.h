@@ -26,8 +26,12 @@ bool cnMain_ParseCommandLine(int argc, char** argv);
 
 void cnMain_StartUpUI(void);
 void cnMain_LoadPayload(CnMainConfig* config);
+bool cnMain_ReloadPayloadIfChanged(void);
+void cnMain_UnloadPayload(void);
 void cnMain_ValidatePayload(CnBehavior* payload);
 bool cnMain_GenerateTick(CnTime* outDt);
+uint32_t cnMain_TicksForFrame(CnTime frameDt, CnFrameEvent* event);
+CnTime cnMain_NextTickTime(void);
 
 #ifdef __cplusplus
 }
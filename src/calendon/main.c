@@ -1,18 +1,39 @@
 #include "main.h"
 
+#include <calendon/bench.h>
 #include <calendon/control.h>
+#include <calendon/frame-stats.h>
 #include <calendon/log.h>
 #include <calendon/main-config.h>
 #include <calendon/main-detail.h>
+#include <calendon/memory.h>
+#include <calendon/profile.h>
+#include <calendon/replay.h>
+#include <calendon/schedule.h>
 #include <calendon/tick-limits.h>
+#include <calendon/time.h>
 #include <calendon/render.h>
 #include <calendon/ui.h>
 
+/**
+ * Order in which systems tick, which lets systems declaring the resources they
+ * use tick in parallel.
+ */
+static CnSchedule s_tickSchedule;
+
+/**
+ * How long startup and the main loop took, for benchmark results.
+ */
+static CnTime s_startupTime;
+static CnTime s_runTime;
+
 /**
  * The initial startup point for Calendon.
  */
 void cnMain_StartUp(int argc, char** argv)
 {
+	const CnTime startUpBegin = cnTime_MakeNow();
+
 	// Builds the list of the systems known from program initialization to load
 	// and use.
 	cnMain_BuildCoreSystemList();
@@ -39,6 +60,7 @@ void cnMain_StartUp(int argc, char** argv)
 	CnMainConfig* config = (CnMainConfig*) cnMain_Config();
 	if (!config->headless) {
 		cnMain_StartUpUI();
+		cnR_SetRedrawOnDemand(config->redrawOnDemand);
 	}
 
 	// If there is a demo to load from file, then use that.
@@ -52,40 +74,95 @@ void cnMain_StartUp(int argc, char** argv)
 	// Initialize the time of the first program tick, so tick deltas are
 	// relevant after this point.
 	s_lastTick = cnTime_MakeNow();
+	cnFrameStats_Clear();
 
+	// Every system which ticks has been added, including the demo.
+	cnSchedule_Build(&s_tickSchedule, s_coreSystems, s_numCoreSystems);
+	if (!cnSchedule_IsSerial(&s_tickSchedule)) {
+		CN_TRACE(LogSysMain, "Systems tick in parallel.");
+	}
+
+	s_startupTime = cnTime_SubtractMonotonic(cnTime_MakeNow(), startUpBegin);
 	CN_TRACE(LogSysMain, "Systems initialized.");
 }
 
-void cnMain_AllBeginFrame(CnFrameEvent* event)
+/**
+ * The function a behavior runs during a phase, which may be NULL.
+ */
+static CnBehavior_FrameFn cnMain_PhaseFn(const CnBehavior* behavior, CnFramePhase phase)
 {
-	CN_ASSERT_PTR(event);
-	for (uint32_t i = 0; i < s_numCoreSystems; ++i) {
-		cnBehavior_BeginFrame(&s_coreSystems[i].behavior, event);
+	switch (phase) {
+		case CnFramePhaseBegin: return behavior->beginFrame;
+		case CnFramePhaseTick:  return behavior->tick;
+		case CnFramePhaseDraw:  return behavior->draw;
+		case CnFramePhaseEnd:   return behavior->endFrame;
+		default:
+			CN_FATAL_ERROR("Not a phase systems run: %d", (int)phase);
+			return NULL;
 	}
 }
 
-void cnMain_AllTick(CnFrameEvent* event)
+/**
+ * Runs a phase for every system in order, timing each system which has
+ * something to do in that phase.
+ */
+static void cnMain_RunPhase(CnFramePhase phase, CnFrameEvent* event)
 {
 	CN_ASSERT_PTR(event);
+
+	// The end of each system's phase is the start of the next, to halve the
+	// number of times the clock is read.
+	CnTime start = cnTime_MakeNow();
 	for (uint32_t i = 0; i < s_numCoreSystems; ++i) {
-		cnBehavior_Tick(&s_coreSystems[i].behavior, event);
+		const CnBehavior_FrameFn fn = cnMain_PhaseFn(&s_coreSystems[i].behavior, phase);
+		if (!fn) {
+			continue;
+		}
+		fn(event);
+
+		const CnTime end = cnTime_MakeNow();
+		cnFrameStats_RecordSystem(i, phase, cnTime_SubtractMonotonic(end, start));
+		start = end;
 	}
 }
 
+/**
+ * Ticks a single system, which might happen on any thread running jobs.
+ */
+static void cnMain_TickSystem(uint32_t systemIndex, CnFrameEvent* event)
+{
+	const CnTime start = cnTime_MakeNow();
+	s_coreSystems[systemIndex].behavior.tick(event);
+	cnFrameStats_RecordSystem(systemIndex, CnFramePhaseTick,
+		cnTime_SubtractMonotonic(cnTime_MakeNow(), start));
+}
+
+void cnMain_AllBeginFrame(CnFrameEvent* event)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnMain_RunPhase(CnFramePhaseBegin, event);
+	CN_PROFILE_END();
+}
+
+void cnMain_AllTick(CnFrameEvent* event)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnSchedule_Run(&s_tickSchedule, cnMain_TickSystem, event);
+	CN_PROFILE_END();
+}
+
 void cnMain_AllDraw(CnFrameEvent* event)
 {
-	CN_ASSERT_PTR(event);
-	for (uint32_t i = 0; i < s_numCoreSystems; ++i) {
-		cnBehavior_Draw(&s_coreSystems[i].behavior, event);
-	}
+	CN_PROFILE_BEGIN(__func__);
+	cnMain_RunPhase(CnFramePhaseDraw, event);
+	CN_PROFILE_END();
 }
 
 void cnMain_AllEndFrame(CnFrameEvent* event)
 {
-	CN_ASSERT_PTR(event);
-	for (uint32_t i = 0; i < s_numCoreSystems; ++i) {
-		cnBehavior_EndFrame(&s_coreSystems[i].behavior, event);
-	}
+	CN_PROFILE_BEGIN(__func__);
+	cnMain_RunPhase(CnFramePhaseEnd, event);
+	CN_PROFILE_END();
 }
 
 /**
@@ -96,33 +173,119 @@ void cnMain_Loop(void)
 {
 	CnFrameEvent event;
 	event.dt = cnTime_MakeZero();
+	event.alpha = 1.0f;
+
+	CnTime lastFrameStart = cnTime_MakeZero();
+
+	const CnMainConfig* config = (CnMainConfig*)cnMain_Config();
+	const bool headless = config->headless;
 
+	// Fast-forwarding runs ticks as quickly as possible, so nothing is drawn
+	// and there's no waiting for the clock.  Recordings also play back as
+	// quickly as possible, but are still drawn.
+	const bool fastForward = config->simulatedDtMs != 0 || cnReplay_IsReplaying();
+	const bool drawing = !headless && config->simulatedDtMs == 0;
+	bool drew = false;
+	const CnTime loopStart = cnTime_MakeNow();
 	while (cnMain_IsRunning() && !cnMain_IsTickLimitReached())
 	{
-		cnMain_AllBeginFrame(&event);
-
-		cnUI_ProcessWindowEvents();
+		// Wait for the next frame before reading input, so the input is as
+		// fresh as possible when it gets drawn.
+		if (drew) {
+			cnR_PaceFrame();
+		}
 
 		// Event checking should be quick.  Always processing events prevents
 		// slowness due to bursts.
 		cnUI_ProcessWindowEvents();
 
-		if (cnMain_GenerateTick(&event.dt)) {
+		// Swap in a rebuilt game between frames, when nothing is using it.
+		if (cnMain_ReloadPayloadIfChanged()) {
+			cnSchedule_Build(&s_tickSchedule, s_coreSystems, s_numCoreSystems);
+			cnR_RequestRedraw();
+		}
+
+		drew = false;
+		CnTime frameDt;
+		if (cnMain_GenerateTick(&frameDt)) {
+			const CnTime frameStart = cnTime_MakeNow();
+			if (!cnTime_IsZero(lastFrameStart)) {
+				cnFrameStats_Record(CnFramePhaseTotal, cnTime_SubtractMonotonic(frameStart, lastFrameStart));
+			}
+			lastFrameStart = frameStart;
+
+			const uint32_t numTicks = cnMain_TicksForFrame(frameDt, &event);
+
 			cnMain_AllBeginFrame(&event);
-			cnMain_AllTick(&event);
+			const CnTime beginEnd = cnTime_MakeNow();
+			cnFrameStats_Record(CnFramePhaseBegin, cnTime_SubtractMonotonic(beginEnd, frameStart));
 
-			cnMain_TickCompleted();
+			for (uint32_t i = 0; i < numTicks && !cnMain_IsTickLimitReached(); ++i) {
+				cnReplay_RecordTick(&event);
+				cnMain_AllTick(&event);
+				cnMain_TickCompleted();
+			}
+			CnTime phaseStart = cnTime_MakeNow();
+			cnFrameStats_Record(CnFramePhaseTick, cnTime_SubtractMonotonic(phaseStart, beginEnd));
 
-			cnMain_AllDraw(&event);
+			// Skip drawing and presenting entirely if nothing visible changed.
+			if (drawing && cnR_IsRedrawRequested()) {
+				cnMain_AllDraw(&event);
+				drew = true;
+
+				const CnTime frameEnd = cnTime_MakeNow();
+				cnFrameStats_Record(CnFramePhaseDraw, cnTime_SubtractMonotonic(frameEnd, phaseStart));
+				cnR_ReportFrameWork(frameStart);
+				cnFrameStats_RecordRender(cnR_Stats());
+				phaseStart = frameEnd;
+			}
 			cnMain_AllEndFrame(&event);
+			cnFrameStats_Record(CnFramePhaseEnd, cnTime_SubtractMonotonic(cnTime_MakeNow(), phaseStart));
+
+			// Everything allocated from the frame arena the frame before this
+			// one is no longer needed.
+			cnFrameArena_EndFrame();
+		}
+
+		// Without a swap to wait on VSync, sleep until another tick is due
+		// rather than polling, which would keep a core busy.  Input wakes the
+		// wait early so it gets processed promptly.
+		if (!drew && !fastForward) {
+			if (headless) {
+				cnTime_SleepUntil(cnMain_NextTickTime());
+			}
+			else {
+				cnUI_WaitForEventsUntil(cnMain_NextTickTime());
+			}
 		}
 
 		// cnUI_EndFrame();
 	}
+	s_runTime = cnTime_SubtractMonotonic(cnTime_MakeNow(), loopStart);
 }
 
 void cnMain_Shutdown(void)
 {
+	cnFrameStats_Print();
+	cnFrameStats_PrintSystems();
+	cnFrameStats_PrintRender();
+
+	const CnMainConfig* config = (CnMainConfig*)cnMain_Config();
+	if (config->benchPath.str[0] != '\0') {
+		const CnBenchRun run = {
+			.game = config->gameLibPath.str,
+			.startup = s_startupTime,
+			.run = s_runTime,
+			.headless = config->headless
+		};
+		if (cnBench_Write(config->benchPath.str, &run)) {
+			cnPrint("Wrote benchmark results to: %s\n", config->benchPath.str);
+		}
+		else {
+			CN_ERROR(LogSysMain, "Unable to write benchmark results to: %s", config->benchPath.str);
+		}
+	}
+
 	cnR_Shutdown();
 	cnUI_Shutdown();
 
@@ -138,4 +301,5 @@ void cnMain_Shutdown(void)
 			system->shutdown();
 		}
 	}
+	cnMain_UnloadPayload();
 }
@@ -2,15 +2,42 @@
 
 #include <calendon/cn.h>
 
+#include <calendon/atomic.h>
 #include <calendon/log.h>
 
+#include <string.h>
+
 static CnLogHandle LogSysMemory;
-static uint32_t s_outstandingDynamicBuffers;
+
+/**
+ * Stats of the frame arena, which is only used from the main thread.
+ */
+static CnMemoryStats s_stats;
+
+/**
+ * Buffers and pools may be used from jobs on several threads at once, so their
+ * counts are kept apart from the other stats and updated atomically.
+ */
+static volatile uint32_t s_outstandingDynamicBuffers;
+static volatile uint32_t s_outstandingPools;
+static volatile uint64_t s_numAllocations;
+static volatile uint64_t s_numFrees;
+static volatile uint64_t s_outstandingBytes;
+static volatile uint64_t s_peakBytes;
+static volatile uint64_t s_outstandingPoolBlocks;
 
 bool cnMemory_Init(void)
 {
 	s_outstandingDynamicBuffers = 0;
+	s_outstandingPools = 0;
+	s_numAllocations = 0;
+	s_numFrees = 0;
+	s_outstandingBytes = 0;
+	s_peakBytes = 0;
+	s_outstandingPoolBlocks = 0;
+	memset(&s_stats, 0, sizeof(s_stats));
 	LogSysMemory = cnLog_RegisterSystem("Memory");
+	cnFrameArena_Init(CN_FRAME_ARENA_SIZE);
 	return true;
 }
 
@@ -28,7 +55,14 @@ void cnDynamicBuffer_Allocate(CnDynamicBuffer* buffer, uint32_t size)
 		CN_ERROR(LogSysMemory, "Unable to allocate %" PRIu32 " bytes for CnDynamicBuffer", size);
 	}
 	buffer->size = size;
-	++s_outstandingDynamicBuffers;
+	cnAtomic_FetchAddU32(&s_outstandingDynamicBuffers, 1);
+
+	cnAtomic_FetchAddU64(&s_numAllocations, 1);
+	const uint64_t outstandingBytes = cnAtomic_FetchAddU64(&s_outstandingBytes, size) + size;
+	uint64_t peakBytes = cnAtomic_LoadU64(&s_peakBytes);
+	while (outstandingBytes > peakBytes && !cnAtomic_CompareExchangeU64(&s_peakBytes, peakBytes, outstandingBytes)) {
+		peakBytes = cnAtomic_LoadU64(&s_peakBytes);
+	}
 }
 
 void cnDynamicBuffer_Free(CnDynamicBuffer* buffer)
@@ -38,19 +72,307 @@ void cnDynamicBuffer_Free(CnDynamicBuffer* buffer)
 	free(buffer->contents);
 	buffer->contents = NULL;
 
-	if (s_outstandingDynamicBuffers == 0) {
+	cnAtomic_FetchAddU64(&s_numFrees, 1);
+	cnAtomic_FetchSubU64(&s_outstandingBytes, buffer->size);
+
+	if (cnAtomic_LoadU32(&s_outstandingDynamicBuffers) == 0) {
 		CN_ERROR(LogSysMemory, "Double free of buffer %p", (void*)buffer);
 	}
 	else {
-		--s_outstandingDynamicBuffers;
+		cnAtomic_FetchSubU32(&s_outstandingDynamicBuffers, 1);
+	}
+}
+
+void cnArena_Allocate(CnArena* arena, uint32_t size)
+{
+	CN_ASSERT_PTR(arena);
+	cnDynamicBuffer_Allocate(&arena->buffer, size);
+	arena->used = 0;
+	arena->peak = 0;
+}
+
+void cnArena_Free(CnArena* arena)
+{
+	CN_ASSERT_PTR(arena);
+	cnDynamicBuffer_Free(&arena->buffer);
+	arena->used = 0;
+}
+
+/**
+ * Returns `size` bytes aligned to `align`, which must be a power of two, or
+ * NULL if the arena doesn't have enough space left.
+ */
+void* cnArena_Alloc(CnArena* arena, uint32_t size, uint32_t align)
+{
+	CN_ASSERT_PTR(arena);
+	CN_ASSERT(align != 0 && (align & (align - 1)) == 0, "Alignment must be a power of two: %" PRIu32, align);
+
+	const uintptr_t base = (uintptr_t)arena->buffer.contents;
+	for (;;) {
+		const uint32_t used = cnAtomic_LoadU32(&arena->used);
+		const uintptr_t start = (base + used + (align - 1)) & ~(uintptr_t)(align - 1);
+		const uint64_t end = (uint64_t)(start - base) + size;
+		if (end > arena->buffer.size) {
+			return NULL;
+		}
+
+		// Another thread might have allocated in the meantime.
+		if (cnAtomic_CompareExchangeU32(&arena->used, used, (uint32_t)end)) {
+			return (void*)start;
+		}
+	}
+}
+
+/**
+ * Releases everything allocated from the arena.
+ */
+void cnArena_Reset(CnArena* arena)
+{
+	CN_ASSERT_PTR(arena);
+	if (arena->used > arena->peak) {
+		arena->peak = arena->used;
+	}
+	arena->used = 0;
+}
+
+/**
+ * Allocations are made from the current half, and the other half holds the
+ * previous frame's allocations.
+ */
+static CnArena s_frameArenas[2];
+static uint32_t s_currentFrameArena;
+
+void cnFrameArena_Init(uint32_t size)
+{
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(s_frameArenas); ++i) {
+		cnArena_Allocate(&s_frameArenas[i], size);
+	}
+	s_currentFrameArena = 0;
+}
+
+void cnFrameArena_Shutdown(void)
+{
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(s_frameArenas); ++i) {
+		cnArena_Free(&s_frameArenas[i]);
+	}
+}
+
+void* cnFrameArena_Alloc(uint32_t size, uint32_t align)
+{
+	CnArena* arena = &s_frameArenas[s_currentFrameArena];
+	CN_ASSERT(arena->buffer.contents != NULL, "The frame arena has not been initialized.");
+
+	void* allocation = cnArena_Alloc(arena, size, align);
+	if (!allocation) {
+		CN_FATAL_ERROR("Frame arena is out of space allocating %" PRIu32 " bytes, %" PRIu32
+			" of %" PRIu32 " bytes used.", size, arena->used, arena->buffer.size);
+	}
+	return allocation;
+}
+
+/**
+ * Switches halves, releasing what was allocated the frame before this one.
+ */
+void cnFrameArena_EndFrame(void)
+{
+	CnArena* finished = &s_frameArenas[s_currentFrameArena];
+	if (finished->used > s_stats.frameArenaPeakBytes) {
+		s_stats.frameArenaPeakBytes = finished->used;
+	}
+
+	s_currentFrameArena ^= 1;
+	cnArena_Reset(&s_frameArenas[s_currentFrameArena]);
+}
+
+/**
+ * Alignment of pool blocks, enough for SSE types.  Slabs start with a header
+ * of this size which links them together.
+ */
+#define CN_POOL_ALIGN 16
+
+#define CN_POOL_POISON 0xDD
+
+static void cnPool_Poison(const CnPool* pool, void* block)
+{
+	// The start of a free block holds the free list link.
+	memset((char*)block + sizeof(void*), CN_POOL_POISON, pool->blockSize - sizeof(void*));
+}
+
+static void cnPool_CheckPoison(const CnPool* pool, const void* block)
+{
+	const unsigned char* bytes = (const unsigned char*)block;
+	for (uint32_t i = sizeof(void*); i < pool->blockSize; ++i) {
+		CN_ASSERT(bytes[i] == CN_POOL_POISON,
+			"Pool block %p was written to after being released, at byte %" PRIu32, block, i);
+	}
+}
+
+static bool cnPool_Owns(const CnPool* pool, const void* block)
+{
+	const uint32_t slabSize = CN_POOL_ALIGN + pool->blockSize * pool->blocksPerSlab;
+	for (const char* slab = pool->slabs; slab; slab = *(char* const*)slab) {
+		const char* blocks = slab + CN_POOL_ALIGN;
+		if ((const char*)block >= blocks && (const char*)block < slab + slabSize) {
+			return ((const char*)block - blocks) % pool->blockSize == 0;
+		}
+	}
+	return false;
+}
+
+/**
+ * Makes an empty pool of blocks of at least `blockSize` bytes.  Slabs of
+ * `blocksPerSlab` blocks are allocated as needed.
+ */
+void cnPool_Allocate(CnPool* pool, uint32_t blockSize, uint32_t blocksPerSlab, uint32_t flags)
+{
+	CN_ASSERT_PTR(pool);
+	CN_ASSERT(blockSize > 0, "Pool blocks must have a size.");
+	CN_ASSERT(blocksPerSlab > 0, "Pool slabs must have at least one block.");
+
+	memset(pool, 0, sizeof(CnPool));
+
+	// Free blocks must be able to hold the free list link.
+	if (blockSize < sizeof(void*)) {
+		blockSize = sizeof(void*);
+	}
+	pool->blockSize = (blockSize + CN_POOL_ALIGN - 1) & ~(uint32_t)(CN_POOL_ALIGN - 1);
+	pool->blocksPerSlab = blocksPerSlab;
+	pool->flags = flags;
+	cnAtomic_FetchAddU32(&s_outstandingPools, 1);
+}
+
+/**
+ * Releases every slab, invalidating all blocks from the pool.
+ */
+void cnPool_Free(CnPool* pool)
+{
+	CN_ASSERT_PTR(pool);
+
+	if (pool->outstanding != 0) {
+		CN_WARN(LogSysMemory, "Freeing pool with %" PRIu64 " blocks still in use.", pool->outstanding);
+		cnAtomic_FetchSubU64(&s_outstandingPoolBlocks, pool->outstanding);
+	}
+
+	const uint32_t slabSize = CN_POOL_ALIGN + pool->blockSize * pool->blocksPerSlab;
+	char* slab = pool->slabs;
+	while (slab) {
+		char* previous = *(char**)slab;
+		CnDynamicBuffer buffer = { .contents = slab, .size = slabSize };
+		cnDynamicBuffer_Free(&buffer);
+		slab = previous;
+	}
+
+	pool->slabs = NULL;
+	pool->freeList = NULL;
+	pool->numSlabs = 0;
+	pool->outstanding = 0;
+
+	if (cnAtomic_LoadU32(&s_outstandingPools) == 0) {
+		CN_ERROR(LogSysMemory, "Double free of pool %p", (void*)pool);
+	}
+	else {
+		cnAtomic_FetchSubU32(&s_outstandingPools, 1);
+	}
+}
+
+/**
+ * Adds a slab and puts all of its blocks on the free list.
+ */
+static void cnPool_AddSlab(CnPool* pool)
+{
+	CnDynamicBuffer buffer;
+	cnDynamicBuffer_Allocate(&buffer, CN_POOL_ALIGN + pool->blockSize * pool->blocksPerSlab);
+	if (!buffer.contents) {
+		CN_FATAL_ERROR("Unable to allocate a slab for a pool.");
+	}
+
+	*(void**)buffer.contents = pool->slabs;
+	pool->slabs = buffer.contents;
+	++pool->numSlabs;
+
+	// Link in reverse, so blocks are handed out in address order.
+	char* blocks = buffer.contents + CN_POOL_ALIGN;
+	for (uint32_t i = pool->blocksPerSlab; i > 0; --i) {
+		void* block = blocks + (i - 1) * pool->blockSize;
+		*(void**)block = pool->freeList;
+		if (pool->flags & CnPoolFlagPoison) {
+			cnPool_Poison(pool, block);
+		}
+		pool->freeList = block;
+	}
+}
+
+void* cnPool_Alloc(CnPool* pool)
+{
+	CN_ASSERT_PTR(pool);
+
+	if (!pool->freeList) {
+		cnPool_AddSlab(pool);
+	}
+
+	void* block = pool->freeList;
+	if (pool->flags & CnPoolFlagPoison) {
+		cnPool_CheckPoison(pool, block);
+	}
+	pool->freeList = *(void**)block;
+
+	++pool->outstanding;
+	cnAtomic_FetchAddU64(&s_outstandingPoolBlocks, 1);
+	if (pool->flags & CnPoolFlagStats) {
+		++pool->stats.numAllocs;
+		if (pool->outstanding > pool->stats.peakOutstanding) {
+			pool->stats.peakOutstanding = pool->outstanding;
+		}
 	}
+	return block;
+}
+
+/**
+ * Returns a block to the pool it came from, to be handed out again.
+ */
+void cnPool_Release(CnPool* pool, void* block)
+{
+	CN_ASSERT_PTR(pool);
+	CN_ASSERT_PTR(block);
+	CN_ASSERT(pool->outstanding > 0, "Releasing a block to a pool with none outstanding.");
+
+	if (pool->flags & CnPoolFlagPoison) {
+		CN_ASSERT(cnPool_Owns(pool, block), "Releasing block %p to a pool which it didn't come from.", block);
+		cnPool_Poison(pool, block);
+	}
+
+	*(void**)block = pool->freeList;
+	pool->freeList = block;
+
+	--pool->outstanding;
+	cnAtomic_FetchSubU64(&s_outstandingPoolBlocks, 1);
+	if (pool->flags & CnPoolFlagStats) {
+		++pool->stats.numReleases;
+	}
+}
+
+CnMemoryStats cnMemory_Stats(void)
+{
+	CnMemoryStats stats = s_stats;
+	stats.numAllocations = cnAtomic_LoadU64(&s_numAllocations);
+	stats.numFrees = cnAtomic_LoadU64(&s_numFrees);
+	stats.outstandingBytes = cnAtomic_LoadU64(&s_outstandingBytes);
+	stats.peakBytes = cnAtomic_LoadU64(&s_peakBytes);
+	stats.outstandingPoolBlocks = cnAtomic_LoadU64(&s_outstandingPoolBlocks);
+	return stats;
 }
 
 void cnMemory_Shutdown(void)
 {
-	if (s_outstandingDynamicBuffers != 0) {
+	cnFrameArena_Shutdown();
+	if (cnAtomic_LoadU32(&s_outstandingDynamicBuffers) != 0) {
 		//CN_ERROR(LogSysMemory, "Memory systems leaks: %" PRIu32, s_outstandingDynamicBuffers);
 	}
+	const uint32_t outstandingPools = cnAtomic_LoadU32(&s_outstandingPools);
+	if (outstandingPools != 0) {
+		CN_WARN(LogSysMemory, "Pools not freed: %" PRIu32 ", with %" PRIu64 " blocks in use.",
+			outstandingPools, cnAtomic_LoadU64(&s_outstandingPoolBlocks));
+	}
 }
 
 const char* cnMemory_Name(void)
@@ -23,6 +23,128 @@ typedef struct {
 CN_API void cnDynamicBuffer_Allocate(CnDynamicBuffer* buffer, uint32_t size);
 CN_API void cnDynamicBuffer_Free(CnDynamicBuffer* buffer);
 
+/**
+ * Counts of dynamic buffer allocations since startup.
+ */
+typedef struct {
+	uint64_t numAllocations;
+	uint64_t numFrees;
+
+	/** Bytes in buffers which haven't been freed. */
+	uint64_t outstandingBytes;
+
+	/** Most bytes outstanding at any one time. */
+	uint64_t peakBytes;
+
+	/** Most bytes of the frame arena used in a single frame. */
+	uint64_t frameArenaPeakBytes;
+
+	/** Blocks from all pools which haven't been released. */
+	uint64_t outstandingPoolBlocks;
+} CnMemoryStats;
+
+CN_API CnMemoryStats cnMemory_Stats(void);
+
+/**
+ * A linear allocator over a single buffer.  Allocating moves an offset forward,
+ * and everything is released at once by resetting it, so there's no per
+ * allocation bookkeeping and nothing to free individually.
+ *
+ * Allocating is safe from multiple threads, but resetting is not.
+ */
+typedef struct {
+	CnDynamicBuffer buffer;
+
+	/** Bytes from the start of the buffer which have been handed out. */
+	volatile uint32_t used;
+
+	/** Most bytes used between resets. */
+	uint32_t peak;
+} CnArena;
+
+CN_API void  cnArena_Allocate(CnArena* arena, uint32_t size);
+CN_API void  cnArena_Free(CnArena* arena);
+CN_API void* cnArena_Alloc(CnArena* arena, uint32_t size, uint32_t align);
+CN_API void  cnArena_Reset(CnArena* arena);
+
+/**
+ * Bytes reserved up front for each half of the frame arena.
+ */
+#define CN_FRAME_ARENA_SIZE (4 * 1024 * 1024)
+
+/**
+ * The frame arena provides scratch memory for temporary data, such as a
+ * buffer used while transforming something, without a heap allocation.
+ *
+ * The arena is double-buffered: memory allocated during a frame stays valid
+ * until the end of the next frame, so data made one frame can still be read
+ * during the following one.  Running out of space is a fatal error.
+ */
+CN_API void* cnFrameArena_Alloc(uint32_t size, uint32_t align);
+
+CN_TEST_API void cnFrameArena_Init(uint32_t size);
+CN_TEST_API void cnFrameArena_Shutdown(void);
+CN_TEST_API void cnFrameArena_EndFrame(void);
+
+typedef enum {
+	/** Count allocations, releases and the most blocks in use at once. */
+	CnPoolFlagStats = 1 << 0,
+
+	/**
+	 * Fill released blocks with a pattern which is checked when they are
+	 * handed out again, to catch writes through dangling pointers.  Also
+	 * checks released blocks belong to the pool.
+	 */
+	CnPoolFlagPoison = 1 << 1
+} CnPoolFlags;
+
+#if CN_DEBUG
+	#define CN_POOL_DEFAULT_FLAGS (CnPoolFlagStats | CnPoolFlagPoison)
+#else
+	#define CN_POOL_DEFAULT_FLAGS 0
+#endif
+
+typedef struct {
+	uint64_t numAllocs;
+	uint64_t numReleases;
+	uint64_t peakOutstanding;
+} CnPoolStats;
+
+/**
+ * Fixed size blocks for objects which are made and destroyed often, such as
+ * projectiles or timers.
+ *
+ * Blocks are carved out of larger slabs, which are only returned when the pool
+ * is freed.  Released blocks go on a free list threaded through the blocks
+ * themselves, so allocating and releasing are constant time, and never touch
+ * the heap once enough slabs exist.  Blocks are aligned for SIMD types.
+ *
+ * Pools aren't thread-safe, so each should be owned by one system or job.  The
+ * number of blocks outstanding across all pools is reported on shutdown.
+ */
+typedef struct {
+	/** Next free block, with each free block pointing to the one after. */
+	void* freeList;
+
+	/** Most recently added slab, with each slab pointing to the one before. */
+	void* slabs;
+
+	uint32_t blockSize;
+	uint32_t blocksPerSlab;
+	uint32_t flags;
+	uint32_t numSlabs;
+
+	/** Blocks handed out which haven't been released. */
+	uint64_t outstanding;
+
+	CnPoolStats stats;
+} CnPool;
+
+CN_API void  cnPool_Allocate(CnPool* pool, uint32_t blockSize, uint32_t blocksPerSlab, uint32_t flags);
+CN_API void  cnPool_Free(CnPool* pool);
+CN_API void* cnPool_Alloc(CnPool* pool);
+CN_API void  cnPool_Release(CnPool* pool, void* block);
+
 CnSystem cnMemory_System(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,273 @@
+#include "particles.h"
+
+#include <calendon/cn.h>
+
+/*
+ * SSE is available on every x86-64 target, so it is used whenever possible.
+ * AVX requires opting in through compiler flags (e.g. `-mavx`), since there's
+ * no runtime dispatch.
+ */
+#if defined(__AVX__)
+	#define CN_PARTICLES_AVX 1
+	#include <immintrin.h>
+#else
+	#define CN_PARTICLES_AVX 0
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define CN_PARTICLES_SSE 1
+	#include <xmmintrin.h>
+#else
+	#define CN_PARTICLES_SSE 0
+#endif
+
+/**
+ * Keep every array starting on a 32 byte boundary relative to the start of
+ * storage.
+ */
+#define CN_PARTICLES_CAPACITY_ALIGNMENT 8
+
+void cnParticles_Allocate(CnParticles* particles, uint32_t capacity)
+{
+	CN_ASSERT_PTR(particles);
+	CN_ASSERT(capacity > 0, "Cannot create storage for zero particles.");
+
+	const uint32_t aligned = (capacity + CN_PARTICLES_CAPACITY_ALIGNMENT - 1)
+		/ CN_PARTICLES_CAPACITY_ALIGNMENT * CN_PARTICLES_CAPACITY_ALIGNMENT;
+	const uint32_t floatArraySize = aligned * (uint32_t)sizeof(float);
+	const uint32_t colorArraySize = aligned * (uint32_t)sizeof(CnRGBA8u);
+	cnDynamicBuffer_Allocate(&particles->storage, 6 * floatArraySize + colorArraySize);
+
+	char* next = particles->storage.contents;
+	particles->x = (float*)next;        next += floatArraySize;
+	particles->y = (float*)next;        next += floatArraySize;
+	particles->vx = (float*)next;       next += floatArraySize;
+	particles->vy = (float*)next;       next += floatArraySize;
+	particles->age = (float*)next;      next += floatArraySize;
+	particles->lifetime = (float*)next; next += floatArraySize;
+	particles->color = (CnRGBA8u*)next;
+
+	particles->count = 0;
+	particles->capacity = capacity;
+}
+
+void cnParticles_Free(CnParticles* particles)
+{
+	CN_ASSERT_PTR(particles);
+	cnDynamicBuffer_Free(&particles->storage);
+	particles->count = 0;
+	particles->capacity = 0;
+}
+
+/**
+ * Adds a new particle.  Returns false if there is no room for it.
+ */
+bool cnParticles_Spawn(CnParticles* particles, CnFloat2 position, CnFloat2 velocity,
+	float lifetime, CnRGBA8u color)
+{
+	CN_ASSERT_PTR(particles);
+	if (particles->count == particles->capacity) {
+		return false;
+	}
+
+	const uint32_t i = particles->count++;
+	particles->x[i] = position.x;
+	particles->y[i] = position.y;
+	particles->vx[i] = velocity.x;
+	particles->vy[i] = velocity.y;
+	particles->age[i] = 0.0f;
+	particles->lifetime[i] = lifetime;
+	particles->color[i] = color;
+	return true;
+}
+
+/**
+ * Integrates and ages particles in the range [start, end) one at a time.
+ */
+static void cnParticles_IntegrateScalar(CnParticles* p, uint32_t start, uint32_t end,
+	float dt, CnFloat2 acceleration)
+{
+	const float dvx = acceleration.x * dt;
+	const float dvy = acceleration.y * dt;
+	for (uint32_t i = start; i < end; ++i) {
+		p->vx[i] += dvx;
+		p->vy[i] += dvy;
+		p->x[i] += p->vx[i] * dt;
+		p->y[i] += p->vy[i] * dt;
+		p->age[i] += dt;
+	}
+}
+
+/**
+ * Integrates and ages as many particles as possible with SIMD instructions,
+ * returning the index of the first particle not processed.
+ */
+static uint32_t cnParticles_IntegrateWide(CnParticles* p, float dt, CnFloat2 acceleration)
+{
+	uint32_t i = 0;
+#if CN_PARTICLES_AVX
+	{
+		const __m256 dt8 = _mm256_set1_ps(dt);
+		const __m256 dvx = _mm256_set1_ps(acceleration.x * dt);
+		const __m256 dvy = _mm256_set1_ps(acceleration.y * dt);
+		for (; i + 8 <= p->count; i += 8) {
+			const __m256 vx = _mm256_add_ps(_mm256_loadu_ps(&p->vx[i]), dvx);
+			const __m256 vy = _mm256_add_ps(_mm256_loadu_ps(&p->vy[i]), dvy);
+			_mm256_storeu_ps(&p->vx[i], vx);
+			_mm256_storeu_ps(&p->vy[i], vy);
+			_mm256_storeu_ps(&p->x[i], _mm256_add_ps(_mm256_loadu_ps(&p->x[i]), _mm256_mul_ps(vx, dt8)));
+			_mm256_storeu_ps(&p->y[i], _mm256_add_ps(_mm256_loadu_ps(&p->y[i]), _mm256_mul_ps(vy, dt8)));
+			_mm256_storeu_ps(&p->age[i], _mm256_add_ps(_mm256_loadu_ps(&p->age[i]), dt8));
+		}
+	}
+#endif
+#if CN_PARTICLES_SSE
+	{
+		const __m128 dt4 = _mm_set1_ps(dt);
+		const __m128 dvx = _mm_set1_ps(acceleration.x * dt);
+		const __m128 dvy = _mm_set1_ps(acceleration.y * dt);
+		for (; i + 4 <= p->count; i += 4) {
+			const __m128 vx = _mm_add_ps(_mm_loadu_ps(&p->vx[i]), dvx);
+			const __m128 vy = _mm_add_ps(_mm_loadu_ps(&p->vy[i]), dvy);
+			_mm_storeu_ps(&p->vx[i], vx);
+			_mm_storeu_ps(&p->vy[i], vy);
+			_mm_storeu_ps(&p->x[i], _mm_add_ps(_mm_loadu_ps(&p->x[i]), _mm_mul_ps(vx, dt4)));
+			_mm_storeu_ps(&p->y[i], _mm_add_ps(_mm_loadu_ps(&p->y[i]), _mm_mul_ps(vy, dt4)));
+			_mm_storeu_ps(&p->age[i], _mm_add_ps(_mm_loadu_ps(&p->age[i]), dt4));
+		}
+	}
+#else
+	CN_UNUSED(p);
+	CN_UNUSED(dt);
+	CN_UNUSED(acceleration);
+#endif
+	return i;
+}
+
+/**
+ * Moves the last particle into the given slot.
+ */
+static void cnParticles_SwapRemove(CnParticles* p, uint32_t i)
+{
+	const uint32_t last = --p->count;
+	p->x[i] = p->x[last];
+	p->y[i] = p->y[last];
+	p->vx[i] = p->vx[last];
+	p->vy[i] = p->vy[last];
+	p->age[i] = p->age[last];
+	p->lifetime[i] = p->lifetime[last];
+	p->color[i] = p->color[last];
+}
+
+/**
+ * Removes all particles which have reached their lifetime.  Groups of live
+ * particles are skipped over with a single comparison when possible.
+ */
+static void cnParticles_Compact(CnParticles* p)
+{
+	uint32_t i = 0;
+	while (i < p->count) {
+#if CN_PARTICLES_SSE
+		if (i + 4 <= p->count) {
+			const __m128 dead = _mm_cmpge_ps(_mm_loadu_ps(&p->age[i]), _mm_loadu_ps(&p->lifetime[i]));
+			if (_mm_movemask_ps(dead) == 0) {
+				i += 4;
+				continue;
+			}
+		}
+#endif
+		// The swapped in particle might also be dead, so check this slot again.
+		if (p->age[i] >= p->lifetime[i]) {
+			cnParticles_SwapRemove(p, i);
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+/**
+ * Moves all particles forward in time by `dt` seconds under a constant
+ * acceleration, removing those which die.
+ */
+void cnParticles_Update(CnParticles* particles, float dt, CnFloat2 acceleration)
+{
+	CN_ASSERT_PTR(particles);
+	CN_ASSERT(dt >= 0.0f, "Cannot update particles backwards in time: %f", dt);
+
+	const uint32_t processed = cnParticles_IntegrateWide(particles, dt, acceleration);
+	cnParticles_IntegrateScalar(particles, processed, particles->count, dt, acceleration);
+	cnParticles_Compact(particles);
+}
+
+/**
+ * Xorshift random number generator, returning a value in [0, 1).
+ */
+static float cnParticleEmitter_Random(CnParticleEmitter* emitter)
+{
+	uint32_t x = emitter->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	emitter->seed = x;
+	return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+static float cnParticleEmitter_RandomRange(CnParticleEmitter* emitter, float low, float high)
+{
+	return low + (high - low) * cnParticleEmitter_Random(emitter);
+}
+
+/**
+ * Creates an emitter with room for a given number of live particles.  The
+ * emitter doesn't spawn anything until its `rate` is set.
+ */
+void cnParticleEmitter_Allocate(CnParticleEmitter* emitter, uint32_t capacity)
+{
+	CN_ASSERT_PTR(emitter);
+	cnParticles_Allocate(&emitter->particles, capacity);
+	emitter->position = cnFloat2_Make(0.0f, 0.0f);
+	emitter->acceleration = cnFloat2_Make(0.0f, 0.0f);
+	emitter->velocityRange = cnAABB2_MakeMinMax(cnFloat2_Make(0.0f, 0.0f), cnFloat2_Make(0.0f, 0.0f));
+	emitter->minLifetime = 1.0f;
+	emitter->maxLifetime = 1.0f;
+	emitter->rate = 0.0f;
+	emitter->color = (CnRGBA8u) { 255, 255, 255, 255 };
+	emitter->spawnDebt = 0.0f;
+	emitter->seed = 0x9E3779B9u;
+}
+
+void cnParticleEmitter_Free(CnParticleEmitter* emitter)
+{
+	CN_ASSERT_PTR(emitter);
+	cnParticles_Free(&emitter->particles);
+}
+
+/**
+ * Updates existing particles, then spawns new ones according to the emitter's
+ * rate.  Particles which don't fit are dropped.
+ */
+void cnParticleEmitter_Update(CnParticleEmitter* emitter, float dt)
+{
+	CN_ASSERT_PTR(emitter);
+	CN_ASSERT(emitter->seed != 0, "Emitter random seed must be non-zero.");
+
+	cnParticles_Update(&emitter->particles, dt, emitter->acceleration);
+
+	emitter->spawnDebt += emitter->rate * dt;
+	const uint32_t numToSpawn = (uint32_t)emitter->spawnDebt;
+	emitter->spawnDebt -= (float)numToSpawn;
+
+	const CnAABB2 v = emitter->velocityRange;
+	for (uint32_t i = 0; i < numToSpawn; ++i) {
+		const CnFloat2 velocity = cnFloat2_Make(
+			cnParticleEmitter_RandomRange(emitter, v.min.x, v.max.x),
+			cnParticleEmitter_RandomRange(emitter, v.min.y, v.max.y));
+		const float lifetime = cnParticleEmitter_RandomRange(emitter,
+			emitter->minLifetime, emitter->maxLifetime);
+		if (!cnParticles_Spawn(&emitter->particles, emitter->position, velocity,
+			lifetime, emitter->color)) {
+			break;
+		}
+	}
+}
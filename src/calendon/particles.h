@@ -0,0 +1,93 @@
+#ifndef CN_PARTICLES_H
+#define CN_PARTICLES_H
+
+/**
+ * @file particles.h
+ *
+ * Large numbers of simple, short-lived, independently moving points.
+ *
+ * Particles are stored as a structure of arrays so updates can process
+ * several particles at once with SIMD instructions.  Dead particles are
+ * removed by swapping in the last live particle, so live particles are always
+ * packed at the front of every array and their order is not preserved.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/color.h>
+#include <calendon/math2.h>
+#include <calendon/memory.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	float* x;
+	float* y;
+	float* vx;
+	float* vy;
+
+	/** Seconds since the particle was spawned. */
+	float* age;
+
+	/** The particle dies when its age reaches its lifetime, in seconds. */
+	float* lifetime;
+
+	CnRGBA8u* color;
+
+	/** The number of live particles. */
+	uint32_t count;
+	uint32_t capacity;
+
+	/** Single block backing all of the arrays. */
+	CnDynamicBuffer storage;
+} CnParticles;
+
+/**
+ * Continuously spawns particles at a rate, with velocities and lifetimes
+ * randomly chosen within ranges.
+ */
+typedef struct {
+	CnParticles particles;
+
+	/** Where new particles spawn. */
+	CnFloat2 position;
+
+	/** Constant acceleration applied to all particles, such as gravity. */
+	CnFloat2 acceleration;
+
+	/** New particle velocities are chosen uniformly within this box. */
+	CnAABB2 velocityRange;
+
+	float minLifetime;
+	float maxLifetime;
+
+	/** Particles spawned per second. */
+	float rate;
+
+	/** Color given to new particles. */
+	CnRGBA8u color;
+
+	/** Fractional particles owed from previous updates. */
+	float spawnDebt;
+
+	/** State of the random number generator, must be non-zero. */
+	uint32_t seed;
+} CnParticleEmitter;
+
+CN_API void     cnParticles_Allocate(CnParticles* particles, uint32_t capacity);
+CN_API void     cnParticles_Free(CnParticles* particles);
+CN_API bool     cnParticles_Spawn(CnParticles* particles, CnFloat2 position, CnFloat2 velocity,
+	float lifetime, CnRGBA8u color);
+CN_API void     cnParticles_Update(CnParticles* particles, float dt, CnFloat2 acceleration);
+
+CN_API void     cnParticleEmitter_Allocate(CnParticleEmitter* emitter, uint32_t capacity);
+CN_API void     cnParticleEmitter_Free(CnParticleEmitter* emitter);
+CN_API void     cnParticleEmitter_Update(CnParticleEmitter* emitter, float dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_PARTICLES_H */
@@ -8,6 +8,35 @@
 #include <tchar.h>
 #include <psapi.h>
 
+#else
+
+#include <sys/resource.h>
+
+#endif /* _WIN32 */
+
+/**
+ * The most physical memory the process has used at once, or zero if unknown.
+ */
+uint64_t cnProc_PeakMemoryBytes(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return (uint64_t)counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	// Reported in kilobytes.
+	return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+#ifdef _WIN32
+
 // Adapted from sample code at:
 // https://docs.microsoft.com/en-us/windows/win32/psapi/enumerating-all-modules-for-a-process?redirectedfrom=MSDN
 bool cnProc_PrintLoadedDLLs(void)
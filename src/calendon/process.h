@@ -7,6 +7,8 @@
 extern "C" {
 #endif
 
+CN_API uint64_t cnProc_PeakMemoryBytes(void);
+
 #ifdef _WIN32
 
 // https://docs.microsoft.com/en-us/windows/win32/psapi/enumerating-all-modules-for-a-process?redirectedfrom=MSDN
@@ -0,0 +1,58 @@
+#include "profile-config.h"
+
+#include <calendon/cn.h>
+
+#include <calendon/path.h>
+#include <calendon/string.h>
+
+int32_t cnProfile_OptionTracePath(const CnCommandLineParse* parse, void* c);
+
+static CnProfileConfig s_config;
+static CnCommandLineOption options[] = {
+	{
+		"\t--profile TRACE_FILE\n"
+			"\t\tWrite profiled zones as Chrome trace events to TRACE_FILE at\n"
+			"\t\tshutdown.  Requires building with CN_ENABLE_PROFILER.\n",
+		NULL,
+		"--profile",
+		cnProfile_OptionTracePath
+	},
+};
+
+CnCommandLineOptionList cnProfile_CommandLineOptionList(void) {
+	CnCommandLineOptionList optionList;
+	optionList.options = options;
+	optionList.numOptions = 1;
+	return optionList;
+}
+
+int32_t cnProfile_OptionTracePath(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnProfileConfig* config = (CnProfileConfig*)c;
+
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a file to write the trace to.\n");
+		return CnOptionParseError;
+	}
+
+	const char* tracePath = cnCommandLineParse_LookAhead(parse, 2);
+	if (!cnString_FitsWithNull(tracePath, CN_MAX_TERMINATED_PATH)) {
+		cnPrint("The trace path is too long.\n");
+		return CnOptionParseError;
+	}
+	cnPathBuffer_Set(&config->tracePath, tracePath);
+	return 2;
+}
+
+void* cnProfile_Config(void) {
+	return &s_config;
+}
+
+void cnProfile_SetDefaultConfig(void* config)
+{
+	CnProfileConfig* c = (CnProfileConfig*)config;
+	cnPathBuffer_Clear(&c->tracePath);
+}
@@ -0,0 +1,19 @@
+#ifndef CN_PROFILE_CONFIG_H
+#define CN_PROFILE_CONFIG_H
+
+#include <calendon/cn.h>
+#include <calendon/path.h>
+#include <calendon/system.h>
+
+typedef struct {
+	/**
+	 * Where to write the trace at shutdown, or empty to not write one.
+	 */
+	CnPathBuffer tracePath;
+} CnProfileConfig;
+
+CnCommandLineOptionList cnProfile_CommandLineOptionList(void);
+void* cnProfile_Config(void);
+void cnProfile_SetDefaultConfig(void* config);
+
+#endif /* CN_PROFILE_CONFIG_H */
@@ -0,0 +1,326 @@
+#include "profile.h"
+
+#include <calendon/atomic.h>
+#include <calendon/json.h>
+#include <calendon/log.h>
+#include <calendon/profile-config.h>
+#include <calendon/time.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CN_ENABLE_PROFILER
+
+/**
+ * Threads after this many which record zones are ignored.
+ */
+#define CN_PROFILE_MAX_THREADS 64
+
+/**
+ * Zones nested deeper than this are dropped.
+ */
+#define CN_PROFILE_MAX_DEPTH 64
+
+typedef struct {
+	const char* name;
+	uint64_t start;
+	uint64_t end;
+
+	/** Order in which zones began on their thread, to nest them when written. */
+	uint64_t sequence;
+
+	/** Number of zones this one is nested in. */
+	uint32_t depth;
+} CnProfileZone;
+
+/**
+ * Only the thread which owns the buffer writes to it.
+ *
+ * Zones are kept in a ring once they end, so the trace covers the most recent
+ * part of a long run.  Zones end before the zones they are nested in, so the
+ * oldest zones get overwritten without leaving zones nested in ones which are
+ * gone.
+ */
+typedef struct {
+	CnProfileZone zones[CN_PROFILE_MAX_ZONES];
+	uint64_t numEnded;
+	uint64_t numBegun;
+	uint32_t numDropped;
+
+	/** Zones which have begun but not ended, outermost first. */
+	CnProfileZone openZones[CN_PROFILE_MAX_DEPTH];
+	uint32_t depth;
+} CnProfileThreadBuffer;
+
+static CnProfileThreadBuffer* s_threadBuffers[CN_PROFILE_MAX_THREADS];
+static volatile uint32_t s_numThreads;
+static CN_THREAD_LOCAL CnProfileThreadBuffer* t_buffer;
+static CN_THREAD_LOCAL bool t_registered;
+
+static CnTime s_startTime;
+
+/**
+ * Gets the calling thread's buffer, creating it on first use.  Returns NULL if
+ * too many threads have recorded zones.
+ */
+static CnProfileThreadBuffer* cnProfile_ThreadBuffer(void)
+{
+	if (t_registered) {
+		return t_buffer;
+	}
+	t_registered = true;
+
+	const uint32_t index = cnAtomic_FetchAddU32(&s_numThreads, 1);
+	if (index >= CN_PROFILE_MAX_THREADS) {
+		return NULL;
+	}
+
+	CnProfileThreadBuffer* buffer = calloc(1, sizeof(CnProfileThreadBuffer));
+	if (!buffer) {
+		return NULL;
+	}
+	s_threadBuffers[index] = buffer;
+	t_buffer = buffer;
+	return buffer;
+}
+
+void cnProfile_Begin(const char* name)
+{
+	CnProfileThreadBuffer* buffer = cnProfile_ThreadBuffer();
+	if (!buffer) {
+		return;
+	}
+
+	if (buffer->depth < CN_PROFILE_MAX_DEPTH) {
+		buffer->openZones[buffer->depth] = (CnProfileZone) {
+			.name = name,
+			.start = cnTime_MakeNow().native,
+			.end = 0,
+			.sequence = buffer->numBegun++,
+			.depth = buffer->depth
+		};
+	}
+	else {
+		++buffer->numDropped;
+	}
+	++buffer->depth;
+}
+
+void cnProfile_End(void)
+{
+	CnProfileThreadBuffer* buffer = cnProfile_ThreadBuffer();
+	if (!buffer) {
+		return;
+	}
+	CN_ASSERT(buffer->depth > 0, "Ending a profile zone which never began.");
+
+	--buffer->depth;
+	if (buffer->depth < CN_PROFILE_MAX_DEPTH) {
+		CnProfileZone* zone = &buffer->zones[buffer->numEnded % CN_PROFILE_MAX_ZONES];
+		*zone = buffer->openZones[buffer->depth];
+		zone->end = cnTime_MakeNow().native;
+		++buffer->numEnded;
+	}
+}
+
+/**
+ * Microseconds since the profiler started, which is the unit trace events use.
+ */
+static double cnProfile_TraceTime(uint64_t ns)
+{
+	return (double)cnUInt64_SubtractMonotonic(ns, s_startTime.native) / 1000.0;
+}
+
+static void cnProfile_WriteEvent(FILE* file, char phase, uint32_t threadIndex, const char* name, uint64_t ns)
+{
+	fprintf(file, ",\n{\"name\":");
+	cnJSON_WriteString(file, name);
+	fprintf(file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%.3f}",
+		phase, threadIndex, cnProfile_TraceTime(ns));
+}
+
+static int cnProfile_CompareSequence(const void* left, const void* right)
+{
+	const uint64_t l = ((const CnProfileZone*)left)->sequence;
+	const uint64_t r = ((const CnProfileZone*)right)->sequence;
+	return (l > r) - (l < r);
+}
+
+/**
+ * Copies the zones kept by a thread into `zones`, in the order they began.
+ * Zones which haven't ended yet are included as ending at `now`.  Returns the
+ * number of zones copied.
+ */
+static uint32_t cnProfile_SortedZones(const CnProfileThreadBuffer* buffer, CnProfileZone* zones, uint64_t now)
+{
+	const uint32_t numKept = buffer->numEnded < CN_PROFILE_MAX_ZONES
+		? (uint32_t)buffer->numEnded
+		: CN_PROFILE_MAX_ZONES;
+	memcpy(zones, buffer->zones, numKept * sizeof(CnProfileZone));
+
+	uint32_t numZones = numKept;
+	for (uint32_t i = 0; i < buffer->depth && i < CN_PROFILE_MAX_DEPTH; ++i) {
+		zones[numZones] = buffer->openZones[i];
+		zones[numZones].end = now;
+		++numZones;
+	}
+
+	qsort(zones, numZones, sizeof(CnProfileZone), cnProfile_CompareSequence);
+	return numZones;
+}
+
+/**
+ * Writes the zones kept so far in Chrome's trace event format, as begin and end
+ * events.  Zones are nested by the order they began rather than by their times,
+ * which can be equal with a coarse clock.  Other threads must not be recording
+ * zones while this happens.  Zones which haven't ended yet are written as
+ * ending now.
+ */
+bool cnProfile_WriteTrace(const char* path)
+{
+	CN_ASSERT_PTR(path);
+
+	CnProfileZone* zones = malloc((CN_PROFILE_MAX_ZONES + CN_PROFILE_MAX_DEPTH) * sizeof(CnProfileZone));
+	if (!zones) {
+		CN_ERROR(LogSysMain, "Unable to allocate space to sort profile zones.");
+		return false;
+	}
+
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		CN_ERROR(LogSysMain, "Unable to open trace file: %s", path);
+		free(zones);
+		return false;
+	}
+
+	const uint64_t now = cnTime_MakeNow().native;
+	uint32_t numThreads = cnAtomic_LoadU32(&s_numThreads);
+	if (numThreads > CN_PROFILE_MAX_THREADS) {
+		numThreads = CN_PROFILE_MAX_THREADS;
+	}
+
+	uint64_t numDropped = 0;
+	uint64_t numOverwritten = 0;
+	bool first = true;
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (uint32_t threadIndex = 0; threadIndex < numThreads; ++threadIndex) {
+		const CnProfileThreadBuffer* buffer = s_threadBuffers[threadIndex];
+		if (!buffer) {
+			continue;
+		}
+		numDropped += buffer->numDropped;
+		if (buffer->numEnded > CN_PROFILE_MAX_ZONES) {
+			numOverwritten += buffer->numEnded - CN_PROFILE_MAX_ZONES;
+		}
+
+		char threadName[32];
+		if (threadIndex == 0) {
+			cnString_Format(threadName, sizeof(threadName), "Main");
+		}
+		else {
+			cnString_Format(threadName, sizeof(threadName), "Thread %" PRIu32, threadIndex);
+		}
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32
+			",\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", threadIndex, threadName);
+		first = false;
+
+		// In the order zones began, a zone ends before the next zone at the
+		// same or a shallower depth begins.
+		const uint32_t numZones = cnProfile_SortedZones(buffer, zones, now);
+		uint32_t openZones[CN_PROFILE_MAX_DEPTH];
+		uint32_t numOpen = 0;
+		for (uint32_t i = 0; i <= numZones; ++i) {
+			const uint32_t depth = i < numZones ? zones[i].depth : 0;
+			while (numOpen > depth) {
+				const CnProfileZone* open = &zones[openZones[--numOpen]];
+				cnProfile_WriteEvent(file, 'E', threadIndex, open->name, open->end);
+			}
+			if (i < numZones) {
+				cnProfile_WriteEvent(file, 'B', threadIndex, zones[i].name, zones[i].start);
+				openZones[numOpen++] = i;
+			}
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	const bool written = !ferror(file);
+	fclose(file);
+	free(zones);
+
+	if (numOverwritten != 0) {
+		CN_WARN(LogSysMain, "Overwrote the oldest %" PRIu64 " profile zones, "
+			"so the trace only covers the end of the run.", numOverwritten);
+	}
+	if (numDropped != 0) {
+		CN_WARN(LogSysMain, "Dropped %" PRIu64 " profile zones nested too deeply.", numDropped);
+	}
+	if (!written) {
+		CN_ERROR(LogSysMain, "Unable to write trace file: %s", path);
+	}
+	return written;
+}
+
+#endif /* CN_ENABLE_PROFILER */
+
+static bool cnProfile_Init(void)
+{
+#if CN_ENABLE_PROFILER
+	s_startTime = cnTime_MakeNow();
+
+	// Initialization happens on the main thread, so it gets the first buffer.
+	if (!cnProfile_ThreadBuffer()) {
+		CN_ERROR(LogSysMain, "Unable to allocate profile zone buffer.");
+		return false;
+	}
+#else
+	const CnProfileConfig* config = (CnProfileConfig*)cnProfile_Config();
+	if (config->tracePath.str[0] != '\0') {
+		CN_WARN(LogSysMain, "Profiler is not built in, so no trace will be written. "
+			"Configure with -DCN_ENABLE_PROFILER=1 to use it.");
+	}
+#endif
+	return true;
+}
+
+static void cnProfile_Shutdown(void)
+{
+#if CN_ENABLE_PROFILER
+	const CnProfileConfig* config = (CnProfileConfig*)cnProfile_Config();
+	if (config->tracePath.str[0] != '\0') {
+		if (cnProfile_WriteTrace(config->tracePath.str)) {
+			cnPrint("Trace written to: %s\n", config->tracePath.str);
+		}
+	}
+
+	const uint32_t numThreads = cnAtomic_LoadU32(&s_numThreads);
+	for (uint32_t i = 0; i < numThreads && i < CN_PROFILE_MAX_THREADS; ++i) {
+		free(s_threadBuffers[i]);
+		s_threadBuffers[i] = NULL;
+	}
+	cnAtomic_StoreU32(&s_numThreads, 0);
+	t_buffer = NULL;
+	t_registered = false;
+#endif
+}
+
+static const char* cnProfile_Name(void)
+{
+	return "Profile";
+}
+
+CnSystem cnProfile_System(void)
+{
+	return (CnSystem) {
+		.name             = cnProfile_Name,
+		.options          = cnProfile_CommandLineOptionList,
+		.config           = cnProfile_Config,
+		.setDefaultConfig = cnProfile_SetDefaultConfig,
+
+		.init             = cnProfile_Init,
+		.shutdown         = cnProfile_Shutdown,
+		.sharedLibrary    = NULL,
+
+		.behavior         = cnSystem_NoBehavior()
+	};
+}
@@ -0,0 +1,82 @@
+#ifndef CN_PROFILE_H
+#define CN_PROFILE_H
+
+/**
+ * @file profile.h
+ *
+ * Records when named zones of code start and end on each thread, and writes
+ * them as Chrome trace events, which can be viewed in Perfetto
+ * (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * Zones are only recorded when built with `CN_ENABLE_PROFILER`, otherwise the
+ * macros compile to nothing.  Run with `--profile FILE` to write the trace at
+ * shutdown.
+ *
+ * Each thread writes to its own buffer without locking, and buffers are only
+ * read when writing the trace, after other threads have stopped.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/system.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CN_ENABLE_PROFILER
+	#define CN_ENABLE_PROFILER 0
+#endif
+
+CN_TEST_API CnSystem cnProfile_System(void);
+
+/**
+ * Zones kept per thread.  Once full, the oldest zones which have ended are
+ * overwritten.
+ */
+#define CN_PROFILE_MAX_ZONES (64 * 1024)
+
+#if CN_ENABLE_PROFILER
+
+CN_API void cnProfile_Begin(const char* name);
+CN_API void cnProfile_End(void);
+CN_API bool cnProfile_WriteTrace(const char* path);
+
+/**
+ * Names must live until the trace is written, so should be string literals.
+ */
+#define CN_PROFILE_BEGIN(name) cnProfile_Begin(name)
+#define CN_PROFILE_END() cnProfile_End()
+
+#define CN_PROFILE_CONCAT_DETAIL(a, b) a##b
+#define CN_PROFILE_CONCAT(a, b) CN_PROFILE_CONCAT_DETAIL(a, b)
+
+/**
+ * Records a zone around the block which follows:
+ *
+ *     CN_PROFILE_SCOPE("update") {
+ *         ...
+ *     }
+ *
+ * The zone ends when the block finishes, so it must not be left with
+ * `return`, `break` or `goto`.  Functions with early returns should use
+ * `CN_PROFILE_BEGIN` and `CN_PROFILE_END` before each return instead.
+ */
+#define CN_PROFILE_SCOPE(name) \
+	for (int CN_PROFILE_CONCAT(cnProfileScope_, __LINE__) = (cnProfile_Begin(name), 0); \
+		CN_PROFILE_CONCAT(cnProfileScope_, __LINE__) == 0; \
+		cnProfile_End(), CN_PROFILE_CONCAT(cnProfileScope_, __LINE__) = 1)
+
+#else
+
+#define CN_PROFILE_BEGIN(name)
+#define CN_PROFILE_END()
+#define CN_PROFILE_SCOPE(name)
+
+#endif /* CN_ENABLE_PROFILER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_PROFILE_H */
@@ -21,19 +21,41 @@
 #include <calendon/log.h>
 #include <calendon/math4.h>
 #include <calendon/memory.h>
+#include <calendon/particles.h>
 #include <calendon/path.h>
+#include <calendon/profile.h>
 #include <calendon/render-ll.h>
 #include <calendon/render-resources.h>
+#include <calendon/tilemap.h>
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * How much OpenGL usage gets checked.  Checking for errors or the validity of
+ * objects requires a round trip to the driver, which stalls it, so those
+ * checks only happen after every call at the paranoid level.
+ */
+static CnRenderValidation validation = CN_RENDER_VALIDATION_DEFAULT;
+static bool debugOutputEnabled = false;
 
 /*
  * A macro to provide OpenGL error checking and reporting.
  */
-#if CN_DEBUG
-	#define CN_ASSERT_NO_GL_ERROR() cnRLL_CheckGLError(__FILE__, __LINE__)
-	void cnRLL_CheckGLError(const char* file, int line);
-#else
-	#define CN_ASSERT_NO_GL_ERROR()
-#endif
+#define CN_ASSERT_NO_GL_ERROR() do { \
+		if (validation == CnRenderValidationParanoid) { \
+			cnRLL_CheckGLError(__FILE__, __LINE__); \
+		} \
+	} while (0)
+bool cnRLL_CheckGLError(const char* file, int line);
+
+/*
+ * Asserts the validity of an OpenGL object, such as with `glIsTexture`.
+ */
+#define CN_ASSERT_GL_OBJECT(condition, message, ...) \
+	CN_ASSERT(validation != CnRenderValidationParanoid || (condition), message, ##__VA_ARGS__)
 
 const char* cnRLL_GLTypeToString(GLenum type);
 void cnRLL_PrintProgram(GLuint program);
@@ -64,11 +86,144 @@ static SDL_GLContext* gl;
  * Vertex `GL_ARRAY_BUFFER` containing vertex information for drawing debug shapes.
  */
 static GLuint debugDrawBuffer;
+
+/**
+ * Solid shapes are transformed into world space and recorded with their color
+ * and depth in every vertex, so all filled shapes get drawn together, as do
+ * all lines, regardless of their color or transform.
+ */
+typedef struct {
+	CnFloat2 position;
+	float depth;
+	CnRGBA8u color;
+} CnSolidVertex;
+
+#define RLL_MAX_SOLID_VERTICES 6144
+static CnSolidVertex solidTriangles[RLL_MAX_SOLID_VERTICES];
+static uint32_t usedSolidTriangles = 0;
+static CnSolidVertex solidLines[RLL_MAX_SOLID_VERTICES];
+static uint32_t usedSolidLines = 0;
+
+/**
+ * Draws are recorded and submitted together when the frame ends, or when the
+ * target, viewport, camera or scissor changes.  Every draw gets a depth from
+ * the order it was recorded in, with later draws closer.
+ *
+ * Opaque draws are submitted first, front to back with depth testing and
+ * writing, so pixels hidden behind other opaque draws are never shaded.
+ * Translucent draws follow, blended in the order they were recorded, which is
+ * back to front.  They are depth tested so opaque draws in front of them still
+ * hide them, but don't write depth.
+ */
+typedef enum {
+	CnDrawKindQuad,
+	CnDrawKindTilemapLayer,
+	CnDrawKindGlyphs,
+	CnDrawKindParticles
+} CnDrawKind;
+
+typedef struct {
+	CnDrawKind kind;
+	float depth;
+	union {
+		struct {
+			GLuint texture;
+			CnFloat2 position;
+			CnDimension2f size;
+		} quad;
+		struct {
+			CnTilemap* map;
+			uint32_t layer;
+			GLuint tileset;
+			CnFloat2 origin;
+			CnRowColu32 first;
+			CnRowColu32 last;
+		} tilemapLayer;
+		struct {
+			GLuint texture;
+			uint32_t first;
+			uint32_t count;
+		} glyphs;
+		struct {
+			const CnParticles* particles;
+			float pointSize;
+		} particles;
+	};
+} CnDrawCommand;
+
+#define RLL_MAX_DRAW_COMMANDS 4096
+static CnDrawCommand opaqueCommands[RLL_MAX_DRAW_COMMANDS];
+static uint32_t numOpaqueCommands = 0;
+static CnDrawCommand translucentCommands[RLL_MAX_DRAW_COMMANDS];
+static uint32_t numTranslucentCommands = 0;
+static CnDrawCommand* cnRLL_RecordOpaque(CnDrawKind kind);
+static CnDrawCommand* cnRLL_RecordTranslucent(CnDrawKind kind);
+static uint64_t cnRLL_PixelsCovered(float worldArea);
+static void cnRLL_FlushDraws(void);
+
+/**
+ * Depths are world space z values between the near and far planes of the
+ * orthographic projection.  Draw order restarts whenever the depth buffer is
+ * cleared.
+ */
+#define RLL_FAR_DEPTH (-99.0f)
+#define RLL_NEAR_DEPTH 99.0f
+#define RLL_MAX_DRAW_SEQUENCE 65535
+static uint32_t drawSequence = 0;
+static uint32_t windowDrawSequence = 0;
+
+/**
+ * Stats for the frame being drawn, and for frames waiting on the GPU to report
+ * how many samples were drawn and how long drawing took.
+ */
+#define RLL_STATS_FRAMES_IN_FLIGHT 3
+static CnRenderStats frameStats;
+static CnRenderStats pendingStats[RLL_STATS_FRAMES_IN_FLIGHT];
+static bool pendingStatsValid[RLL_STATS_FRAMES_IN_FLIGHT];
+static GLuint samplesPassedQueries[RLL_STATS_FRAMES_IN_FLIGHT];
+static GLuint timeElapsedQueries[RLL_STATS_FRAMES_IN_FLIGHT];
+static uint32_t statsFrame = 0;
+static CnRenderStats lastStats;
+
+/**
+ * When the last frame was handed off to be presented, before any wait for
+ * VSync.
+ */
+static CnTime lastPresentTime;
+
 static GLuint fullScreenQuadBuffer;
 static GLuint spriteBuffer;
 
+/**
+ * Streaming `GL_ARRAY_BUFFER` for particle positions and colors, which are
+ * uploaded as separate regions directly from the particle arrays.
+ */
+static GLuint particleBuffer;
+static CnVertexFormat particleFormat;
+
+/**
+ * Quads share a common `GL_ELEMENT_ARRAY_BUFFER` so only 4 unique vertices need
+ * to be generated and uploaded per quad, instead of 6 vertices for two
+ * independent triangles.
+ */
+#define RLL_MAX_QUADS_PER_DRAW 1024
+#define RLL_VERTICES_PER_QUAD 4
+#define RLL_INDICES_PER_QUAD 6
+CN_STATIC_ASSERT(RLL_MAX_QUADS_PER_DRAW * RLL_VERTICES_PER_QUAD <= UINT16_MAX,
+	"Quad indices must fit in GL_UNSIGNED_SHORT");
+static GLuint quadIndexBuffer;
+
+/**
+ * Scratch space for generating tilemap chunk vertices before uploading them to
+ * the chunk's static buffer.
+ */
+static CnTileVertex tilemapBakeVertices[CN_TILEMAP_MAX_CHUNK_VERTICES];
+CN_STATIC_ASSERT(CN_TILEMAP_CHUNK_SIZE * CN_TILEMAP_CHUNK_SIZE <= RLL_MAX_QUADS_PER_DRAW,
+	"Tilemap chunks must be drawable with the shared quad index buffer");
+
 CN_DECLARE_HANDLE_TYPE(CnSpriteId, cnRLL_, Sprite, 8);
 CN_DECLARE_HANDLE_TYPE(CnFontId, cnRLL_, Font, 8);
+CN_DECLARE_HANDLE_TYPE(CnCanvasId, cnRLL_, Canvas, 8);
 
 /**
  * Maps sprite IDs to their OpenGL textures.
@@ -78,6 +233,63 @@ static GLuint spriteTextures[MaxSpriteId];
 static GLuint fontTextures[MaxFontId];
 static CnFontPSF2 fonts[MaxFontId];
 
+/**
+ * A framebuffer object rendering into a texture.
+ */
+typedef struct {
+	GLuint framebuffer;
+	GLuint texture;
+	GLuint depthBuffer;
+	CnDimension2u32 size;
+} CnCanvas;
+static CnCanvas canvases[MaxCanvasId];
+
+/**
+ * The canvas being drawn to, or 0 if drawing to the window.  The window's
+ * viewport and camera are saved while drawing to a canvas.
+ */
+static CnCanvasId activeCanvas;
+static CnAABB2 windowViewport;
+static CnAABB2 windowCameraAABB2;
+static GLboolean windowScissorEnabled;
+
+/**
+ * Framebuffer drawn to in place of the window.  This is normally the window's
+ * own framebuffer (0), but an offscreen framebuffer is used when frames need
+ * to be retained, since the contents of the window's back buffer are undefined
+ * after being swapped, or when drawing at a scaled resolution.
+ */
+static GLuint windowFramebuffer;
+static GLuint windowColorBuffer;
+static GLuint windowDepthBuffer;
+static bool retainFrame;
+static bool scaleFrame;
+
+/**
+ * Draw order relies on depth testing, so an offscreen framebuffer is also used
+ * if the window didn't get a depth buffer.
+ */
+static bool windowLacksDepth;
+static void cnRLL_UpdateWindowFramebuffer(void);
+
+/**
+ * Presentation waits for vertical blank according to `vsync`.  A fence is
+ * placed after each frame, so the CPU can wait for the GPU to finish older
+ * frames before starting new ones.
+ */
+#define RLL_MAX_FRAME_FENCES 4
+static CnVSync vsync = CnVSyncOn;
+static uint32_t maxFramesInFlight = 2;
+static GLsync frameFences[RLL_MAX_FRAME_FENCES];
+static uint32_t presentedFrames = 0;
+
+/**
+ * Fraction of the window resolution in each dimension actually drawn when
+ * scaling, with the result stretched to fill the window as the frame ends.
+ * The backing canvas stays in window units regardless of the scale.
+ */
+static float renderScale = 1.0f;
+
 /**
  * The maximum length of shader information logs which can be read.
  */
@@ -95,6 +307,7 @@ enum {
 	CnVertexFormatP4 = 0,
 	CnVertexFormatP2 = 1,
 	CnVertexFormatP2T2Interleaved = 2,
+	CnVertexFormatP3C4Interleaved = 3,
 	CnVertexFormatMax
 };
 static CnVertexFormat vertexFormats[CnVertexFormatMax];
@@ -106,20 +319,28 @@ enum {
 	CnProgramIndexSprite = 0,
 	CnProgramIndexFullScreen,
 	CnProgramIndexSolidPolygon,
+	CnProgramIndexParticle,
 	CnProgramIndexMax
 };
 static CnProgram programs[CnProgramIndexMax];
 
 /**
- * The total number of glyphs which can be drawn at once.
+ * The total number of glyphs which can be recorded before draws must be
+ * submitted.  Each text draw is split into draw calls of at most
+ * `RLL_MAX_QUADS_PER_DRAW` glyphs.
  */
-#define RLL_MAX_GLYPHS_PER_DRAW 180
-#define RLL_VERTICES_PER_GLYPH 6
-#define RLL_MAX_GLYPH_VERTICES_PER_DRAW (RLL_VERTICES_PER_GLYPH * RLL_MAX_GLYPHS_PER_DRAW)
-#define RLL_GLYPH_BUFFER_SIZE (2 * 2 * sizeof(float) * RLL_MAX_GLYPH_VERTICES_PER_DRAW)
-static CnFloat2 glyphVertices[RLL_MAX_GLYPH_VERTICES_PER_DRAW];
-static CnFloat2 glyphTexCoords[RLL_MAX_GLYPH_VERTICES_PER_DRAW];
+#define RLL_MAX_GLYPHS 4096
+#define RLL_VERTICES_PER_GLYPH RLL_VERTICES_PER_QUAD
+#define RLL_MAX_GLYPH_VERTICES (RLL_VERTICES_PER_GLYPH * RLL_MAX_GLYPHS)
+#define RLL_GLYPH_BUFFER_SIZE (2 * 2 * sizeof(float) * RLL_MAX_GLYPH_VERTICES)
+static CnFloat2 glyphVertices[RLL_MAX_GLYPH_VERTICES];
+static CnFloat2 glyphTexCoords[RLL_MAX_GLYPH_VERTICES];
 static uint32_t usedGlyphs = 0;
+
+/**
+ * Glyphs are added to the last text draw if nothing else has been drawn since.
+ */
+static uint32_t glyphsDrawSequence = 0;
 static CnVertexFormat glyphFormat;
 static GLuint glyphBuffer;
 
@@ -152,7 +373,10 @@ enum {
 	CnAttributeSemanticNamePosition3 = 0,
 	CnAttributeSemanticNamePosition4 = 0,
 	CnAttributeSemanticNameTexCoord2 = 1,
-	CnAttributeSemanticNameTypes = 5,
+	CnAttributeSemanticNamePositionX = 2,
+	CnAttributeSemanticNamePositionY = 3,
+	CnAttributeSemanticNameColor4 = 4,
+	CnAttributeSemanticNameTypes = 8,
 	CnAttributeSemanticNameUnknown
 };
 
@@ -165,7 +389,10 @@ static CnSemanticMapping attributeSemanticNames[] = {
 	{ "Position2", CnAttributeSemanticNamePosition2, GL_FLOAT, 2 },
 	{ "Position3", CnAttributeSemanticNamePosition3, GL_FLOAT, 3 },
 	{ "Position4", CnAttributeSemanticNamePosition4, GL_FLOAT, 4 },
-	{ "TexCoord2", CnAttributeSemanticNameTexCoord2, GL_FLOAT, 2 }
+	{ "TexCoord2", CnAttributeSemanticNameTexCoord2, GL_FLOAT, 2 },
+	{ "PositionX", CnAttributeSemanticNamePositionX, GL_FLOAT, 1 },
+	{ "PositionY", CnAttributeSemanticNamePositionY, GL_FLOAT, 1 },
+	{ "Color4",    CnAttributeSemanticNameColor4,    GL_UNSIGNED_BYTE, 4 }
 };
 
 CN_STATIC_ASSERT(CnAttributeSemanticNameTypes == CN_ARRAY_SIZE(attributeSemanticNames),
@@ -177,8 +404,9 @@ enum {
 	CnUniformNameViewModel = 1,
 	CnUniformNameTexture = 2,
 	CnUniformNameTexture2D0 = 2,
-	CnUniformNamePolygonColor = 3,
-	CnUniformNameTypes = 6,
+	CnUniformNamePointSize = 3,
+	CnUniformNameDepth = 4,
+	CnUniformNameTypes = 7,
 	CnUniformNameUnknown
 };
 
@@ -190,7 +418,8 @@ static CnSemanticMapping UniformNames[] = {
 	{ "ViewModel",    CnUniformNameViewModel,    GL_FLOAT_MAT4, 1 },
 	{ "Texture",      CnUniformNameTexture,      GL_SAMPLER_2D, 1 },
 	{ "Texture2D0",   CnUniformNameTexture2D0,   GL_SAMPLER_2D, 1 },
-	{ "PolygonColor", CnUniformNamePolygonColor, GL_FLOAT_VEC4, 1 }
+	{ "PointSize",    CnUniformNamePointSize,    GL_FLOAT,      1 },
+	{ "Depth",        CnUniformNameDepth,        GL_FLOAT,      1 }
 };
 
 CN_STATIC_ASSERT(CnUniformNameTypes == CN_ARRAY_SIZE(UniformNames),
@@ -201,6 +430,7 @@ CN_STATIC_ASSERT(CnUniformNameTypes == CN_ARRAY_SIZE(UniformNames),
  */
 typedef union {
 	int i;
+	float f;
 	CnFloat2 f2;
 	CnFloat4 f4;
 	CnFloat4x4 f44;
@@ -256,6 +486,10 @@ void cnRLL_ApplyUniform(CnUniform* u, CnUniformStorage storage)
 	CN_ASSERT_NO_GL_ERROR();
 
 	switch(u->type) {
+		case GL_FLOAT:
+			CN_ASSERT(u->size == 1, "Arrays of float are not supported");
+			glUniform1f(u->location, storage[u->storageLocation].f);
+			break;
 		case GL_FLOAT_VEC2:
 			CN_ASSERT(u->size == 1, "Arrays of CnFloat2 are not supported");
 			glUniform2fv(u->location, 1, storage[u->storageLocation].f2.v);
@@ -373,7 +607,7 @@ static void cnRLL_ApplyVertexAttribute(CnVertexFormat* f, uint32_t semanticName,
 static void cnRLL_EnableProgramForVertexFormat(uint32_t id, CnVertexFormat* format)
 {
 	CnProgram* p = &programs[id];
-	CN_ASSERT(glIsProgram(p->id), "%" PRIu32 " is not a valid program.", id);
+	CN_ASSERT_GL_OBJECT(glIsProgram(p->id), "%" PRIu32 " is not a valid program.", id);
 	CN_ASSERT(format != NULL, "Cannot enable program %" PRIu32 " for a null vertex format.", id);
 
 	glUseProgram(p->id);
@@ -399,19 +633,37 @@ void cnRLL_DisableProgram(uint32_t id)
 	}
 }
 
+/**
+ * Draws quads from the currently bound vertex buffer using the shared quad
+ * index buffer.  Every 4 consecutive vertices form a quad, ordered like a
+ * triangle strip.
+ */
+static void cnRLL_DrawQuads(uint32_t numQuads)
+{
+	CN_ASSERT(numQuads <= RLL_MAX_QUADS_PER_DRAW, "Too many quads in a single draw: %"
+		PRIu32 " (%d max)", numQuads, RLL_MAX_QUADS_PER_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+	glDrawElements(GL_TRIANGLES, (GLsizei)(numQuads * RLL_INDICES_PER_QUAD),
+		GL_UNSIGNED_SHORT, NULL);
+}
+
 bool cnRLL_CreateProgram(GLuint vertexShader, GLuint fragmentShader, GLuint* program,
 	uint32_t programIndex);
 void cnRLL_FillBuffers(void);
 void cnRLL_InitSprites(void);
 void cnRLL_LoadShaders(void);
 
-void cnRLL_CheckGLError(const char* file, int line)
+/**
+ * Reports the next pending OpenGL error, if there is one.
+ */
+bool cnRLL_CheckGLError(const char* file, int line)
 {
 	const GLenum glError = glGetError();
 	switch (glError)
 	{
 		case GL_NO_ERROR:
-			return;
+			return false;
 #define label_print(label) case label: CN_ERROR(LogSysRender, "OpenGL Error: %s:%d " #label, file, line); break;
 		label_print(GL_INVALID_ENUM)
 		label_print(GL_INVALID_VALUE)
@@ -425,6 +677,87 @@ void cnRLL_CheckGLError(const char* file, int line)
 			CN_ERROR(LogSysRender, "Unknown error: %s:%d %d", file, line, glError);
 	}
 	CN_DEBUG_BREAK();
+	return true;
+}
+
+/**
+ * Reports errors from anywhere in the last frame.  OpenGL only keeps one of
+ * each kind of error, so there are only a few to check.
+ */
+static void cnRLL_CheckFrameGLErrors(void)
+{
+	const uint32_t maxErrors = 8;
+	uint32_t numErrors = 0;
+	while (numErrors < maxErrors && cnRLL_CheckGLError(__FILE__, __LINE__)) {
+		++numErrors;
+	}
+
+	if (numErrors > 0) {
+		CN_ERROR(LogSysRender, "OpenGL errors occurred during the frame, use paranoid"
+			" validation to find where.");
+	}
+}
+
+static void APIENTRY cnRLL_DebugMessage(GLenum source, GLenum type, GLuint id,
+	GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+{
+	CN_UNUSED(source);
+	CN_UNUSED(type);
+	CN_UNUSED(length);
+	CN_UNUSED(userParam);
+
+	switch (severity) {
+		case GL_DEBUG_SEVERITY_HIGH:
+			CN_ERROR(LogSysRender, "OpenGL: %u %s", id, message);
+			break;
+		case GL_DEBUG_SEVERITY_MEDIUM:
+			CN_WARN(LogSysRender, "OpenGL: %u %s", id, message);
+			break;
+		default:
+			CN_TRACE(LogSysRender, "OpenGL: %u %s", id, message);
+			break;
+	}
+}
+
+/**
+ * Switches debug output on or off for the current validation level.  Debug
+ * output isn't synchronous, so it doesn't stall the driver, but messages don't
+ * indicate which call caused them.
+ */
+static void cnRLL_ApplyValidation(void)
+{
+	if (validation == CnRenderValidationCallback
+		&& !SDL_GL_ExtensionSupported("GL_KHR_debug"))
+	{
+		CN_WARN(LogSysRender, "GL_KHR_debug is unavailable, checking for errors every"
+			" frame instead.");
+		validation = CnRenderValidationFrame;
+	}
+
+	if (validation == CnRenderValidationCallback) {
+		glDebugMessageCallback(cnRLL_DebugMessage, NULL);
+		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION,
+			0, NULL, GL_FALSE);
+		glEnable(GL_DEBUG_OUTPUT);
+		debugOutputEnabled = true;
+	}
+	else if (debugOutputEnabled) {
+		glDisable(GL_DEBUG_OUTPUT);
+		debugOutputEnabled = false;
+	}
+}
+
+/**
+ * Changes how OpenGL usage is checked.  Drivers only provide full debug output
+ * to contexts created for debugging, so the callback level should be set
+ * before initialization.
+ */
+void cnRLL_SetValidation(CnRenderValidation level)
+{
+	validation = level;
+	if (gl != NULL) {
+		cnRLL_ApplyValidation();
+	}
 }
 
 /**
@@ -591,6 +924,9 @@ void cnRLL_InitGL(void)
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+	if (validation == CnRenderValidationCallback) {
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+	}
 	gl = SDL_GL_CreateContext(window);
 	if (gl == NULL) {
 		CN_FATAL_ERROR("Unable to create OpenGL context: %s", SDL_GetError());
@@ -601,21 +937,93 @@ void cnRLL_InitGL(void)
 	glewInit();
 #endif
 
+	int depthBits = 0;
+	SDL_GL_GetAttribute(SDL_GL_DEPTH_SIZE, &depthBits);
+	windowLacksDepth = depthBits == 0;
+	if (windowLacksDepth) {
+		CN_WARN(LogSysRender, "Window has no depth buffer, drawing offscreen instead");
+	}
+
+	cnRLL_ApplyValidation();
+
 	CN_TRACE(LogSysRender, "OpenGL renderer initialized");
 	cnRLL_PrintGLVersion();
 }
 
-void cnRLL_ConfigureVSync(void)
+static void cnRLL_ApplyVSync(void)
 {
-	// VSync causes the draw to stall until the frame is displayed.
-	// This might be more useful if/when drawing gets moved to it's own thread.
-	const bool useVSync = true;
-	if (useVSync) {
-		SDL_GL_SetSwapInterval(1);
+	if (SDL_GL_SetSwapInterval((int)vsync) == 0) {
+		return;
+	}
+
+	// Adaptive VSync isn't supported everywhere.
+	if (vsync == CnVSyncAdaptive) {
+		CN_WARN(LogSysRender, "Adaptive VSync is unsupported, using VSync instead: %s",
+			SDL_GetError());
+		vsync = CnVSyncOn;
+		SDL_GL_SetSwapInterval((int)vsync);
 	}
 	else {
-		SDL_GL_SetSwapInterval(0);
+		CN_WARN(LogSysRender, "Unable to set swap interval %d: %s", (int)vsync,
+			SDL_GetError());
+	}
+}
+
+/**
+ * Changes whether presenting frames waits for the display's vertical blank.
+ * Adaptive VSync only waits for frames which are on time, so late frames tear
+ * instead of waiting a whole extra refresh.
+ */
+void cnRLL_SetVSync(CnVSync mode)
+{
+	vsync = mode;
+	if (gl != NULL) {
+		cnRLL_ApplyVSync();
+	}
+}
+
+/**
+ * Limits how many frames the CPU can submit before the GPU finishes drawing
+ * them.  Drivers queue up several frames, and input used to draw a frame waits
+ * for all frames queued in front of it.  Zero allows as many frames as the
+ * driver queues.
+ */
+void cnRLL_SetMaxFramesInFlight(uint32_t maxFrames)
+{
+	CN_ASSERT(maxFrames <= RLL_MAX_FRAME_FENCES, "Too many frames in flight: %" PRIu32
+		" (%d max)", maxFrames, RLL_MAX_FRAME_FENCES);
+	maxFramesInFlight = maxFrames;
+}
+
+/**
+ * Blocks until the GPU has finished enough submitted frames that another one
+ * can be started within the frames in flight limit.
+ */
+void cnRLL_WaitForFramesInFlight(void)
+{
+	CN_PROFILE_BEGIN(__func__);
+	if (maxFramesInFlight == 0 || presentedFrames < maxFramesInFlight) {
+		CN_PROFILE_END();
+		return;
 	}
+
+	const uint32_t slot = (presentedFrames - maxFramesInFlight) % RLL_MAX_FRAME_FENCES;
+	GLsync fence = frameFences[slot];
+	if (fence == NULL) {
+		CN_PROFILE_END();
+		return;
+	}
+
+	// Don't hang forever if the GPU does.
+	const GLuint64 timeoutNs = 100 * 1000 * 1000;
+	const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+	if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+		CN_WARN(LogSysRender, "Gave up waiting on frame %" PRIu32 " to finish drawing.",
+			presentedFrames - maxFramesInFlight);
+	}
+	glDeleteSync(fence);
+	frameFences[slot] = NULL;
+	CN_PROFILE_END();
 }
 
 /**
@@ -680,6 +1088,53 @@ void cnRLL_InitVertexFormats(void)
 		t2->offset = 2 * sizeof(float);
 	}
 
+	{
+		CnVertexFormat* v = &vertexFormats[CnVertexFormatP3C4Interleaved];
+		CnVertexFormatAttribute* p3 = &v->attributes[CnAttributeSemanticNamePosition3];
+		p3->semanticName = CnAttributeSemanticNamePosition3;
+		p3->componentType = GL_FLOAT;
+		p3->numComponents = 3;
+		p3->normalized = GL_FALSE;
+		p3->stride = sizeof(CnSolidVertex);
+		p3->offset = offsetof(CnSolidVertex, position);
+
+		CnVertexFormatAttribute* c4 = &v->attributes[CnAttributeSemanticNameColor4];
+		c4->semanticName = CnAttributeSemanticNameColor4;
+		c4->componentType = GL_UNSIGNED_BYTE;
+		c4->numComponents = 4;
+		c4->normalized = GL_TRUE;
+		c4->stride = sizeof(CnSolidVertex);
+		c4->offset = offsetof(CnSolidVertex, color);
+	}
+
+	// Offsets are assigned for each draw, based on the number of particles.
+	{
+		CnVertexFormat* v = &particleFormat;
+		CnVertexFormatAttribute* x = &v->attributes[CnAttributeSemanticNamePositionX];
+		x->semanticName = CnAttributeSemanticNamePositionX;
+		x->componentType = GL_FLOAT;
+		x->numComponents = 1;
+		x->normalized = GL_FALSE;
+		x->stride = 0;
+		x->offset = 0;
+
+		CnVertexFormatAttribute* y = &v->attributes[CnAttributeSemanticNamePositionY];
+		y->semanticName = CnAttributeSemanticNamePositionY;
+		y->componentType = GL_FLOAT;
+		y->numComponents = 1;
+		y->normalized = GL_FALSE;
+		y->stride = 0;
+		y->offset = 0;
+
+		CnVertexFormatAttribute* c4 = &v->attributes[CnAttributeSemanticNameColor4];
+		c4->semanticName = CnAttributeSemanticNameColor4;
+		c4->componentType = GL_UNSIGNED_BYTE;
+		c4->numComponents = 4;
+		c4->normalized = GL_TRUE;
+		c4->stride = 0;
+		c4->offset = 0;
+	}
+
 	{
 		CnVertexFormat*v = &glyphFormat;
 		CnVertexFormatAttribute* p2 = &v->attributes[CnAttributeSemanticNamePosition2];
@@ -696,7 +1151,7 @@ void cnRLL_InitVertexFormats(void)
 		t2->numComponents = 2;
 		t2->normalized = GL_FALSE;
 		t2->stride = 0;
-		t2->offset = sizeof(float) * 2 * RLL_MAX_GLYPHS_PER_DRAW * RLL_VERTICES_PER_GLYPH;
+		t2->offset = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES;
 	}
 }
 
@@ -724,7 +1179,7 @@ void cnRLL_FillSpriteBuffer(void)
 		CnFloat2 texCoord2;
 	} CnVertexP2T2;
 
-	CnVertexP2T2 vertices[8];
+	CnVertexP2T2 vertices[RLL_VERTICES_PER_QUAD];
 	vertices[0] = (CnVertexP2T2) {
 		cnFloat2_Make(0.0f, 0.0f),
 		cnFloat2_Make(0.0f, 0.0f)
@@ -753,19 +1208,51 @@ void cnRLL_FillSpriteBuffer(void)
 
 void cnRLL_FillDebugQuadBuffer(void)
 {
-	// Doesn't matter, will be overwritten.
-	CnFloat4 vertices[RLL_MAX_DEBUG_POINTS];
-	memset(&vertices[0], 0, RLL_MAX_DEBUG_POINTS * sizeof(CnFloat4));
 	glGenBuffers(1, &debugDrawBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
 
-	// Allocate the maximum used spaced and then override it.
-	glBufferData(GL_ARRAY_BUFFER, RLL_MAX_DEBUG_POINTS * 4 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
+	// Contents are replaced every time solid shapes are drawn.
+	glBufferData(GL_ARRAY_BUFFER, sizeof(solidTriangles), NULL, GL_STREAM_DRAW);
 
 	CN_ASSERT(debugDrawBuffer, "Cannot allocate a buffer for the debug drawing");
 	CN_ASSERT_NO_GL_ERROR();
 }
 
+/**
+ * Fills the shared index buffer used to draw quads.  Each quad is 4 vertices
+ * given in the same order as a 4 vertex triangle strip, so the first and last
+ * vertex of every quad are opposite corners.
+ */
+void cnRLL_FillQuadIndexBuffer(void)
+{
+	static GLushort indices[RLL_MAX_QUADS_PER_DRAW * RLL_INDICES_PER_QUAD];
+	for (uint32_t quad = 0; quad < RLL_MAX_QUADS_PER_DRAW; ++quad) {
+		const GLushort first = (GLushort)(quad * RLL_VERTICES_PER_QUAD);
+		GLushort* quadIndices = &indices[quad * RLL_INDICES_PER_QUAD];
+		quadIndices[0] = first;
+		quadIndices[1] = (GLushort)(first + 1);
+		quadIndices[2] = (GLushort)(first + 2);
+		quadIndices[3] = (GLushort)(first + 2);
+		quadIndices[4] = (GLushort)(first + 1);
+		quadIndices[5] = (GLushort)(first + 3);
+	}
+
+	glGenBuffers(1, &quadIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	CN_ASSERT(quadIndexBuffer, "Cannot allocate a buffer for quad indices");
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+void cnRLL_FillParticleBuffer(void)
+{
+	// Storage is allocated when drawing, since particle counts vary.
+	glGenBuffers(1, &particleBuffer);
+	CN_ASSERT(particleBuffer, "Cannot allocate a buffer for particles");
+	CN_ASSERT_NO_GL_ERROR();
+}
+
 void cnRLL_FillGlyphBuffer(void)
 {
 	CN_ASSERT_NO_GL_ERROR();
@@ -780,6 +1267,8 @@ void cnRLL_FillBuffers(void)
 	cnRLL_FillSpriteBuffer();
 	cnRLL_FillFullScreenQuadBuffer();
 	cnRLL_FillDebugQuadBuffer();
+	cnRLL_FillQuadIndexBuffer();
+	cnRLL_FillParticleBuffer();
 	cnRLL_FillGlyphBuffer();
 }
 
@@ -787,6 +1276,8 @@ void cnRLL_InitSprites(void)
 {
 	cnRLL_SpriteInit();
 	cnRLL_FontInit();
+	cnRLL_CanvasInit();
+	activeCanvas = 0;
 }
 
 void cnRLL_LoadSimpleShader(const char* vertexShaderFileName,
@@ -859,6 +1350,8 @@ void cnRLL_LoadShaders(void)
 		"shaders/solid_polygon.frag", CnProgramIndexSolidPolygon);
 	cnRLL_LoadSimpleShader("shaders/atlas_sprite.vert",
 		"shaders/atlas_sprite.frag", CnProgramIndexSprite);
+	cnRLL_LoadSimpleShader("shaders/particle.vert",
+		"shaders/solid_polygon.frag", CnProgramIndexParticle);
 }
 
 bool cnRLL_CreateProgram(GLuint vertexShader, GLuint fragmentShader, GLuint* program,
@@ -923,9 +1416,15 @@ bool cnRLL_CreateProgram(GLuint vertexShader, GLuint fragmentShader, GLuint* pro
 
 void cnRLL_Init(CnDimension2u32 resolution)
 {
+	CN_PROFILE_BEGIN(__func__);
 	cnRLL_InitGL();
-	cnRLL_ConfigureVSync();
+	cnRLL_ApplyVSync();
 	cnRLL_InitDummyVAO();
+	glEnable(GL_PROGRAM_POINT_SIZE);
+	glDepthFunc(GL_LESS);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glGenQueries(RLL_STATS_FRAMES_IN_FLIGHT, samplesPassedQueries);
+	glGenQueries(RLL_STATS_FRAMES_IN_FLIGHT, timeElapsedQueries);
 	cnRLL_InitVertexFormats();
 	cnRLL_FillBuffers();
 	cnRLL_InitSprites();
@@ -934,23 +1433,274 @@ void cnRLL_Init(CnDimension2u32 resolution)
 	windowWidth = (GLsizei)resolution.width;
 	windowHeight = (GLsizei)resolution.height;
 
+	cnRLL_UpdateWindowFramebuffer();
 	cnRLL_SetCameraAABB2(cnRLL_BackingCanvasArea());
+	CN_PROFILE_END();
 }
 
 void cnRLL_Shutdown(void)
 {
 }
 
+/**
+ * Converts a length in window units to pixels of the framebuffer being drawn.
+ */
+static GLint cnRLL_ToDrawnPixels(float length)
+{
+	const float scale = activeCanvas == 0 ? renderScale : 1.0f;
+	return (GLint)(length * scale + 0.5f);
+}
+
+/**
+ * Publishes the stats of earlier frames whose query results are available,
+ * oldest first.  The oldest frame's query is about to be reused, so its result
+ * is waited for if the GPU is that far behind.
+ */
+static void cnRLL_CollectStats(void)
+{
+	for (uint32_t i = 0; i < RLL_STATS_FRAMES_IN_FLIGHT; ++i) {
+		const uint32_t slot = (statsFrame + i) % RLL_STATS_FRAMES_IN_FLIGHT;
+		if (!pendingStatsValid[slot]) {
+			continue;
+		}
+
+		// The time query ends last, so its result is the last to be ready.
+		if (i != 0) {
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(timeElapsedQueries[slot], GL_QUERY_RESULT_AVAILABLE,
+				&available);
+			if (!available) {
+				return;
+			}
+		}
+
+		GLuint64 samplesPassed = 0;
+		GLuint64 gpuNs = 0;
+		glGetQueryObjectui64v(samplesPassedQueries[slot], GL_QUERY_RESULT, &samplesPassed);
+		glGetQueryObjectui64v(timeElapsedQueries[slot], GL_QUERY_RESULT, &gpuNs);
+		lastStats = pendingStats[slot];
+		lastStats.samplesPassed = samplesPassed;
+		lastStats.gpuNs = gpuNs;
+		pendingStatsValid[slot] = false;
+	}
+}
+
 void cnRLL_StartFrame(void)
 {
+	CN_PROFILE_BEGIN(__func__);
 	SDL_GL_MakeCurrent(window, gl);
+	glBindFramebuffer(GL_FRAMEBUFFER, windowFramebuffer);
+
+	cnRLL_CollectStats();
+	frameStats = (CnRenderStats) { 0 };
+	frameStats.pixelsInFrame = (uint64_t)cnRLL_ToDrawnPixels((float)windowWidth)
+		* (uint64_t)cnRLL_ToDrawnPixels((float)windowHeight);
+	glBeginQuery(GL_SAMPLES_PASSED,
+		samplesPassedQueries[statsFrame % RLL_STATS_FRAMES_IN_FLIGHT]);
+	glBeginQuery(GL_TIME_ELAPSED,
+		timeElapsedQueries[statsFrame % RLL_STATS_FRAMES_IN_FLIGHT]);
+
+	glClear(GL_DEPTH_BUFFER_BIT);
+	drawSequence = 0;
 	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
 }
 
 void cnRLL_EndFrame(void)
 {
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
+	CN_ASSERT(activeCanvas == 0, "Canvas %" PRIu32 " was never ended.", activeCanvas);
 	CN_ASSERT_NO_GL_ERROR();
+
+	if (validation == CnRenderValidationFrame) {
+		cnRLL_CheckFrameGLErrors();
+	}
+
+	const uint32_t slot = statsFrame % RLL_STATS_FRAMES_IN_FLIGHT;
+	glEndQuery(GL_SAMPLES_PASSED);
+	pendingStats[slot] = frameStats;
+	pendingStatsValid[slot] = true;
+
+	if (windowFramebuffer != 0) {
+		const GLint drawnWidth = cnRLL_ToDrawnPixels((float)windowWidth);
+		const GLint drawnHeight = cnRLL_ToDrawnPixels((float)windowHeight);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, windowFramebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, drawnWidth, drawnHeight, 0, 0, windowWidth, windowHeight,
+			GL_COLOR_BUFFER_BIT, renderScale < 1.0f ? GL_LINEAR : GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, windowFramebuffer);
+		CN_ASSERT_NO_GL_ERROR();
+	}
+
+	// Upscaling is part of the frame's cost, so it's timed too.
+	glEndQuery(GL_TIME_ELAPSED);
+	++statsFrame;
+
+	lastPresentTime = cnTime_MakeNow();
 	SDL_GL_SwapWindow(window);
+
+	// Marks when the GPU is done with this frame, to limit frames in flight.
+	const uint32_t fenceSlot = presentedFrames % RLL_MAX_FRAME_FENCES;
+	if (frameFences[fenceSlot] != NULL) {
+		glDeleteSync(frameFences[fenceSlot]);
+	}
+	frameFences[fenceSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	++presentedFrames;
+	CN_PROFILE_END();
+}
+
+/**
+ * Creates the offscreen framebuffer if something needs it, or goes back to
+ * drawing directly to the window if nothing does.
+ */
+static void cnRLL_UpdateWindowFramebuffer(void)
+{
+	cnRLL_FlushDraws();
+
+	CN_ASSERT(activeCanvas == 0, "Cannot change window framebuffer while drawing to a canvas.");
+	CN_ASSERT_NO_GL_ERROR();
+
+	if (!retainFrame && !scaleFrame && !windowLacksDepth) {
+		if (windowFramebuffer != 0) {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteFramebuffers(1, &windowFramebuffer);
+			glDeleteRenderbuffers(1, &windowColorBuffer);
+			glDeleteRenderbuffers(1, &windowDepthBuffer);
+			windowFramebuffer = 0;
+			windowColorBuffer = 0;
+			windowDepthBuffer = 0;
+		}
+		return;
+	}
+
+	if (windowFramebuffer != 0) {
+		return;
+	}
+
+	// Always full window size, so changing the scale only changes how much of
+	// it gets used.
+	glGenRenderbuffers(1, &windowColorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, windowColorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, windowWidth, windowHeight);
+
+	glGenRenderbuffers(1, &windowDepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, windowDepthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, windowWidth, windowHeight);
+
+	glGenFramebuffers(1, &windowFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, windowFramebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+		windowColorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+		windowDepthBuffer);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		CN_ERROR(LogSysRender, "Window framebuffer is incomplete: 0x%x", status);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &windowFramebuffer);
+		glDeleteRenderbuffers(1, &windowColorBuffer);
+		glDeleteRenderbuffers(1, &windowDepthBuffer);
+		windowFramebuffer = 0;
+		windowColorBuffer = 0;
+		windowDepthBuffer = 0;
+		renderScale = 1.0f;
+	}
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+/**
+ * Draws frames into an offscreen framebuffer which is copied to the window
+ * when the frame ends, so previous frame contents are available to be
+ * partially redrawn.
+ */
+void cnRLL_SetRetainedFrame(bool retained)
+{
+	CN_PROFILE_BEGIN(__func__);
+	retainFrame = retained;
+	cnRLL_UpdateWindowFramebuffer();
+	CN_PROFILE_END();
+}
+
+/**
+ * Allows drawing frames at less than the window's resolution with
+ * `cnRLL_SetRenderScale`.
+ */
+void cnRLL_SetRenderScaling(bool enabled)
+{
+	CN_PROFILE_BEGIN(__func__);
+	scaleFrame = enabled;
+	renderScale = 1.0f;
+	cnRLL_UpdateWindowFramebuffer();
+	CN_PROFILE_END();
+}
+
+/**
+ * Changes the fraction of the window's resolution used for following frames.
+ * Should only be changed between frames.
+ */
+void cnRLL_SetRenderScale(float scale)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT(scaleFrame, "Render scaling is not enabled.");
+	CN_ASSERT(scale > 0.0f && scale <= 1.0f, "Render scale is out of range: %f", scale);
+	if (windowFramebuffer != 0) {
+		renderScale = scale;
+	}
+	CN_PROFILE_END();
+}
+
+float cnRLL_RenderScale(void)
+{
+	return renderScale;
+}
+
+/**
+ * Restricts drawing, including clears, to an area of the backing canvas.
+ */
+void cnRLL_SetScissor(CnAABB2 area)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
+	const CnAABB2 backing = cnRLL_BackingCanvasArea();
+	const GLint left = cnRLL_ToDrawnPixels(floorf(fmaxf(area.min.x, backing.min.x)));
+	const GLint bottom = cnRLL_ToDrawnPixels(floorf(fmaxf(area.min.y, backing.min.y)));
+	const GLint right = cnRLL_ToDrawnPixels(ceilf(fminf(area.max.x, backing.max.x)));
+	const GLint top = cnRLL_ToDrawnPixels(ceilf(fminf(area.max.y, backing.max.y)));
+
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(left, bottom, right > left ? right - left : 0, top > bottom ? top - bottom : 0);
+	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
+}
+
+void cnRLL_DisableScissor(void)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
+	glDisable(GL_SCISSOR_TEST);
+	CN_PROFILE_END();
+}
+
+/**
+ * Stats of the most recent frame whose GPU results are available, which is
+ * usually a frame or two behind the frame being drawn.
+ */
+CnRenderStats cnRLL_Stats(void)
+{
+	return lastStats;
+}
+
+/**
+ * When the last frame was handed off to be presented, before waiting for VSync.
+ */
+CnTime cnRLL_LastPresentTime(void)
+{
+	return lastPresentTime;
 }
 
 CnDimension2u32 cnRLL_Resolution(void)
@@ -958,8 +1708,16 @@ CnDimension2u32 cnRLL_Resolution(void)
 	return (CnDimension2u32) { .width = windowWidth, .height = windowHeight };
 }
 
+/**
+ * The area being drawn to, either the window or the active canvas.
+ */
 CnAABB2 cnRLL_BackingCanvasArea(void)
 {
+	if (activeCanvas != 0) {
+		const CnDimension2u32 size = canvases[activeCanvas].size;
+		return cnAABB2_MakeMinMax(cnFloat2_Make(0.0f, 0.0f),
+			cnFloat2_Make((float)size.width, (float)size.height));
+	}
 	return cnAABB2_MakeMinMax(cnFloat2_Make(0.0f, 0.0f), cnFloat2_Make((float)windowWidth, (float)windowHeight));
 }
 
@@ -970,19 +1728,29 @@ CnAABB2 cnRLL_Viewport(void)
 
 void cnRLL_SetViewport(CnAABB2 v)
 {
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
 	CN_ASSERT(cnAABB2_FullyContainsAABB2(cnRLL_BackingCanvasArea(), v, 0.0f),
 		"Attempting to draw a viewport not contained on the backing canvas.");
 	viewport = v;
 
-	glViewport((GLint)v.min.x, (GLint)v.min.y,
-		(GLsizei)cnAABB2_Width(v), (GLsizei)cnAABB2_Height(v));
+	const GLint left = cnRLL_ToDrawnPixels(v.min.x);
+	const GLint bottom = cnRLL_ToDrawnPixels(v.min.y);
+	glViewport(left, bottom, cnRLL_ToDrawnPixels(v.max.x) - left,
+		cnRLL_ToDrawnPixels(v.max.y) - bottom);
+	CN_PROFILE_END();
 }
 
 void cnRLL_SetCameraAABB2(const CnAABB2 mapSlice)
 {
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
 	cameraAABB2 = mapSlice;
 	uniformStorage[CnUniformNameProjection].f44
 		= cnRLL_OrthoProjection(mapSlice);
+	CN_PROFILE_END();
 }
 
 CnAABB2 cnRLL_CameraAABB2(void)
@@ -991,15 +1759,26 @@ CnAABB2 cnRLL_CameraAABB2(void)
 }
 
 
+/**
+ * Clears the target to a color, and starts the draw order over.
+ */
 void cnRLL_Clear(CnRGBA8u color)
 {
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
 	glClearColor(color.red, color.green, color.blue, color.alpha);
-	glClear(GL_COLOR_BUFFER_BIT);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	drawSequence = 0;
+	CN_PROFILE_END();
 }
 
 void cnRLL_SetFullScreenViewport(void)
 {
-	glViewport(0, 0, windowWidth, windowHeight);
+	cnRLL_FlushDraws();
+
+	glViewport(0, 0, cnRLL_ToDrawnPixels((float)windowWidth),
+		cnRLL_ToDrawnPixels((float)windowHeight));
 }
 
 CnFloat4x4 cnRLL_MatrixFromTransform(CnTransform2 transform)
@@ -1014,6 +1793,7 @@ CnFloat4x4 cnRLL_MatrixFromTransform(CnTransform2 transform)
 
 bool cnRLL_LoadSprite(CnSpriteId id, const char* path)
 {
+	CN_PROFILE_BEGIN(__func__);
 	CN_ASSERT_NO_GL_ERROR();
 
 	glGenTextures(1, &spriteTextures[id]);
@@ -1022,6 +1802,7 @@ bool cnRLL_LoadSprite(CnSpriteId id, const char* path)
 
 	CnImageRGBA8 image;
 	if (!cnImageRGBA8_Allocate(&image, path)) {
+		CN_PROFILE_END();
 		return false;
 	}
 
@@ -1048,31 +1829,375 @@ bool cnRLL_LoadSprite(CnSpriteId id, const char* path)
 	cnImageRGBA8_Free(&image);
 
 	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
 	return true;
 }
 
+/**
+ * Sprite textures have no alpha, so sprites are drawn in the opaque pass.
+ */
 void cnRLL_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size)
 {
-	CN_ASSERT_NO_GL_ERROR();
-
+	CN_PROFILE_BEGIN(__func__);
 	GLuint texture = spriteTextures[id];
-	CN_ASSERT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
+	CN_ASSERT_GL_OBJECT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
 		"texture", id);
-	cnRLL_ReadyTexture2(0, spriteTextures[id]);
-
-	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Multiply(
-		cnFloat4x4_NonUniformScale(size.width, size.height, 1.0f),
-		cnFloat4x4_Translate(position.x, position.y, 0.0f));;
-
-	glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
-	CN_ASSERT_NO_GL_ERROR();
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved]);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	CnDrawCommand* command = cnRLL_RecordOpaque(CnDrawKindQuad);
+	command->quad.texture = texture;
+	command->quad.position = position;
+	command->quad.size = size;
+	frameStats.pixelsCovered += cnRLL_PixelsCovered(size.width * size.height);
+	CN_PROFILE_END();
+}
 
-	cnRLL_DisableProgram(CnProgramIndexSprite);
+/**
+ * Deletes whichever of a canvas' OpenGL objects were created.
+ */
+static void cnRLL_FreeCanvasObjects(CnCanvas* canvas)
+{
+	if (canvas->framebuffer != 0) {
+		glDeleteFramebuffers(1, &canvas->framebuffer);
+	}
+	if (canvas->depthBuffer != 0) {
+		glDeleteRenderbuffers(1, &canvas->depthBuffer);
+	}
+	if (canvas->texture != 0) {
+		glDeleteTextures(1, &canvas->texture);
+	}
+	memset(canvas, 0, sizeof(CnCanvas));
+}
+
+/**
+ * Creates the texture, depth buffer and framebuffer object for a canvas.  On
+ * failure, nothing is left allocated.
+ */
+bool cnRLL_AllocateCanvas(CnCanvasId id, CnDimension2u32 size)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT(id < MaxCanvasId, "Canvas %" PRIu32 " is out of range.", id);
+	CN_ASSERT(size.width > 0 && size.height > 0, "Canvas must have non-zero size %"
+		PRIu32 "x%" PRIu32, size.width, size.height);
+	CN_ASSERT_NO_GL_ERROR();
+
+	CnCanvas* canvas = &canvases[id];
+	canvas->size = size;
+
+	glGenTextures(1, &canvas->texture);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, canvas->texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)size.width, (GLsizei)size.height, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glGenRenderbuffers(1, &canvas->depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, canvas->depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, (GLsizei)size.width,
+		(GLsizei)size.height);
+
+	glGenFramebuffers(1, &canvas->framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, canvas->framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+		canvas->texture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+		canvas->depthBuffer);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		CN_ERROR(LogSysRender, "Canvas %" PRIu32 " framebuffer is incomplete: 0x%x",
+			id, status);
+		cnRLL_FreeCanvasObjects(canvas);
+		CN_PROFILE_END();
+		return false;
+	}
+
+	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
+	return true;
+}
+
+/**
+ * Deletes the OpenGL objects of a canvas and releases its id for reuse.
+ */
+void cnRLL_DestroyCanvas(CnCanvasId id)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT(id != 0 && id < MaxCanvasId, "Canvas %" PRIu32 " is out of range.", id);
+	CN_ASSERT(id != activeCanvas, "Cannot destroy canvas %" PRIu32 " while drawing to it.", id);
+
+	cnRLL_FreeCanvasObjects(&canvases[id]);
+	cnRLL_ReleaseCanvas(id);
+	CN_PROFILE_END();
+}
+
+void cnRLL_BeginCanvas(CnCanvasId id)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
+	CN_ASSERT(id != 0 && id < MaxCanvasId, "Canvas %" PRIu32 " is out of range.", id);
+	CN_ASSERT(activeCanvas == 0, "Cannot begin canvas %" PRIu32 " while drawing to"
+		" canvas %" PRIu32, id, activeCanvas);
+	CN_ASSERT_GL_OBJECT(glIsFramebuffer(canvases[id].framebuffer), "Canvas %" PRIu32
+		" was not allocated.", id);
+
+	windowViewport = viewport;
+	windowCameraAABB2 = cameraAABB2;
+
+	// Scissoring of the window for dirty regions doesn't apply to canvases.
+	windowScissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+	glDisable(GL_SCISSOR_TEST);
 
+	glBindFramebuffer(GL_FRAMEBUFFER, canvases[id].framebuffer);
+	activeCanvas = id;
+
+	// Canvas colors are kept between uses, but draw order starts over.
+	windowDrawSequence = drawSequence;
+	glClear(GL_DEPTH_BUFFER_BIT);
+	drawSequence = 0;
+
+	cnRLL_SetViewport(cnRLL_BackingCanvasArea());
+	cnRLL_SetCameraAABB2(cnRLL_BackingCanvasArea());
+	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
+}
+
+void cnRLL_EndCanvas(void)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
+	CN_ASSERT(activeCanvas != 0, "Not drawing to a canvas.");
+
+	glBindFramebuffer(GL_FRAMEBUFFER, windowFramebuffer);
+	activeCanvas = 0;
+	drawSequence = windowDrawSequence;
+	if (windowScissorEnabled) {
+		glEnable(GL_SCISSOR_TEST);
+	}
+
+	cnRLL_SetViewport(windowViewport);
+	cnRLL_SetCameraAABB2(windowCameraAABB2);
 	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
+}
+
+/**
+ * Canvases may have transparent areas, so they're drawn in the translucent
+ * pass.
+ */
+void cnRLL_DrawCanvas(CnCanvasId id, CnFloat2 position, CnDimension2f size)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT(id != 0 && id < MaxCanvasId, "Canvas %" PRIu32 " is out of range.", id);
+	CN_ASSERT(id != activeCanvas, "Cannot draw canvas %" PRIu32 " into itself.", id);
+
+	GLuint texture = canvases[id].texture;
+	CN_ASSERT_GL_OBJECT(glIsTexture(texture), "Canvas %" PRIu32 " does not have a valid"
+		"texture", id);
+
+	CnDrawCommand* command = cnRLL_RecordTranslucent(CnDrawKindQuad);
+	command->quad.texture = texture;
+	command->quad.position = position;
+	command->quad.size = size;
+	frameStats.pixelsCovered += cnRLL_PixelsCovered(size.width * size.height);
+	CN_PROFILE_END();
+}
+
+/**
+ * Regenerates the static vertex buffer for a single chunk of a tilemap layer.
+ */
+static void cnRLL_BakeTilemapChunk(CnTilemap* map, uint32_t layer, CnRowColu32 chunkRowCol)
+{
+	CN_ASSERT_NO_GL_ERROR();
+
+	CnTilemapChunk* chunk = cnTilemap_Chunk(map, layer, chunkRowCol);
+	chunk->numQuads = cnTilemap_BakeChunk(map, layer, chunkRowCol, tilemapBakeVertices);
+	chunk->dirty = false;
+
+	// Empty chunks keep any existing buffer around, since they're likely to be
+	// filled again.
+	if (chunk->numQuads == 0) {
+		return;
+	}
+
+	GLuint buffer = chunk->renderBuffer;
+	if (buffer == 0) {
+		glGenBuffers(1, &buffer);
+		CN_ASSERT(buffer, "Cannot allocate a buffer for a tilemap chunk");
+		chunk->renderBuffer = buffer;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(CnTileVertex) * RLL_VERTICES_PER_QUAD * chunk->numQuads,
+		tilemapBakeVertices, GL_STATIC_DRAW);
+
+	CN_ASSERT_NO_GL_ERROR();
+}
+
+/**
+ * Draws every layer of a tilemap using a tileset sprite divided into a grid of
+ * equally sized cells.  Only chunks overlapping the camera are drawn, and each
+ * is a single draw call.  Layers are drawn in the opaque pass, each in front
+ * of the one before it.
+ */
+void cnRLL_DrawTilemap(CnTilemap* map, CnSpriteId tileset)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT_PTR(map);
+
+	CnRowColu32 first, last;
+	if (!cnTilemap_ChunksOverlapping(map, cnRLL_CameraAABB2(), &first, &last)) {
+		CN_PROFILE_END();
+		return;
+	}
+
+	GLuint texture = spriteTextures[tileset];
+	CN_ASSERT_GL_OBJECT(glIsTexture(texture), "Tileset sprite %" PRIu32 " does not have a valid"
+		"texture", tileset);
+
+	for (uint32_t layer = 0; layer < map->numLayers; ++layer) {
+		CnDrawCommand* command = cnRLL_RecordOpaque(CnDrawKindTilemapLayer);
+		command->tilemapLayer.map = map;
+		command->tilemapLayer.layer = layer;
+		command->tilemapLayer.tileset = texture;
+		command->tilemapLayer.origin = map->origin;
+		command->tilemapLayer.first = first;
+		command->tilemapLayer.last = last;
+	}
+	CN_PROFILE_END();
+}
+
+/**
+ * Draws the chunks of a tilemap layer which overlapped the camera when it was
+ * recorded.  Chunks with changed tiles are re-baked right before they are
+ * drawn.
+ */
+static void cnRLL_ExecuteTilemapLayer(const CnDrawCommand* command)
+{
+	CnTilemap* map = command->tilemapLayer.map;
+	const uint32_t layer = command->tilemapLayer.layer;
+	const CnRowColu32 first = command->tilemapLayer.first;
+	const CnRowColu32 last = command->tilemapLayer.last;
+	const float tileArea = map->tileSize.width * map->tileSize.height;
+
+	cnRLL_ReadyTexture2(0, command->tilemapLayer.tileset);
+
+	// Chunk vertices are baked relative to the map's origin.
+	const CnFloat2 origin = command->tilemapLayer.origin;
+	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Translate(origin.x, origin.y, 0.0f);
+	uniformStorage[CnUniformNameDepth].f = command->depth;
+
+	for (uint32_t row = first.row; row <= last.row; ++row) {
+		for (uint32_t col = first.col; col <= last.col; ++col) {
+			const CnRowColu32 chunkRowCol = { row, col };
+			CnTilemapChunk* chunk = cnTilemap_Chunk(map, layer, chunkRowCol);
+			if (chunk->dirty) {
+				cnRLL_BakeTilemapChunk(map, layer, chunkRowCol);
+			}
+
+			if (chunk->numQuads == 0) {
+				continue;
+			}
+
+			glBindBuffer(GL_ARRAY_BUFFER, chunk->renderBuffer);
+			cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite,
+				&vertexFormats[CnVertexFormatP2T2Interleaved]);
+			cnRLL_DrawQuads(chunk->numQuads);
+			frameStats.pixelsCovered += cnRLL_PixelsCovered(tileArea * (float)chunk->numQuads);
+		}
+	}
+
+	cnRLL_DisableProgram(CnProgramIndexSprite);
+}
+
+/**
+ * Frees the vertex buffers of every baked chunk in a tilemap.  The tilemap is
+ * re-baked if drawn again.
+ */
+void cnRLL_ReleaseTilemap(CnTilemap* map)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT_PTR(map);
+	for (uint32_t layer = 0; layer < map->numLayers; ++layer) {
+		for (uint32_t row = 0; row < map->sizeInChunks.height; ++row) {
+			for (uint32_t col = 0; col < map->sizeInChunks.width; ++col) {
+				CnTilemapChunk* chunk = cnTilemap_Chunk(map, layer, (CnRowColu32) { row, col });
+				if (chunk->renderBuffer != 0) {
+					GLuint buffer = chunk->renderBuffer;
+					glDeleteBuffers(1, &buffer);
+				}
+				chunk->renderBuffer = 0;
+				chunk->numQuads = 0;
+				chunk->dirty = true;
+			}
+		}
+	}
+	CN_PROFILE_END();
+}
+
+/**
+ * Draws all live particles as square points in a single draw call, blended in
+ * the translucent pass.
+ */
+void cnRLL_DrawParticles(const CnParticles* particles, float pointSize)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT_PTR(particles);
+
+	if (particles->count == 0) {
+		CN_PROFILE_END();
+		return;
+	}
+
+	CnDrawCommand* command = cnRLL_RecordTranslucent(CnDrawKindParticles);
+	command->particles.particles = particles;
+	command->particles.pointSize = pointSize;
+	CN_PROFILE_END();
+}
+
+/**
+ * Positions and colors are uploaded straight from the particle arrays without
+ * being interleaved.
+ */
+static void cnRLL_ExecuteParticles(const CnDrawCommand* command)
+{
+	const CnParticles* particles = command->particles.particles;
+	const float pointSize = command->particles.pointSize;
+	const uint32_t count = particles->count;
+	if (count == 0) {
+		return;
+	}
+
+	const size_t positionSize = sizeof(float) * count;
+	const size_t colorSize = sizeof(CnRGBA8u) * count;
+
+	// Orphan the previous storage so the driver doesn't need to wait for
+	// previous draws using it to finish.
+	glBindBuffer(GL_ARRAY_BUFFER, particleBuffer);
+	glBufferData(GL_ARRAY_BUFFER, 2 * positionSize + colorSize, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, positionSize, particles->x);
+	glBufferSubData(GL_ARRAY_BUFFER, positionSize, positionSize, particles->y);
+	glBufferSubData(GL_ARRAY_BUFFER, 2 * positionSize, colorSize, particles->color);
+
+	particleFormat.attributes[CnAttributeSemanticNamePositionX].offset = 0;
+	particleFormat.attributes[CnAttributeSemanticNamePositionY].offset = positionSize;
+	particleFormat.attributes[CnAttributeSemanticNameColor4].offset = 2 * positionSize;
+
+	uniformStorage[CnUniformNamePointSize].f = pointSize;
+	uniformStorage[CnUniformNameDepth].f = command->depth;
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexParticle, &particleFormat);
+	glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+	cnRLL_DisableProgram(CnProgramIndexParticle);
+
+	++frameStats.drawCalls;
+	frameStats.pixelsCovered += (uint64_t)(pointSize * pointSize) * count;
 }
 
 /**
@@ -1080,6 +2205,7 @@ void cnRLL_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size)
  */
 bool cnRLL_LoadPSF2Font(CnFontId id, const char* path)
 {
+	CN_PROFILE_BEGIN(__func__);
 	// TODO: Check to determine if the font id has already been used.
 
 	CN_ASSERT(path != NULL, "Cannot load a font from a null path");
@@ -1128,30 +2254,31 @@ bool cnRLL_LoadPSF2Font(CnFontId id, const char* path)
 		"font loading from path: %s", path);
 
 	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
 	return true;
 }
 
 static void cnRLL_AddToGlyphBatch(CnFloat2 position, CnDimension2f size, CnFloat2* texCoords)
 {
+	CN_ASSERT(usedGlyphs < RLL_MAX_GLYPHS, "Glyph batch is full");
+
 	const uint32_t glyphOffset = usedGlyphs * RLL_VERTICES_PER_GLYPH;
 	glyphTexCoords[glyphOffset] = texCoords[0];
 	glyphTexCoords[glyphOffset + 1] = texCoords[1];
 	glyphTexCoords[glyphOffset + 2] = texCoords[2];
-
-	glyphTexCoords[glyphOffset + 3] = texCoords[1];
-	glyphTexCoords[glyphOffset + 4] = texCoords[3];
-	glyphTexCoords[glyphOffset + 5] = texCoords[2];
+	glyphTexCoords[glyphOffset + 3] = texCoords[3];
 
 	glyphVertices[glyphOffset + 0] = position;
 	glyphVertices[glyphOffset + 1] = cnFloat2_Add(position, cnFloat2_Make(size.width, 0.0f));
 	glyphVertices[glyphOffset + 2] = cnFloat2_Add(position, cnFloat2_Make(0.0f, size.height));
-
-	glyphVertices[glyphOffset + 3] = cnFloat2_Add(position, cnFloat2_Make(size.width, 0.0f));
-	glyphVertices[glyphOffset + 4] = cnFloat2_Add(position, cnFloat2_Make(size.width, size.height));
-	glyphVertices[glyphOffset + 5] = cnFloat2_Add(position, cnFloat2_Make(0.0f, size.height));
+	glyphVertices[glyphOffset + 3] = cnFloat2_Add(position, cnFloat2_Make(size.width, size.height));
 	++usedGlyphs;
 }
 
+/**
+ * Text is drawn in the translucent pass.  Consecutive glyphs of the same font
+ * are drawn together, up to the number of quads which fit in a single draw.
+ */
 static void cnRLL_AppendGlyph(CnFontId id, CnFloat2 position, CnGlyphIndex glyphIndex)
 {
 	CnFontPSF2* font = &fonts[id];
@@ -1161,39 +2288,75 @@ static void cnRLL_AppendGlyph(CnFontId id, CnFloat2 position, CnGlyphIndex glyph
 	// TODO: Use aspect ratio of the glyph.
 	const CnDimension2f glyphSize = (CnDimension2f) { .width = 30.0f, .height = 50.0f };
 
+	// Submit what's been recorded so far to make room for more glyphs.
+	if (usedGlyphs == RLL_MAX_GLYPHS) {
+		cnRLL_FlushDraws();
+	}
+
+	const GLuint texture = fontTextures[id];
+	CnDrawCommand* last = numTranslucentCommands > 0
+		? &translucentCommands[numTranslucentCommands - 1] : NULL;
+	if (last == NULL || last->kind != CnDrawKindGlyphs || last->glyphs.texture != texture
+		|| last->glyphs.count == RLL_MAX_QUADS_PER_DRAW || drawSequence != glyphsDrawSequence)
+	{
+		last = cnRLL_RecordTranslucent(CnDrawKindGlyphs);
+		last->glyphs.texture = texture;
+		last->glyphs.first = usedGlyphs;
+		last->glyphs.count = 0;
+		glyphsDrawSequence = drawSequence;
+	}
+	++last->glyphs.count;
+
 	CnFloat2 texCoords[4];
 	cnTextureAtlas_TexCoordForSubImage(&font->atlas, &texCoords[0], glyphIndex);
 	cnRLL_AddToGlyphBatch(position, glyphSize, texCoords);
+	frameStats.pixelsCovered += cnRLL_PixelsCovered(glyphSize.width * glyphSize.height);
 }
 
 /**
- * The final draw call to write text once all the glyphs have been assembled.
+ * Uploads every recorded glyph.  Texture coordinates are stored after the
+ * space reserved for all vertex positions, so only the used portion of each
+ * region needs to be uploaded.
  */
-static void cnRLL_DrawGlyphs(CnFontId id)
+static void cnRLL_UploadGlyphs(void)
 {
-	CN_ASSERT_NO_GL_ERROR();
-	const GLuint texture = fontTextures[id];
-	CN_ASSERT(glIsTexture(texture), "Sprite %" PRIu32 " does not have a valid"
-		"texture", texture);
-	cnRLL_ReadyTexture2(0, fontTextures[id]);
-
-	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Identity();
-	glBindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+	if (usedGlyphs == 0) {
+		return;
+	}
 
-	const size_t verticesSize = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES_PER_DRAW;
-	const size_t texCoordsSize = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES_PER_DRAW;
+	const size_t verticesSize = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES;
+	const size_t texCoordsSize = sizeof(float) * 2 * RLL_MAX_GLYPH_VERTICES;
 	CN_ASSERT(verticesSize + texCoordsSize == RLL_GLYPH_BUFFER_SIZE, "Insufficient size"
 		" for vertices and texture coordinates: %zu and %zu -> %zu",
 		verticesSize, texCoordsSize,  RLL_GLYPH_BUFFER_SIZE);
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, verticesSize, glyphVertices);
-	glBufferSubData(GL_ARRAY_BUFFER, verticesSize, texCoordsSize, glyphTexCoords);
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &glyphFormat);
-	glDrawArrays(GL_TRIANGLES, 0, 6 * usedGlyphs);
-
+	// Orphan the previous contents, since they might still be in use.
+	const size_t usedSize = sizeof(CnFloat2) * RLL_VERTICES_PER_GLYPH * usedGlyphs;
+	glBindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+	glBufferData(GL_ARRAY_BUFFER, RLL_GLYPH_BUFFER_SIZE, NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, usedSize, glyphVertices);
+	glBufferSubData(GL_ARRAY_BUFFER, verticesSize, usedSize, glyphTexCoords);
 	usedGlyphs = 0;
+}
+
+static void cnRLL_ExecuteGlyphs(const CnDrawCommand* command)
+{
+	cnRLL_ReadyTexture2(0, command->glyphs.texture);
+
+	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Identity();
+	uniformStorage[CnUniformNameDepth].f = command->depth;
+
+	const size_t firstVertex = (size_t)command->glyphs.first * RLL_VERTICES_PER_GLYPH;
+	glyphFormat.attributes[CnAttributeSemanticNamePosition2].offset
+		= sizeof(CnFloat2) * firstVertex;
+	glyphFormat.attributes[CnAttributeSemanticNameTexCoord2].offset
+		= sizeof(CnFloat2) * (RLL_MAX_GLYPH_VERTICES + firstVertex);
+
+	glBindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &glyphFormat);
+	cnRLL_DrawQuads(command->glyphs.count);
 	cnRLL_DisableProgram(CnProgramIndexSprite);
-	CN_ASSERT_NO_GL_ERROR();
+	++frameStats.drawCalls;
 }
 
 /**
@@ -1203,6 +2366,7 @@ static void cnRLL_DrawGlyphs(CnFontId id)
  */
 void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* text)
 {
+	CN_PROFILE_BEGIN(__func__);
 	CnFontPSF2* font = &fonts[id];
 	// TODO: Check to ensure the id is valid.
 	CN_ASSERT(params != NULL, "Cannot draw with null parameters.");
@@ -1242,8 +2406,7 @@ void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* tex
 
 		cursor = cnUtf8_StringNext(cursor);
 	}
-	cnRLL_DrawGlyphs(id);
-	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
 }
 
 /**
@@ -1251,6 +2414,9 @@ void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* tex
  */
 void cnRLL_DrawDebugFullScreenRect(void)
 {
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_FlushDraws();
+
 	CN_ASSERT_NO_GL_ERROR();
 
 	glBindBuffer(GL_ARRAY_BUFFER, fullScreenQuadBuffer);
@@ -1260,178 +2426,358 @@ void cnRLL_DrawDebugFullScreenRect(void)
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
 	cnRLL_DisableProgram(CnProgramIndexFullScreen);
+	++frameStats.drawCalls;
+	frameStats.pixelsCovered += cnRLL_PixelsCovered(cnAABB2_Width(cameraAABB2) * cnAABB2_Height(cameraAABB2));
 
 	CN_ASSERT_NO_GL_ERROR();
+	CN_PROFILE_END();
 }
 
 /**
- * Draws a rectangle at a given center point with known dimensions.
+ * Gives the next draw a depth in front of everything drawn before it.  If
+ * draws run out of distinct depths, what's been recorded gets drawn and the
+ * depth buffer is cleared so the order can start over.
  */
-void cnRLL_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color)
+static float cnRLL_NextDepth(void)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
-
-	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
-
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	if (drawSequence == RLL_MAX_DRAW_SEQUENCE) {
+		cnRLL_FlushDraws();
+		glClear(GL_DEPTH_BUFFER_BIT);
+		drawSequence = 0;
+	}
 
-	CnFloat2 vertices[4];
-	vertices[0] = cnFloat2_Make(-dimensions.width / 2.0f, -dimensions.height / 2.0f);
-	vertices[1] = cnFloat2_Make(dimensions.width / 2.0f, -dimensions.height / 2.0f);
-	vertices[2] = cnFloat2_Make(-dimensions.width / 2.0f, dimensions.height / 2.0f);
-	vertices[3] = cnFloat2_Make(dimensions.width / 2.0f, dimensions.height / 2.0f);
+	const float t = (float)drawSequence / (float)RLL_MAX_DRAW_SEQUENCE;
+	++drawSequence;
+	return RLL_FAR_DEPTH + t * (RLL_NEAR_DEPTH - RLL_FAR_DEPTH);
+}
 
-	for (uint32_t i = 0; i < 4; ++i) {
-		vertices[i].x += center.x;
-		vertices[i].y += center.y;
+/**
+ * Estimates the pixels covered by an area in world units, using the current
+ * camera and viewport.
+ */
+static uint64_t cnRLL_PixelsCovered(float worldArea)
+{
+	const float viewportPixels = (float)(cnRLL_ToDrawnPixels(cnAABB2_Width(viewport))
+		* cnRLL_ToDrawnPixels(cnAABB2_Height(viewport)));
+	const float cameraArea = cnAABB2_Width(cameraAABB2) * cnAABB2_Height(cameraAABB2);
+	if (cameraArea <= 0.0f) {
+		return 0;
 	}
+	return (uint64_t)fminf(fabsf(worldArea) * viewportPixels / cameraArea, viewportPixels);
+}
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
+static CnDrawCommand* cnRLL_RecordOpaque(CnDrawKind kind)
+{
+	const float depth = cnRLL_NextDepth();
+	if (numOpaqueCommands == RLL_MAX_DRAW_COMMANDS) {
+		cnRLL_FlushDraws();
+	}
 
-	CN_ASSERT_NO_GL_ERROR();
+	CnDrawCommand* command = &opaqueCommands[numOpaqueCommands++];
+	command->kind = kind;
+	command->depth = depth;
+	++frameStats.opaqueDraws;
+	return command;
 }
 
-void cnRLL_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor color)
+static CnDrawCommand* cnRLL_RecordTranslucent(CnDrawKind kind)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
+	const float depth = cnRLL_NextDepth();
+	if (numTranslucentCommands == RLL_MAX_DRAW_COMMANDS) {
+		cnRLL_FlushDraws();
+	}
 
-	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
+	CnDrawCommand* command = &translucentCommands[numTranslucentCommands++];
+	command->kind = kind;
+	command->depth = depth;
+	++frameStats.translucentDraws;
+	return command;
+}
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+static void cnRLL_ExecuteQuad(const CnDrawCommand* command)
+{
+	cnRLL_ReadyTexture2(0, command->quad.texture);
 
-	CnFloat2 vertices[2];
-	vertices[0] = cnFloat2_Make(x1, y1);
-	vertices[1] = cnFloat2_Make(x2, y2);
+	const CnFloat2 position = command->quad.position;
+	const CnDimension2f size = command->quad.size;
+	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Multiply(
+		cnFloat4x4_NonUniformScale(size.width, size.height, 1.0f),
+		cnFloat4x4_Translate(position.x, position.y, 0.0f));
+	uniformStorage[CnUniformNameDepth].f = command->depth;
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-	glDrawArrays(GL_LINES, 0, 2);
+	glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved]);
+	cnRLL_DrawQuads(1);
+	cnRLL_DisableProgram(CnProgramIndexSprite);
+	++frameStats.drawCalls;
+}
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
+static void cnRLL_ExecuteDrawCommand(const CnDrawCommand* command)
+{
+	switch (command->kind) {
+		case CnDrawKindQuad:
+			cnRLL_ExecuteQuad(command);
+			break;
+		case CnDrawKindTilemapLayer:
+			cnRLL_ExecuteTilemapLayer(command);
+			break;
+		case CnDrawKindGlyphs:
+			cnRLL_ExecuteGlyphs(command);
+			break;
+		case CnDrawKindParticles:
+			cnRLL_ExecuteParticles(command);
+			break;
+		default:
+			CN_FATAL_ERROR("Unknown draw command kind: %d", command->kind);
+	}
 	CN_ASSERT_NO_GL_ERROR();
 }
 
-void cnRLL_DrawDebugLineStrip(CnFloat2* points, uint32_t numPoints, CnOpaqueColor color)
+/**
+ * Orders opaque draws nearest first.
+ */
+static int cnRLL_CompareFrontToBack(const void* left, const void* right)
 {
-	CN_ASSERT(numPoints < RLL_MAX_DEBUG_POINTS, "Exceeded number of debug points "
-		"to draw: %" PRIu32 " (%" PRIu32 " max)", numPoints, RLL_MAX_DEBUG_POINTS);
-
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
+	const float leftDepth = ((const CnDrawCommand*)left)->depth;
+	const float rightDepth = ((const CnDrawCommand*)right)->depth;
+	return (leftDepth < rightDepth) - (leftDepth > rightDepth);
+}
 
-	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
+/**
+ * Solid vertices are recorded back to front, so are reversed to be drawn
+ * front to back.  Shapes keep their vertices in the same order, just reversed.
+ */
+static void cnRLL_DrawSolids(CnSolidVertex* vertices, uint32_t numVertices, GLenum primitive)
+{
+	if (numVertices == 0) {
+		return;
+	}
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+	for (uint32_t i = 0; i < numVertices / 2; ++i) {
+		const CnSolidVertex swap = vertices[i];
+		vertices[i] = vertices[numVertices - 1 - i];
+		vertices[numVertices - 1 - i] = swap;
+	}
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnFloat2) * numPoints, points);
-	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)numPoints);
+	// Orphan the previous contents, since they might still be in use.
+	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(solidTriangles), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnSolidVertex) * numVertices, vertices);
 
+	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon,
+		&vertexFormats[CnVertexFormatP3C4Interleaved]);
+	glDrawArrays(primitive, 0, (GLsizei)numVertices);
 	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
-	CN_ASSERT_NO_GL_ERROR();
+	++frameStats.drawCalls;
 }
 
-void cnRLL_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size)
+/**
+ * Submits everything recorded so far, opaque draws first and then translucent
+ * draws.
+ */
+static void cnRLL_FlushDraws(void)
 {
+	if (numOpaqueCommands == 0 && numTranslucentCommands == 0
+		&& usedSolidTriangles == 0 && usedSolidLines == 0)
+	{
+		return;
+	}
 	CN_ASSERT_NO_GL_ERROR();
 
-	const GLuint texture = fontTextures[id];
-	CN_ASSERT(glIsTexture(texture), "Font %" PRIu32 " does not have a valid"
-		"texture", id);
-	cnRLL_ReadyTexture2(0, texture);
-
-	uniformStorage[CnUniformNameModelView].f44 = cnFloat4x4_Multiply(
-		cnFloat4x4_NonUniformScale(size.width, size.height, 1.0f),
-		cnFloat4x4_Translate(center.x, center.y, 0.0f));;
+	glEnable(GL_DEPTH_TEST);
 
-	glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
-	CN_ASSERT_NO_GL_ERROR();
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSprite, &vertexFormats[CnVertexFormatP2T2Interleaved]);
-
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	qsort(opaqueCommands, numOpaqueCommands, sizeof(CnDrawCommand), cnRLL_CompareFrontToBack);
+	for (uint32_t i = 0; i < numOpaqueCommands; ++i) {
+		cnRLL_ExecuteDrawCommand(&opaqueCommands[i]);
+	}
+	cnRLL_DrawSolids(solidTriangles, usedSolidTriangles, GL_TRIANGLES);
+	cnRLL_DrawSolids(solidLines, usedSolidLines, GL_LINES);
+
+	if (numTranslucentCommands > 0) {
+		glDepthMask(GL_FALSE);
+		glEnable(GL_BLEND);
+		cnRLL_UploadGlyphs();
+		for (uint32_t i = 0; i < numTranslucentCommands; ++i) {
+			cnRLL_ExecuteDrawCommand(&translucentCommands[i]);
+		}
+		glDisable(GL_BLEND);
+		glDepthMask(GL_TRUE);
+	}
 
-	cnRLL_DisableProgram(CnProgramIndexSprite);
+	glDisable(GL_DEPTH_TEST);
 
+	numOpaqueCommands = 0;
+	numTranslucentCommands = 0;
+	usedSolidTriangles = 0;
+	usedSolidLines = 0;
+	usedGlyphs = 0;
 	CN_ASSERT_NO_GL_ERROR();
 }
 
-void cnRLL_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnFloat4x4 transform)
+/**
+ * Reserves space for vertices of a solid shape, drawing what has already been
+ * recorded if there isn't room for the new shape.
+ */
+static CnSolidVertex* cnRLL_AppendSolids(GLenum primitive, uint32_t numVertices)
 {
-	CN_ASSERT_NO_GL_ERROR();
-
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
+	CN_ASSERT(numVertices <= RLL_MAX_SOLID_VERTICES, "Too many vertices in a single"
+		" solid shape: %" PRIu32 " (%d max)", numVertices, RLL_MAX_SOLID_VERTICES);
+	CN_ASSERT(primitive == GL_TRIANGLES || primitive == GL_LINES,
+		"Unsupported solid primitive: 0x%x", primitive);
+
+	uint32_t* used = primitive == GL_TRIANGLES ? &usedSolidTriangles : &usedSolidLines;
+	if (*used + numVertices > RLL_MAX_SOLID_VERTICES) {
+		cnRLL_FlushDraws();
+	}
 
-	uniformStorage[CnUniformNameViewModel].f44 = transform;
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
+	CnSolidVertex* vertices = primitive == GL_TRIANGLES
+		? &solidTriangles[*used] : &solidLines[*used];
+	*used += numVertices;
+	++frameStats.opaqueDraws;
+	return vertices;
+}
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+static CnFloat2 cnRLL_TransformPoint(CnFloat2 point, CnFloat4x4 transform)
+{
+	const CnFloat4 p = cnFloat4_Multiply(cnFloat4_Make(point.x, point.y, 0.0f, 1.0f), transform);
+	return cnFloat2_Make(p.v[0], p.v[1]);
+}
 
-	CnFloat2 vertices[4];
-	vertices[0] = cnFloat2_Make(-dimensions.width / 2.0f, -dimensions.height / 2.0f);
-	vertices[1] = cnFloat2_Make(dimensions.width / 2.0f, -dimensions.height / 2.0f);
-	vertices[2] = cnFloat2_Make(-dimensions.width / 2.0f, dimensions.height / 2.0f);
-	vertices[3] = cnFloat2_Make(dimensions.width / 2.0f, dimensions.height / 2.0f);
+/**
+ * Records a filled quad as two triangles.  Corners are given in triangle strip
+ * order.
+ */
+static void cnRLL_AppendSolidQuad(const CnFloat2* corners, CnRGBA8u color)
+{
+	const float depth = cnRLL_NextDepth();
+	CnSolidVertex* v = cnRLL_AppendSolids(GL_TRIANGLES, 6);
+	v[0] = (CnSolidVertex) { corners[0], depth, color };
+	v[1] = (CnSolidVertex) { corners[1], depth, color };
+	v[2] = (CnSolidVertex) { corners[2], depth, color };
+	v[3] = (CnSolidVertex) { corners[2], depth, color };
+	v[4] = (CnSolidVertex) { corners[1], depth, color };
+	v[5] = (CnSolidVertex) { corners[3], depth, color };
+
+	const CnFloat2 across = cnFloat2_Sub(corners[1], corners[0]);
+	const CnFloat2 up = cnFloat2_Sub(corners[2], corners[0]);
+	frameStats.pixelsCovered += cnRLL_PixelsCovered(across.x * up.y - across.y * up.x);
+}
 
-	for (uint32_t i = 0; i < 4; ++i) {
-		vertices[i].x += center.x;
-		vertices[i].y += center.y;
+/**
+ * Records a connected series of line segments, optionally closing the loop
+ * back to the first point.
+ */
+static void cnRLL_AppendSolidLines(const CnFloat2* points, uint32_t numPoints, bool closed,
+	CnRGBA8u color)
+{
+	CN_ASSERT(numPoints >= 2, "Lines need at least 2 points: %" PRIu32, numPoints);
+	const uint32_t numSegments = closed ? numPoints : numPoints - 1;
+	const float depth = cnRLL_NextDepth();
+	CnSolidVertex* v = cnRLL_AppendSolids(GL_LINES, 2 * numSegments);
+	for (uint32_t i = 0; i < numSegments; ++i) {
+		v[2 * i] = (CnSolidVertex) { points[i], depth, color };
+		v[2 * i + 1] = (CnSolidVertex) { points[(i + 1) % numPoints], depth, color };
 	}
+}
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
+/**
+ * Generates the corners of a rectangle in triangle strip order.
+ */
+static void cnRLL_RectCorners(CnFloat2 center, CnDimension2f dimensions, CnFloat4x4 transform,
+	CnFloat2* corners)
+{
+	const float halfWidth = dimensions.width / 2.0f;
+	const float halfHeight = dimensions.height / 2.0f;
+	corners[0] = cnFloat2_Make(center.x - halfWidth, center.y - halfHeight);
+	corners[1] = cnFloat2_Make(center.x + halfWidth, center.y - halfHeight);
+	corners[2] = cnFloat2_Make(center.x - halfWidth, center.y + halfHeight);
+	corners[3] = cnFloat2_Make(center.x + halfWidth, center.y + halfHeight);
 
-	CN_ASSERT_NO_GL_ERROR();
+	for (uint32_t i = 0; i < 4; ++i) {
+		corners[i] = cnRLL_TransformPoint(corners[i], transform);
+	}
 }
 
-void cnRLL_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnFloat4x4 transform)
+/**
+ * Draws a rectangle at a given center point with known dimensions.
+ */
+void cnRLL_DrawDebugRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color)
 {
-	CN_ASSERT_NO_GL_ERROR();
-
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_DrawRect(center, dimensions, color, cnFloat4x4_Identity());
+	CN_PROFILE_END();
+}
 
-	uniformStorage[CnUniformNameViewModel].f44 = transform;
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
+void cnRLL_DrawDebugLine(float x1, float y1, float x2, float y2, CnOpaqueColor color)
+{
+	CN_PROFILE_BEGIN(__func__);
+	const CnFloat2 points[] = { cnFloat2_Make(x1, y1), cnFloat2_Make(x2, y2) };
+	cnRLL_AppendSolidLines(points, 2, false, cnOpaqueColor_ToRGBA8u(color));
+	CN_PROFILE_END();
+}
 
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
+void cnRLL_DrawDebugLineStrip(CnFloat2* points, uint32_t numPoints, CnOpaqueColor color)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CN_ASSERT(numPoints < RLL_MAX_DEBUG_POINTS, "Exceeded number of debug points "
+		"to draw: %" PRIu32 " (%" PRIu32 " max)", numPoints, RLL_MAX_DEBUG_POINTS);
 
-	CnFloat2 vertices[4];
-	vertices[0] = cnFloat2_Make(-dimensions.width / 2.0f, -dimensions.height / 2.0f);
-	vertices[1] = cnFloat2_Make(dimensions.width / 2.0f, -dimensions.height / 2.0f);
-	vertices[2] = cnFloat2_Make(dimensions.width / 2.0f, dimensions.height / 2.0f);
-	vertices[3] = cnFloat2_Make(-dimensions.width / 2.0f, dimensions.height / 2.0f);
+	cnRLL_AppendSolidLines(points, numPoints, false, cnOpaqueColor_ToRGBA8u(color));
+	CN_PROFILE_END();
+}
 
-	for (uint32_t i = 0; i < 4; ++i) {
-		vertices[i].x += center.x;
-		vertices[i].y += center.y;
-	}
+/**
+ * Draws the whole font atlas, which has no alpha, in the opaque pass.
+ */
+void cnRLL_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size)
+{
+	CN_PROFILE_BEGIN(__func__);
+	const GLuint texture = fontTextures[id];
+	CN_ASSERT_GL_OBJECT(glIsTexture(texture), "Font %" PRIu32 " does not have a valid"
+		"texture", id);
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-	glDrawArrays(GL_LINE_LOOP, 0, 4);
+	CnDrawCommand* command = cnRLL_RecordOpaque(CnDrawKindQuad);
+	command->quad.texture = texture;
+	command->quad.position = center;
+	command->quad.size = size;
+	frameStats.pixelsCovered += cnRLL_PixelsCovered(size.width * size.height);
+	CN_PROFILE_END();
+}
 
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
+void cnRLL_DrawRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnFloat4x4 transform)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CnFloat2 corners[4];
+	cnRLL_RectCorners(center, dimensions, transform, corners);
+	cnRLL_AppendSolidQuad(corners, cnOpaqueColor_ToRGBA8u(color));
+	CN_PROFILE_END();
+}
 
-	CN_ASSERT_NO_GL_ERROR();
+void cnRLL_OutlineRect(CnFloat2 center, CnDimension2f dimensions, CnOpaqueColor color, CnFloat4x4 transform)
+{
+	CN_PROFILE_BEGIN(__func__);
+	CnFloat2 corners[4];
+	cnRLL_RectCorners(center, dimensions, transform, corners);
+
+	// Go around the outside instead of in triangle strip order.
+	const CnFloat2 loop[] = { corners[0], corners[1], corners[3], corners[2] };
+	cnRLL_AppendSolidLines(loop, 4, true, cnOpaqueColor_ToRGBA8u(color));
+	CN_PROFILE_END();
 }
 
 
 /**
  * Creates a line of points to form circle in a counter clockwise winding.
  */
-static void cnRLL_CreateCircle(CnFloat2* vertices, uint32_t numVertices, float radius)
+static void cnRLL_CreateCircle(CnFloat2* vertices, uint32_t numVertices, CnFloat2 center, float radius)
 {
 	CN_ASSERT(vertices != NULL, "Cannot write vertices into a null pointer");
 	CN_ASSERT(radius > 0.0f, "Radius must positive: %f provided", radius);
 	const float arcAngle = 2 * 3.14159f / (float)(numVertices);
 	for (uint32_t i = 0; i < numVertices; ++i) {
 		vertices[i] = cnFloat2_Make(
-			radius * cosf(i * arcAngle),
-			radius * sinf(i * arcAngle));
+			center.x + radius * cosf(i * arcAngle),
+			center.y + radius * sinf(i * arcAngle));
 	}
 }
 
@@ -1439,26 +2785,15 @@ static void cnRLL_CreateCircle(CnFloat2* vertices, uint32_t numVertices, float r
 
 void cnRLL_OutlineCircle(CnFloat2 center, float radius, CnOpaqueColor color, uint32_t numSegments)
 {
+	CN_PROFILE_BEGIN(__func__);
 	const uint32_t numPoints = numSegments + 1;
 	CN_ASSERT(numSegments < RLL_MAX_CIRCLE_POINTS, "Exceeded maximum number of circle"
 		"draw points: %" PRIu32 " of %" PRIu32, numSegments - 1, numPoints);
 
 	static CnFloat2 points[RLL_MAX_CIRCLE_POINTS];
-
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
-
-	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Translate(center.x, center.y, 0.0f);
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
-
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
-
-	cnRLL_CreateCircle(&points[0], numPoints, radius);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(CnFloat2) * numPoints, points);
-	glDrawArrays(GL_LINE_LOOP, 0, (GLsizei)numPoints);
-
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
-	CN_ASSERT_NO_GL_ERROR();
+	cnRLL_CreateCircle(&points[0], numPoints, center, radius);
+	cnRLL_AppendSolidLines(points, numPoints, true, cnOpaqueColor_ToRGBA8u(color));
+	CN_PROFILE_END();
 }
 
 /**
@@ -1468,33 +2803,11 @@ void cnRLL_OutlineCircle(CnFloat2 center, float radius, CnOpaqueColor color, uin
  */
 void cnRLL_FillScreen(CnOpaqueColor color)
 {
-	CN_ASSERT_NO_GL_ERROR();
-
-	uniformStorage[CnUniformNameViewModel].f44 = cnFloat4x4_Identity();
-	uniformStorage[CnUniformNamePolygonColor].f4 = cnFloat4_Make(color.red, color.green, color.blue, 1.0f);
-
-	glBindBuffer(GL_ARRAY_BUFFER, debugDrawBuffer);
-	cnRLL_EnableProgramForVertexFormat(CnProgramIndexSolidPolygon, &vertexFormats[CnVertexFormatP2]);
-
-	const float width = cnAABB2_Width(cameraAABB2);
-	const float height = cnAABB2_Height(cameraAABB2);
-
-	CnFloat2 vertices[4];
-	vertices[0] = cnFloat2_Make(-width / 2.0f, -height / 2.0f);
-	vertices[1] = cnFloat2_Make(width / 2.0f, -height / 2.0f);
-	vertices[2] = cnFloat2_Make(-width / 2.0f, height / 2.0f);
-	vertices[3] = cnFloat2_Make(width / 2.0f, height / 2.0f);
-
-	const CnFloat2 center = cnAABB2_Center(cameraAABB2);
-	for (uint32_t i = 0; i < 4; ++i) {
-		vertices[i].x += center.x;
-		vertices[i].y += center.y;
-	}
-
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-	cnRLL_DisableProgram(CnProgramIndexSolidPolygon);
-
-	CN_ASSERT_NO_GL_ERROR();
-}
\ No newline at end of file
+	CN_PROFILE_BEGIN(__func__);
+	const CnDimension2f size = {
+		.width = cnAABB2_Width(cameraAABB2),
+		.height = cnAABB2_Height(cameraAABB2)
+	};
+	cnRLL_DrawRect(cnAABB2_Center(cameraAABB2), size, color, cnFloat4x4_Identity());
+	CN_PROFILE_END();
+}
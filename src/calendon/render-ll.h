@@ -17,13 +17,29 @@
 #include <calendon/handle.h>
 #include <calendon/math2.h>
 #include <calendon/math4.h>
+#include <calendon/particles.h>
 #include <calendon/render-resources.h>
+#include <calendon/tilemap.h>
+#include <calendon/time.h>
 
+void cnRLL_SetValidation(CnRenderValidation level);
+void cnRLL_SetVSync(CnVSync mode);
+void cnRLL_SetMaxFramesInFlight(uint32_t maxFrames);
+void cnRLL_WaitForFramesInFlight(void);
 void cnRLL_Init(CnDimension2u32 resolution);
 void cnRLL_Shutdown(void);
 void cnRLL_StartFrame(void);
 void cnRLL_EndFrame(void);
 void cnRLL_Clear(CnRGBA8u color);
+void cnRLL_SetRetainedFrame(bool retained);
+void cnRLL_SetRenderScaling(bool enabled);
+void cnRLL_SetRenderScale(float scale);
+float cnRLL_RenderScale(void);
+void cnRLL_SetScissor(CnAABB2 area);
+void cnRLL_DisableScissor(void);
+
+CnRenderStats cnRLL_Stats(void);
+CnTime cnRLL_LastPresentTime(void);
 
 CnDimension2u32 cnRLL_Resolution(void);
 
@@ -37,12 +53,24 @@ void cnRLL_SetCameraAABB2(const CnAABB2 mapSlice);
 
 CN_DEFINE_HANDLE_TYPE(CnSpriteId, cnRLL_, Sprite);
 CN_DEFINE_HANDLE_TYPE(CnFontId, cnRLL_, Font);
+CN_DEFINE_HANDLE_TYPE(CnCanvasId, cnRLL_, Canvas);
 
 CnFloat4x4 cnRLL_MatrixFromTransform(CnTransform2 transform);
 
 bool cnRLL_LoadSprite(CnSpriteId id, const char* path);
 void cnRLL_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size);
 
+bool cnRLL_AllocateCanvas(CnCanvasId id, CnDimension2u32 size);
+void cnRLL_DestroyCanvas(CnCanvasId id);
+void cnRLL_BeginCanvas(CnCanvasId id);
+void cnRLL_EndCanvas(void);
+void cnRLL_DrawCanvas(CnCanvasId id, CnFloat2 position, CnDimension2f size);
+
+void cnRLL_DrawTilemap(CnTilemap* map, CnSpriteId tileset);
+void cnRLL_ReleaseTilemap(CnTilemap* map);
+
+void cnRLL_DrawParticles(const CnParticles* particles, float pointSize);
+
 bool cnRLL_LoadPSF2Font(CnFontId id, const char* path);
 void cnRLL_DrawSimpleText(CnFontId id, CnTextDrawParams* params, const char* text);
 void cnRLL_DrawDebugFont(CnFontId id, CnFloat2 center, CnDimension2f size);
@@ -18,6 +18,9 @@ extern "C" {
 
 #include <calendon/cn.h>
 
+#include <calendon/color.h>
+#include <calendon/math2.h>
+
 /**
  * Opaque handle used to coordinate with the renderer to uniquely identify
  * sprites.
@@ -29,6 +32,12 @@ typedef uint32_t CnSpriteId;
  */
 typedef uint32_t CnFontId;
 
+/**
+ * Opaque handle for an offscreen surface which can be drawn to, and then drawn
+ * like a sprite.
+ */
+typedef uint32_t CnCanvasId;
+
 /**
  * The horizontal direction in which text glyphs are written.
  */
@@ -52,6 +61,85 @@ typedef struct {
 	CnTextDirection printDirection;
 } CnTextDrawParams;
 
+/**
+ * How much the renderer checks for incorrect use of the graphics API.  Higher
+ * levels find problems more precisely, but are slower.
+ */
+typedef enum {
+	/** No checking. */
+	CnRenderValidationOff,
+
+	/** Errors are checked once at the end of every frame. */
+	CnRenderValidationFrame,
+
+	/** Errors and warnings are reported by the driver as they happen. */
+	CnRenderValidationCallback,
+
+	/**
+	 * Errors and the validity of resources are checked after every call,
+	 * which stalls the driver.
+	 */
+	CnRenderValidationParanoid
+} CnRenderValidation;
+
+/**
+ * Whether presenting a frame waits for the display's vertical blank.  Values
+ * match the swap interval they use.
+ */
+typedef enum {
+	/** Wait for vertical blank unless the frame is late, then tear. */
+	CnVSyncAdaptive = -1,
+
+	/** Present immediately, which may tear. */
+	CnVSyncOff = 0,
+
+	/** Always wait for vertical blank. */
+	CnVSyncOn = 1
+} CnVSync;
+
+#if CN_DEBUG
+	#define CN_RENDER_VALIDATION_DEFAULT CnRenderValidationFrame
+#else
+	#define CN_RENDER_VALIDATION_DEFAULT CnRenderValidationOff
+#endif
+
+/**
+ * Counts of the work done to draw a frame, including canvases drawn during it.
+ */
+typedef struct {
+	/** Draw calls submitted to the GPU. */
+	uint32_t drawCalls;
+
+	/** Draws in the opaque pass, which are drawn front to back. */
+	uint32_t opaqueDraws;
+
+	/** Draws in the translucent pass, which are blended back to front. */
+	uint32_t translucentDraws;
+
+	/**
+	 * Estimate of the pixels covered by everything drawn, from the size of
+	 * each draw.  This is what would be shaded with no depth testing.
+	 */
+	uint64_t pixelsCovered;
+
+	/**
+	 * Pixels which passed depth testing and were actually shaded, as measured
+	 * by the GPU.  The GPU isn't waited on, so stats are reported for the most
+	 * recent frame with this available, which lags behind the frame being
+	 * drawn.
+	 */
+	uint64_t samplesPassed;
+
+	/** Pixels in the area being drawn, to compare the other counts against. */
+	uint64_t pixelsInFrame;
+
+	/**
+	 * Time the GPU spent drawing the frame, in nanoseconds.  Like
+	 * `samplesPassed`, this lags behind the frame being drawn.
+	 */
+	uint64_t gpuNs;
+} CnRenderStats;
+
 #ifdef __cplusplus
 }
 #endif
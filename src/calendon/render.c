@@ -2,6 +2,48 @@
 
 #include "render-ll.h"
 
+#include <calendon/profile.h>
+#include <calendon/resolution-scale.h>
+
+/**
+ * When redrawing on demand, frames are only drawn when requested, and possibly
+ * only within a dirty region of the previous frame.  Otherwise every frame is
+ * redrawn completely.
+ */
+static bool s_redrawOnDemand = false;
+static bool s_redrawRequested = true;
+static bool s_redrawAll = true;
+static CnAABB2 s_dirtyRegion;
+
+/**
+ * With dynamic resolution, the resolution drawn at follows how long frames
+ * take to draw.
+ */
+static bool s_dynamicResolution = false;
+static CnResolutionScale s_resolutionScale;
+
+/**
+ * Frames start no more often than `s_frameInterval`, if it's non-zero.
+ */
+static CnTime s_frameInterval;
+static CnTime s_nextFrameStart;
+
+/**
+ * Time of the earliest input not yet in a presented frame, or zero if there's
+ * no new input.
+ */
+static CnTime s_pendingInputTime;
+static CnTime s_inputLatency;
+
+/**
+ * Changes how much usage of the graphics API is checked.  Set this before
+ * `cnR_Init` for drivers to provide the most detail at the callback level.
+ */
+void cnR_SetValidation(CnRenderValidation level)
+{
+	cnRLL_SetValidation(level);
+}
+
 /**
  * Initialize the rendering system assuming a rectangular region of the given
  * drawing dimensions.
@@ -30,6 +72,11 @@ void cnR_StartFrame(void)
 
 	cnRLL_SetViewport(cnR_BackingCanvasAABB2());
 
+	// Only pixels in the dirty region get touched, including by the clear.
+	if (s_redrawOnDemand && !s_redrawAll) {
+		cnRLL_SetScissor(s_dirtyRegion);
+	}
+
 	const CnRGBA8u black = { 0, 0, 0, 0 };
 	cnRLL_Clear(black);
 }
@@ -39,7 +86,214 @@ void cnR_StartFrame(void)
  */
 void cnR_EndFrame(void)
 {
+	cnRLL_DisableScissor();
 	cnRLL_EndFrame();
+
+	if (!cnTime_IsZero(s_pendingInputTime)) {
+		s_inputLatency = cnTime_SubtractMonotonic(cnTime_MakeNow(), s_pendingInputTime);
+		s_pendingInputTime = cnTime_MakeZero();
+	}
+
+	s_redrawRequested = false;
+	s_redrawAll = false;
+}
+
+void cnR_SetVSync(CnVSync mode)
+{
+	cnRLL_SetVSync(mode);
+}
+
+/**
+ * Limits how often frames start, or removes the limit if zero.
+ */
+void cnR_SetFrameRateCap(uint32_t framesPerSecond)
+{
+	s_frameInterval = framesPerSecond == 0
+		? cnTime_MakeZero()
+		: (CnTime) { .native = cnTime_SecToNs(1) / framesPerSecond };
+	s_nextFrameStart = cnTime_MakeNow();
+}
+
+/**
+ * Limits how many frames can be waiting for the GPU to draw them.  Fewer
+ * frames in flight reduces input latency, but gives less slack to absorb
+ * uneven frame times.
+ */
+void cnR_SetMaxFramesInFlight(uint32_t maxFrames)
+{
+	cnRLL_SetMaxFramesInFlight(maxFrames);
+}
+
+/**
+ * Waits until the next frame should start.  This should be called before
+ * processing input, so frames are drawn with input which is as recent as
+ * possible.
+ */
+void cnR_PaceFrame(void)
+{
+	CN_PROFILE_BEGIN(__func__);
+	cnRLL_WaitForFramesInFlight();
+
+	if (cnTime_IsZero(s_frameInterval)) {
+		CN_PROFILE_END();
+		return;
+	}
+
+	cnTime_SleepUntil(s_nextFrameStart);
+
+	// Keep a steady cadence, unless too far behind to catch up.
+	const CnTime now = cnTime_MakeNow();
+	s_nextFrameStart = cnTime_Add(s_nextFrameStart, s_frameInterval);
+	if (cnTime_LessThan(s_nextFrameStart, now)) {
+		s_nextFrameStart = cnTime_Add(now, s_frameInterval);
+	}
+	CN_PROFILE_END();
+}
+
+/**
+ * Notes that input was received, to measure how long it takes to be shown.
+ */
+void cnR_ReportInputTime(CnTime inputTime)
+{
+	if (cnTime_IsZero(s_pendingInputTime)) {
+		s_pendingInputTime = inputTime;
+	}
+}
+
+/**
+ * Time from receiving input to presenting the frame drawn with it, for the
+ * most recent frame with new input.
+ */
+CnTime cnR_InputLatency(void)
+{
+	return s_inputLatency;
+}
+
+/**
+ * Only draw frames when requested with `cnR_RequestRedraw` or
+ * `cnR_RequestRedrawRegion`, for programs such as tools, where the visible
+ * state rarely changes.  Previous frame contents are retained, so a redraw of
+ * a region only needs to touch the pixels within it.
+ */
+void cnR_SetRedrawOnDemand(bool onDemand)
+{
+	s_redrawOnDemand = onDemand;
+	s_redrawRequested = true;
+	s_redrawAll = true;
+	cnRLL_SetRetainedFrame(onDemand);
+}
+
+bool cnR_IsRedrawOnDemand(void)
+{
+	return s_redrawOnDemand;
+}
+
+/**
+ * Indicates that the entire next frame needs to be drawn.
+ */
+void cnR_RequestRedraw(void)
+{
+	s_redrawRequested = true;
+	s_redrawAll = true;
+}
+
+/**
+ * Indicates that part of the next frame needs to be drawn.  The region is in
+ * units of the backing canvas.  Requests for multiple regions before the next
+ * frame are combined into a single region covering all of them.
+ */
+void cnR_RequestRedrawRegion(CnAABB2 region)
+{
+	if (s_redrawAll) {
+		s_redrawRequested = true;
+		return;
+	}
+
+	if (s_redrawRequested) {
+		s_dirtyRegion = cnAABB2_IncludePoint(s_dirtyRegion, region.min);
+		s_dirtyRegion = cnAABB2_IncludePoint(s_dirtyRegion, region.max);
+	}
+	else {
+		s_dirtyRegion = region;
+	}
+	s_redrawRequested = true;
+}
+
+/**
+ * Draws should happen this frame.  This is always true unless redrawing on
+ * demand.
+ */
+bool cnR_IsRedrawRequested(void)
+{
+	return !s_redrawOnDemand || s_redrawRequested;
+}
+
+/**
+ * Draws frames at a reduced resolution when they take longer than `target`,
+ * upscaling to fill the window.  The backing canvas, viewports and redraw
+ * regions stay in window units, so drawing code is unaffected.
+ *
+ * Frames must be reported with `cnR_ReportFrameWork`.
+ */
+void cnR_SetDynamicResolution(bool enabled, CnTime target)
+{
+	s_dynamicResolution = enabled;
+	if (enabled) {
+		cnResolutionScale_Init(&s_resolutionScale, target);
+	}
+	cnRLL_SetRenderScaling(enabled);
+	cnR_RequestRedraw();
+}
+
+/**
+ * Records the work done by the frame which started at `frameStart`, after it
+ * has been presented.
+ *
+ * Time from one present to the next includes waiting for VSync and frame
+ * pacing, so it never drops below the refresh interval, and a lowered scale
+ * would never recover for targets near it.  Instead, this counts the CPU time
+ * up until the frame was handed off to be presented, plus the GPU time of the
+ * most recent frame which the GPU has finished.
+ */
+void cnR_ReportFrameWork(CnTime frameStart)
+{
+	// Frames drawn on demand come at irregular times.
+	if (!s_dynamicResolution || s_redrawOnDemand) {
+		return;
+	}
+
+	// Nothing was presented this frame.
+	const CnTime presentTime = cnRLL_LastPresentTime();
+	if (cnTime_LessThan(presentTime, frameStart)) {
+		return;
+	}
+
+	const CnTime cpuTime = cnTime_SubtractMonotonic(presentTime, frameStart);
+	const CnTime gpuTime = { .native = cnRLL_Stats().gpuNs };
+	if (cnResolutionScale_Update(&s_resolutionScale, cnTime_Add(cpuTime, gpuTime))) {
+		cnRLL_SetRenderScale(s_resolutionScale.scale);
+
+		// Retained pixels were drawn at the old scale.
+		cnR_RequestRedraw();
+	}
+}
+
+/**
+ * The fraction of the window's resolution currently being drawn.
+ */
+float cnR_ResolutionScale(void)
+{
+	return cnRLL_RenderScale();
+}
+
+/**
+ * Draw counts and overdraw of a recently finished frame.  Comparing
+ * `pixelsCovered` against `samplesPassed` shows how much overdraw drawing
+ * opaque draws front to back avoided.
+ */
+CnRenderStats cnR_Stats(void)
+{
+	return cnRLL_Stats();
 }
 
 CnDimension2u32 cnR_Resolution(void)
@@ -103,6 +357,102 @@ void cnR_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size)
 	cnRLL_DrawSprite(id, position, size);
 }
 
+/**
+ * Creates an offscreen canvas of a given size in pixels, which can be drawn to
+ * once and then drawn many times as a single textured quad.  This is useful for
+ * caching layers which are expensive to draw, but rarely change.
+ */
+bool cnR_CreateCanvas(CnCanvasId* id, CnDimension2u32 size)
+{
+	CN_ASSERT(id != NULL, "Cannot assign a canvas to a null pointer.");
+	if (!cnRLL_CreateCanvas(id)) {
+		return false;
+	}
+	if (!cnRLL_AllocateCanvas(*id, size)) {
+		cnRLL_ReleaseCanvas(*id);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Frees a canvas, after which its id may be given to a new canvas.  Draws of
+ * the canvas must be submitted first, with `cnR_EndFrame`.
+ */
+void cnR_DestroyCanvas(CnCanvasId id)
+{
+	cnRLL_DestroyCanvas(id);
+}
+
+/**
+ * Redirects all drawing to the canvas until `cnR_EndCanvas`.  The canvas is
+ * cleared, and the viewport and camera are set to cover the entire canvas, in
+ * units of its pixels.  They may be changed while drawing to the canvas, and
+ * are restored by `cnR_EndCanvas`.
+ *
+ * Canvases cannot be nested.
+ */
+void cnR_BeginCanvas(CnCanvasId id)
+{
+	cnRLL_BeginCanvas(id);
+
+	const CnRGBA8u transparent = { 0, 0, 0, 0 };
+	cnRLL_Clear(transparent);
+}
+
+/**
+ * Resumes drawing to the window.
+ */
+void cnR_EndCanvas(void)
+{
+	cnRLL_EndCanvas();
+}
+
+/**
+ * Draws the contents of a canvas with its lower-left corner at the position.
+ */
+void cnR_DrawCanvas(CnCanvasId id, CnFloat2 position, CnDimension2f size)
+{
+	cnRLL_DrawCanvas(id, position, size);
+}
+
+/**
+ * Draws all layers of a tilemap, in order, with tiles from a sprite divided
+ * into a grid of equally sized cells.  Only the parts of the tilemap visible
+ * to the camera are drawn.  Drawing with a different grid than last time
+ * re-bakes the whole tilemap.
+ *
+ * Tiles are read when the frame's draws are submitted, so the tilemap must not
+ * change or be freed before `cnR_EndFrame`.
+ */
+void cnR_DrawTilemap(CnTilemap* map, CnSpriteId tileset, CnDimension2u32 tilesetGrid)
+{
+	CN_ASSERT_PTR(map);
+	cnTilemap_SetTilesetGrid(map, tilesetGrid);
+	cnRLL_DrawTilemap(map, tileset);
+}
+
+/**
+ * Releases renderer resources held by a tilemap.  Must be called before
+ * `cnTilemap_Free`.
+ */
+void cnR_ReleaseTilemap(CnTilemap* map)
+{
+	cnRLL_ReleaseTilemap(map);
+}
+
+/**
+ * Draws every live particle as a square point of the given size in pixels,
+ * blended using each particle's alpha.
+ *
+ * Particles are read when the frame's draws are submitted, so they must not be
+ * updated or freed before `cnR_EndFrame`.
+ */
+void cnR_DrawParticles(const CnParticles* particles, float pointSize)
+{
+	cnRLL_DrawParticles(particles, pointSize);
+}
+
 bool cnR_CreateFont(CnFontId* id)
 {
 	return cnRLL_CreateFont(id);
@@ -28,18 +28,41 @@
 
 #include <calendon/color.h>
 #include <calendon/math2.h>
+#include <calendon/particles.h>
 #include <calendon/render-resources.h>
+#include <calendon/tilemap.h>
+#include <calendon/time.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+CN_API void cnR_SetValidation(CnRenderValidation level);
 CN_API void cnR_Init(CnDimension2u32 resolution);
 CN_API void cnR_Shutdown(void);
 
 CN_API void cnR_StartFrame(void);
 CN_API void cnR_EndFrame(void);
 
+CN_API void cnR_SetVSync(CnVSync mode);
+CN_API void cnR_SetFrameRateCap(uint32_t framesPerSecond);
+CN_API void cnR_SetMaxFramesInFlight(uint32_t maxFrames);
+CN_API void cnR_PaceFrame(void);
+CN_API void cnR_ReportInputTime(CnTime inputTime);
+CN_API CnTime cnR_InputLatency(void);
+
+CN_API void cnR_SetRedrawOnDemand(bool onDemand);
+CN_API bool cnR_IsRedrawOnDemand(void);
+CN_API void cnR_RequestRedraw(void);
+CN_API void cnR_RequestRedrawRegion(CnAABB2 region);
+CN_API bool cnR_IsRedrawRequested(void);
+
+CN_API void cnR_SetDynamicResolution(bool enabled, CnTime target);
+CN_API void cnR_ReportFrameWork(CnTime frameStart);
+CN_API float cnR_ResolutionScale(void);
+
+CN_API CnRenderStats cnR_Stats(void);
+
 CN_API CnDimension2u32 cnR_Resolution(void);
 
 CN_API CnAABB2 cnR_BackingCanvasAABB2(void);
@@ -54,6 +77,17 @@ CN_API bool cnR_CreateSprite(CnSpriteId* id);
 CN_API bool cnR_LoadSprite(CnSpriteId id, const char* path);
 CN_API void cnR_DrawSprite(CnSpriteId id, CnFloat2 position, CnDimension2f size);
 
+CN_API bool cnR_CreateCanvas(CnCanvasId* id, CnDimension2u32 size);
+CN_API void cnR_DestroyCanvas(CnCanvasId id);
+CN_API void cnR_BeginCanvas(CnCanvasId id);
+CN_API void cnR_EndCanvas(void);
+CN_API void cnR_DrawCanvas(CnCanvasId id, CnFloat2 position, CnDimension2f size);
+
+CN_API void cnR_DrawTilemap(CnTilemap* map, CnSpriteId tileset, CnDimension2u32 tilesetGrid);
+CN_API void cnR_ReleaseTilemap(CnTilemap* map);
+
+CN_API void cnR_DrawParticles(const CnParticles* particles, float pointSize);
+
 CN_API bool cnR_CreateFont(CnFontId* id);
 CN_API bool cnR_LoadPSF2Font(CnFontId id, const char* path);
 CN_API void cnR_DrawSimpleText(CnFontId id, CnFloat2 position, const char* text);
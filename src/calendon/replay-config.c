@@ -0,0 +1,84 @@
+#include "replay-config.h"
+
+#include <calendon/cn.h>
+
+#include <calendon/path.h>
+#include <calendon/string.h>
+
+int32_t cnReplay_OptionRecordPath(const CnCommandLineParse* parse, void* c);
+int32_t cnReplay_OptionReplayPath(const CnCommandLineParse* parse, void* c);
+
+static CnReplayConfig s_config;
+static CnCommandLineOption options[] = {
+	{
+		"\t--record FILE\n"
+			"\t\tRecord the time covered by every tick, and all input, to FILE.\n"
+			"\t\tCan't be used with --replay.\n",
+		NULL,
+		"--record",
+		cnReplay_OptionRecordPath
+	},
+	{
+		"\t--replay FILE\n"
+			"\t\tRun the ticks and input recorded in FILE as fast as possible,\n"
+			"\t\tthen exit.  Live input is ignored.  Can be run with --headless.\n",
+		NULL,
+		"--replay",
+		cnReplay_OptionReplayPath
+	},
+};
+
+CnCommandLineOptionList cnReplay_CommandLineOptionList(void) {
+	CnCommandLineOptionList optionList;
+	optionList.options = options;
+	optionList.numOptions = 2;
+	return optionList;
+}
+
+/**
+ * Reads the path following an option.
+ */
+static int32_t cnReplay_ParsePath(const CnCommandLineParse* parse, CnPathBuffer* path)
+{
+	if (!cnCommandLineParse_HasLookAhead(parse, 2)) {
+		cnPrint("Must provide a recording file.\n");
+		return CnOptionParseError;
+	}
+
+	const char* pathString = cnCommandLineParse_LookAhead(parse, 2);
+	if (!cnString_FitsWithNull(pathString, CN_MAX_TERMINATED_PATH)) {
+		cnPrint("The recording path is too long.\n");
+		return CnOptionParseError;
+	}
+	cnPathBuffer_Set(path, pathString);
+	return 2;
+}
+
+int32_t cnReplay_OptionRecordPath(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnReplayConfig* config = (CnReplayConfig*)c;
+	return cnReplay_ParsePath(parse, &config->recordPath);
+}
+
+int32_t cnReplay_OptionReplayPath(const CnCommandLineParse* parse, void* c)
+{
+	CN_ASSERT_PTR(parse);
+	CN_ASSERT_PTR(c);
+
+	CnReplayConfig* config = (CnReplayConfig*)c;
+	return cnReplay_ParsePath(parse, &config->replayPath);
+}
+
+void* cnReplay_Config(void) {
+	return &s_config;
+}
+
+void cnReplay_SetDefaultConfig(void* config)
+{
+	CnReplayConfig* c = (CnReplayConfig*)config;
+	cnPathBuffer_Clear(&c->recordPath);
+	cnPathBuffer_Clear(&c->replayPath);
+}
@@ -0,0 +1,25 @@
+#ifndef CN_REPLAY_CONFIG_H
+#define CN_REPLAY_CONFIG_H
+
+#include <calendon/cn.h>
+#include <calendon/path.h>
+#include <calendon/system.h>
+
+typedef struct {
+	/**
+	 * Where to record ticks and input, or empty to not record.
+	 */
+	CnPathBuffer recordPath;
+
+	/**
+	 * A recording to play back instead of using live input and time, or empty
+	 * to play normally.
+	 */
+	CnPathBuffer replayPath;
+} CnReplayConfig;
+
+CnCommandLineOptionList cnReplay_CommandLineOptionList(void);
+void* cnReplay_Config(void);
+void cnReplay_SetDefaultConfig(void* config);
+
+#endif /* CN_REPLAY_CONFIG_H */
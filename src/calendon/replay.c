@@ -0,0 +1,338 @@
+#include "replay.h"
+
+#include <calendon/log.h>
+#include <calendon/replay-config.h>
+#include <calendon/ui.h>
+
+#include <string.h>
+
+static const char s_magic[4] = { 'C', 'N', 'R', 'P' };
+
+/**
+ * Increased whenever the layout of entries changes.
+ */
+#define CN_REPLAY_VERSION 2
+
+enum {
+	CnReplayTagTick = 1,
+	CnReplayTagInput = 2
+};
+
+/**
+ * Writes seven bits at a time, lowest first, with the high bit set on every
+ * byte but the last.
+ */
+static void cnReplayLog_WriteVarint(CnReplayLog* log, uint64_t value)
+{
+	while (value >= 0x80) {
+		fputc((int)((value & 0x7F) | 0x80), log->file);
+		value >>= 7;
+	}
+	fputc((int)value, log->file);
+}
+
+/**
+ * Signed values are zig-zag encoded, so small negative values stay short.
+ */
+static void cnReplayLog_WriteSigned(CnReplayLog* log, int32_t value)
+{
+	const uint32_t zigZag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	cnReplayLog_WriteVarint(log, zigZag);
+}
+
+static bool cnReplayLog_ReadVarint(CnReplayLog* log, uint64_t* value)
+{
+	*value = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7) {
+		const int byte = fgetc(log->file);
+		if (byte == EOF) {
+			return false;
+		}
+		*value |= (uint64_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool cnReplayLog_ReadSigned(CnReplayLog* log, int32_t* value)
+{
+	uint64_t zigZag;
+	if (!cnReplayLog_ReadVarint(log, &zigZag)) {
+		return false;
+	}
+	*value = (int32_t)((uint32_t)(zigZag >> 1) ^ (uint32_t)-(int64_t)(zigZag & 1));
+	return true;
+}
+
+/**
+ * Starts a new recording, replacing any existing file.
+ */
+bool cnReplayLog_OpenWrite(CnReplayLog* log, const char* path, CnTime start)
+{
+	CN_ASSERT_PTR(log);
+	CN_ASSERT_PTR(path);
+
+	log->start = start;
+	log->file = fopen(path, "wb");
+	if (!log->file) {
+		return false;
+	}
+
+	fwrite(s_magic, 1, sizeof(s_magic), log->file);
+	cnReplayLog_WriteVarint(log, CN_REPLAY_VERSION);
+	return true;
+}
+
+/**
+ * Opens a recording for playback.  Returns false if the file can't be opened,
+ * or isn't a recording this version can read.
+ */
+bool cnReplayLog_OpenRead(CnReplayLog* log, const char* path, CnTime start)
+{
+	CN_ASSERT_PTR(log);
+	CN_ASSERT_PTR(path);
+
+	log->start = start;
+	log->file = fopen(path, "rb");
+	if (!log->file) {
+		return false;
+	}
+
+	char magic[sizeof(s_magic)];
+	uint64_t version;
+	if (fread(magic, 1, sizeof(magic), log->file) != sizeof(magic)
+		|| memcmp(magic, s_magic, sizeof(s_magic)) != 0
+		|| !cnReplayLog_ReadVarint(log, &version)
+		|| version != CN_REPLAY_VERSION)
+	{
+		cnReplayLog_Close(log);
+		return false;
+	}
+	return true;
+}
+
+void cnReplayLog_Close(CnReplayLog* log)
+{
+	CN_ASSERT_PTR(log);
+	if (log->file) {
+		fclose(log->file);
+		log->file = NULL;
+	}
+}
+
+void cnReplayLog_WriteTick(CnReplayLog* log, const CnReplayTick* tick)
+{
+	CN_ASSERT_PTR(log);
+	CN_ASSERT_PTR(tick);
+
+	uint32_t alphaBits;
+	memcpy(&alphaBits, &tick->event.alpha, sizeof(alphaBits));
+
+	cnReplayLog_WriteVarint(log, CnReplayTagTick);
+	cnReplayLog_WriteVarint(log, tick->event.dt.native);
+	cnReplayLog_WriteVarint(log, alphaBits);
+	cnReplayLog_WriteSigned(log, tick->mouse.x);
+	cnReplayLog_WriteSigned(log, tick->mouse.y);
+	cnReplayLog_WriteSigned(log, tick->mouse.dx);
+	cnReplayLog_WriteSigned(log, tick->mouse.dy);
+}
+
+void cnReplayLog_WriteInput(CnReplayLog* log, const CnInputEvent* input)
+{
+	CN_ASSERT_PTR(log);
+	CN_ASSERT_PTR(input);
+
+	cnReplayLog_WriteVarint(log, CnReplayTagInput);
+	cnReplayLog_WriteVarint(log, (uint64_t)input->type);
+	cnReplayLog_WriteVarint(log, cnTime_SubtractMonotonic(input->time, log->start).native);
+	cnReplayLog_WriteSigned(log, (int32_t)input->key);
+	cnReplayLog_WriteVarint(log, input->repeat ? 1 : 0);
+	cnReplayLog_WriteVarint(log, input->button);
+	cnReplayLog_WriteSigned(log, input->x);
+	cnReplayLog_WriteSigned(log, input->y);
+	cnReplayLog_WriteSigned(log, input->dx);
+	cnReplayLog_WriteSigned(log, input->dy);
+}
+
+static bool cnReplayLog_ReadTick(CnReplayLog* log, CnReplayTick* tick)
+{
+	uint64_t dt, alphaBits;
+	if (!cnReplayLog_ReadVarint(log, &dt)
+		|| !cnReplayLog_ReadVarint(log, &alphaBits)
+		|| !cnReplayLog_ReadSigned(log, &tick->mouse.x)
+		|| !cnReplayLog_ReadSigned(log, &tick->mouse.y)
+		|| !cnReplayLog_ReadSigned(log, &tick->mouse.dx)
+		|| !cnReplayLog_ReadSigned(log, &tick->mouse.dy))
+	{
+		return false;
+	}
+
+	const uint32_t alpha32 = (uint32_t)alphaBits;
+	tick->event.dt.native = dt;
+	memcpy(&tick->event.alpha, &alpha32, sizeof(tick->event.alpha));
+	return true;
+}
+
+static bool cnReplayLog_ReadInput(CnReplayLog* log, CnInputEvent* input)
+{
+	uint64_t type, offset, repeat, button;
+	int32_t key;
+	if (!cnReplayLog_ReadVarint(log, &type)
+		|| !cnReplayLog_ReadVarint(log, &offset)
+		|| !cnReplayLog_ReadSigned(log, &key)
+		|| !cnReplayLog_ReadVarint(log, &repeat)
+		|| !cnReplayLog_ReadVarint(log, &button)
+		|| !cnReplayLog_ReadSigned(log, &input->x)
+		|| !cnReplayLog_ReadSigned(log, &input->y)
+		|| !cnReplayLog_ReadSigned(log, &input->dx)
+		|| !cnReplayLog_ReadSigned(log, &input->dy)
+		|| type > CnInputEventMouseWheel)
+	{
+		return false;
+	}
+
+	input->type = (CnInputEventType)type;
+	input->time = cnTime_Add(log->start, (CnTime) { .native = offset });
+	input->key = (SDL_Keycode)key;
+	input->repeat = repeat != 0;
+	input->button = (uint8_t)button;
+	return true;
+}
+
+/**
+ * Reads the next entry into either `tick` or `input`, depending on which type
+ * of entry it is.
+ */
+CnReplayEntry cnReplayLog_Read(CnReplayLog* log, CnReplayTick* tick, CnInputEvent* input)
+{
+	CN_ASSERT_PTR(log);
+	CN_ASSERT_PTR(tick);
+	CN_ASSERT_PTR(input);
+
+	const int tag = fgetc(log->file);
+	switch (tag) {
+		case EOF:
+			return CnReplayEntryEnd;
+		case CnReplayTagTick:
+			return cnReplayLog_ReadTick(log, tick) ? CnReplayEntryTick : CnReplayEntryError;
+		case CnReplayTagInput:
+			return cnReplayLog_ReadInput(log, input) ? CnReplayEntryInput : CnReplayEntryError;
+		default:
+			return CnReplayEntryError;
+	}
+}
+
+static CnReplayLog s_recording;
+static CnReplayLog s_playback;
+
+bool cnReplay_IsReplaying(void)
+{
+	return s_playback.file != NULL;
+}
+
+/**
+ * Records a tick about to run, with the input state it will poll.
+ */
+void cnReplay_RecordTick(const CnFrameEvent* tick)
+{
+	if (s_recording.file) {
+		const CnReplayTick recorded = { *tick, cnInput_Poll()->mouse };
+		cnReplayLog_WriteTick(&s_recording, &recorded);
+	}
+}
+
+void cnReplay_RecordInput(const CnInputEvent* input)
+{
+	if (s_recording.file) {
+		cnReplayLog_WriteInput(&s_recording, input);
+	}
+}
+
+/**
+ * Feeds recorded input up to the next tick into the input queue, and fills in
+ * the tick and the input state it polled.  Returns false once the recording is
+ * finished.
+ */
+bool cnReplay_NextTick(CnFrameEvent* tick)
+{
+	CN_ASSERT_PTR(tick);
+	if (!s_playback.file) {
+		return false;
+	}
+
+	CnReplayTick recorded;
+	CnInputEvent input;
+	for (;;) {
+		switch (cnReplayLog_Read(&s_playback, &recorded, &input)) {
+			case CnReplayEntryTick:
+				*tick = recorded.event;
+				cnInput_Poll()->mouse = recorded.mouse;
+				return true;
+			case CnReplayEntryInput:
+				cnInput_Inject(&input);
+				break;
+			case CnReplayEntryError:
+				CN_ERROR(LogSysMain, "Recording is damaged, stopping playback.");
+				return false;
+			default:
+				return false;
+		}
+	}
+}
+
+static bool cnReplay_Init(void)
+{
+	const CnReplayConfig* config = (CnReplayConfig*)cnReplay_Config();
+	const CnTime now = cnTime_MakeNow();
+
+	// Playback input doesn't come through the window system, where input is
+	// recorded, so the recording would have ticks without their input.
+	if (config->recordPath.str[0] != '\0' && config->replayPath.str[0] != '\0') {
+		CN_ERROR(LogSysMain, "--record can't be used with --replay.");
+		return false;
+	}
+
+	if (config->recordPath.str[0] != '\0'
+		&& !cnReplayLog_OpenWrite(&s_recording, config->recordPath.str, now))
+	{
+		CN_ERROR(LogSysMain, "Unable to open recording to write: %s", config->recordPath.str);
+		return false;
+	}
+
+	if (config->replayPath.str[0] != '\0'
+		&& !cnReplayLog_OpenRead(&s_playback, config->replayPath.str, now))
+	{
+		CN_ERROR(LogSysMain, "Unable to read recording: %s", config->replayPath.str);
+		return false;
+	}
+	return true;
+}
+
+static void cnReplay_Shutdown(void)
+{
+	cnReplayLog_Close(&s_recording);
+	cnReplayLog_Close(&s_playback);
+}
+
+static const char* cnReplay_Name(void)
+{
+	return "Replay";
+}
+
+CnSystem cnReplay_System(void)
+{
+	return (CnSystem) {
+		.name             = cnReplay_Name,
+		.options          = cnReplay_CommandLineOptionList,
+		.config           = cnReplay_Config,
+		.setDefaultConfig = cnReplay_SetDefaultConfig,
+
+		.init             = cnReplay_Init,
+		.shutdown         = cnReplay_Shutdown,
+		.sharedLibrary    = NULL,
+
+		.behavior         = cnSystem_NoBehavior()
+	};
+}
@@ -0,0 +1,90 @@
+#ifndef CN_REPLAY_H
+#define CN_REPLAY_H
+
+/**
+ * @file replay.h
+ *
+ * Records the time covered by each tick and all input events, so a session can
+ * be played back with exactly the same ticks and input.
+ *
+ * Playing back a recording of real play gives a repeatable workload, for
+ * comparing performance between builds.
+ *
+ * Recordings are a short header followed by a stream of entries in the order
+ * they happened: each input event as it is read, then each tick as it runs.
+ * Integers are written as variable length, so most take one or two bytes.
+ * Playback feeds every input event before a tick into the input queue, then
+ * runs the tick with the recorded delta time and mouse state.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/behavior.h>
+#include <calendon/input-events.h>
+#include <calendon/input-mouse.h>
+#include <calendon/system.h>
+#include <calendon/time.h>
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	CnReplayEntryTick,
+	CnReplayEntryInput,
+
+	/** The end of the recording was reached. */
+	CnReplayEntryEnd,
+
+	/** The recording is damaged or truncated partway through an entry. */
+	CnReplayEntryError
+} CnReplayEntry;
+
+/**
+ * A tick and the input state it polled.
+ */
+typedef struct {
+	CnFrameEvent event;
+
+	/**
+	 * Mouse movement is cleared between frames rather than by an input event,
+	 * so ticks sharing a frame see movement which a replayed tick wouldn't.
+	 */
+	CnMouse mouse;
+} CnReplayTick;
+
+/**
+ * An open recording, either being written or read.
+ */
+typedef struct {
+	FILE* file;
+
+	/**
+	 * Input event times are stored relative to this time, which is when
+	 * recording started or playback started.
+	 */
+	CnTime start;
+} CnReplayLog;
+
+CN_API bool cnReplayLog_OpenWrite(CnReplayLog* log, const char* path, CnTime start);
+CN_API bool cnReplayLog_OpenRead(CnReplayLog* log, const char* path, CnTime start);
+CN_API void cnReplayLog_Close(CnReplayLog* log);
+
+CN_API void cnReplayLog_WriteTick(CnReplayLog* log, const CnReplayTick* tick);
+CN_API void cnReplayLog_WriteInput(CnReplayLog* log, const CnInputEvent* input);
+CN_API CnReplayEntry cnReplayLog_Read(CnReplayLog* log, CnReplayTick* tick, CnInputEvent* input);
+
+CN_TEST_API CnSystem cnReplay_System(void);
+
+CN_API bool cnReplay_IsReplaying(void);
+void cnReplay_RecordTick(const CnFrameEvent* tick);
+void cnReplay_RecordInput(const CnInputEvent* input);
+CN_TEST_API bool cnReplay_NextTick(CnFrameEvent* tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_REPLAY_H */
@@ -0,0 +1,87 @@
+#include "resolution-scale.h"
+
+#include <calendon/float.h>
+
+#include <math.h>
+
+/**
+ * How much of each new frame time goes into the smoothed frame time.
+ */
+#define CN_RESOLUTION_SCALE_SMOOTHING 0.05f
+
+/**
+ * Frame times are capped at this multiple of the target, so occasional hitches
+ * like loading don't count for much.
+ */
+#define CN_RESOLUTION_SCALE_MAX_SAMPLE 2.0f
+
+/**
+ * Frames slower than the target by this factor reduce the scale.
+ */
+#define CN_RESOLUTION_SCALE_OVER_BUDGET 1.1f
+
+/**
+ * Frames faster than the target by this factor increase the scale.
+ */
+#define CN_RESOLUTION_SCALE_UNDER_BUDGET 0.8f
+
+/**
+ * Scale increases happen in small steps, since running out of time is worse
+ * than a slightly blurrier image.
+ */
+#define CN_RESOLUTION_SCALE_STEP_UP 0.05f
+
+static float cnResolutionScale_Ms(CnTime t)
+{
+	return (float)t.native / 1000000.0f;
+}
+
+/**
+ * Starts at full resolution, aiming to keep frames at or below `target`.
+ */
+void cnResolutionScale_Init(CnResolutionScale* rs, CnTime target)
+{
+	CN_ASSERT_PTR(rs);
+	CN_ASSERT(!cnTime_IsZero(target), "Frame time target must be non-zero.");
+
+	rs->scale = 1.0f;
+	rs->targetMs = cnResolutionScale_Ms(target);
+	rs->smoothedMs = rs->targetMs;
+	rs->framesSinceChange = 0;
+}
+
+/**
+ * Records the time of the last frame.  Returns true if the scale changed.
+ */
+bool cnResolutionScale_Update(CnResolutionScale* rs, CnTime frameTime)
+{
+	CN_ASSERT_PTR(rs);
+
+	const float frameMs = fminf(cnResolutionScale_Ms(frameTime),
+		rs->targetMs * CN_RESOLUTION_SCALE_MAX_SAMPLE);
+	rs->smoothedMs += CN_RESOLUTION_SCALE_SMOOTHING * (frameMs - rs->smoothedMs);
+
+	if (rs->framesSinceChange < CN_RESOLUTION_SCALE_SETTLE_FRAMES) {
+		++rs->framesSinceChange;
+		return false;
+	}
+
+	float next = rs->scale;
+	if (rs->smoothedMs > rs->targetMs * CN_RESOLUTION_SCALE_OVER_BUDGET) {
+		// Fill cost goes with the number of pixels, which is the square of the
+		// scale, so aim to land right on the target.
+		next = rs->scale * sqrtf(rs->targetMs / rs->smoothedMs);
+	}
+	else if (rs->smoothedMs < rs->targetMs * CN_RESOLUTION_SCALE_UNDER_BUDGET) {
+		next = rs->scale + CN_RESOLUTION_SCALE_STEP_UP;
+	}
+
+	next = cnFloat_Clamp(next, CN_RESOLUTION_SCALE_MIN, 1.0f);
+	if (next == rs->scale) {
+		return false;
+	}
+
+	rs->scale = next;
+	rs->framesSinceChange = 0;
+	return true;
+}
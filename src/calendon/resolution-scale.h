@@ -0,0 +1,54 @@
+#ifndef CN_RESOLUTION_SCALE_H
+#define CN_RESOLUTION_SCALE_H
+
+/**
+ * @file resolution-scale.h
+ *
+ * Picks the fraction of the window's resolution at which to render, to keep
+ * frame times near a target.  Busy scenes get drawn with fewer pixels and
+ * upscaled, and the scale recovers once frames get cheap again.
+ *
+ * Frame times are smoothed and the scale only changes after it has been
+ * stable for a number of frames, so single slow frames don't cause the image
+ * quality to flicker.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The lowest fraction of the window resolution which will ever be used.
+ */
+#define CN_RESOLUTION_SCALE_MIN 0.5f
+
+/**
+ * Frames which must pass after a change before the scale changes again, to
+ * let the smoothed frame time reflect the new scale.
+ */
+#define CN_RESOLUTION_SCALE_SETTLE_FRAMES 20
+
+typedef struct {
+	/** Fraction of the window resolution to use, in each dimension. */
+	float scale;
+
+	float targetMs;
+
+	/** Exponential moving average of recent frame times. */
+	float smoothedMs;
+
+	uint32_t framesSinceChange;
+} CnResolutionScale;
+
+CN_API void cnResolutionScale_Init(CnResolutionScale* rs, CnTime target);
+CN_API bool cnResolutionScale_Update(CnResolutionScale* rs, CnTime frameTime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_RESOLUTION_SCALE_H */
@@ -0,0 +1,182 @@
+#include "schedule.h"
+
+#include <calendon/atomic.h>
+
+#include <string.h>
+
+static bool cnSchedule_ListContains(const char* const* names, uint32_t numNames, const char* name)
+{
+	for (uint32_t i = 0; i < numNames; ++i) {
+		if (strcmp(names[i], name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Returns true if `name` is read or written by the access.  A system's own
+ * name counts as a resource it writes.
+ */
+static bool cnSchedule_Touches(const CnSystemAccess* access, const char* systemName, const char* name)
+{
+	return (systemName && strcmp(systemName, name) == 0)
+		|| cnSchedule_ListContains(access->writes, access->numWrites, name)
+		|| cnSchedule_ListContains(access->reads, access->numReads, name);
+}
+
+/**
+ * Whether anything written by `writer` is touched by `other`.
+ */
+static bool cnSchedule_WritesTouched(const CnSystem* writer, const CnSystem* other)
+{
+	const CnSystemAccess writerAccess = writer->access();
+	const CnSystemAccess otherAccess = other->access();
+	const char* writerName = writer->name ? writer->name() : NULL;
+	const char* otherName = other->name ? other->name() : NULL;
+
+	if (writerName && cnSchedule_Touches(&otherAccess, otherName, writerName)) {
+		return true;
+	}
+	for (uint32_t i = 0; i < writerAccess.numWrites; ++i) {
+		if (cnSchedule_Touches(&otherAccess, otherName, writerAccess.writes[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Two systems conflict if either writes something the other touches.  Systems
+ * which don't declare what they touch conflict with everything.
+ */
+static bool cnSchedule_Conflicts(const CnSystem* a, const CnSystem* b)
+{
+	if (!a->access || !b->access) {
+		return true;
+	}
+	return cnSchedule_WritesTouched(a, b) || cnSchedule_WritesTouched(b, a);
+}
+
+/**
+ * Builds the dependencies between the ticks of the given systems.  Systems
+ * without a tick are left out.
+ */
+void cnSchedule_Build(CnSchedule* schedule, const CnSystem* systems, uint32_t numSystems)
+{
+	CN_ASSERT_PTR(schedule);
+	CN_ASSERT_PTR(systems);
+
+	memset(schedule, 0, sizeof(CnSchedule));
+	for (uint32_t i = 0; i < numSystems; ++i) {
+		if (!systems[i].behavior.tick) {
+			continue;
+		}
+		CN_ASSERT(schedule->numNodes < CN_SCHEDULE_MAX_SYSTEMS,
+			"Too many systems to schedule: %" PRIu32, numSystems);
+
+		const uint32_t nodeIndex = schedule->numNodes++;
+		CnScheduleNode* node = &schedule->nodes[nodeIndex];
+		node->schedule = schedule;
+		node->systemIndex = i;
+
+		for (uint32_t before = 0; before < nodeIndex; ++before) {
+			CnScheduleNode* dependency = &schedule->nodes[before];
+			if (cnSchedule_Conflicts(&systems[dependency->systemIndex], &systems[i])) {
+				dependency->dependents |= 1u << nodeIndex;
+				++node->numDependencies;
+			}
+		}
+	}
+
+	schedule->serial = true;
+	for (uint32_t i = 1; i < schedule->numNodes; ++i) {
+		if ((schedule->nodes[i - 1].dependents & (1u << i)) == 0) {
+			schedule->serial = false;
+		}
+	}
+}
+
+static void cnSchedule_RunNode(void* context)
+{
+	CnScheduleNode* node = (CnScheduleNode*)context;
+	CnSchedule* schedule = node->schedule;
+
+	schedule->runSystem(node->systemIndex, schedule->event);
+
+	// Start dependents which were only waiting on this.  They're added to the
+	// running count before this job finishes, so the count can't reach zero
+	// early.
+	uint32_t dependents = node->dependents;
+	for (uint32_t i = 0; dependents != 0; ++i, dependents >>= 1) {
+		if ((dependents & 1) == 0) {
+			continue;
+		}
+		CnScheduleNode* dependent = &schedule->nodes[i];
+		if (cnAtomic_FetchSubU32(&dependent->waitingOn, 1) == 1) {
+			cnJob_Run(cnSchedule_RunNode, dependent, &schedule->running);
+		}
+	}
+}
+
+/**
+ * Ticks every system in the schedule, and returns once they've all finished.
+ */
+void cnSchedule_Run(CnSchedule* schedule, CnSchedule_RunSystemFn runSystem, CnFrameEvent* event)
+{
+	CN_ASSERT_PTR(schedule);
+	CN_ASSERT_PTR(runSystem);
+	CN_ASSERT_PTR(event);
+
+	if (schedule->serial || cnJob_NumThreads() == 1) {
+		for (uint32_t i = 0; i < schedule->numNodes; ++i) {
+			runSystem(schedule->nodes[i].systemIndex, event);
+		}
+		return;
+	}
+
+	schedule->runSystem = runSystem;
+	schedule->event = event;
+	for (uint32_t i = 0; i < schedule->numNodes; ++i) {
+		schedule->nodes[i].waitingOn = schedule->nodes[i].numDependencies;
+	}
+
+	for (uint32_t i = 0; i < schedule->numNodes; ++i) {
+		if (schedule->nodes[i].numDependencies == 0) {
+			cnJob_Run(cnSchedule_RunNode, &schedule->nodes[i], &schedule->running);
+		}
+	}
+	cnJob_Wait(&schedule->running);
+}
+
+bool cnSchedule_IsSerial(const CnSchedule* schedule)
+{
+	CN_ASSERT_PTR(schedule);
+	return schedule->serial;
+}
+
+/**
+ * Whether one system ticks only after another has finished, either directly or
+ * through other systems.
+ */
+bool cnSchedule_DependsOn(const CnSchedule* schedule, uint32_t systemIndex, uint32_t dependencyIndex)
+{
+	CN_ASSERT_PTR(schedule);
+
+	// Every node depends only on earlier nodes, so follow dependents forward
+	// from the dependency in a single pass.
+	uint32_t reachable = 0;
+	for (uint32_t i = 0; i < schedule->numNodes; ++i) {
+		const CnScheduleNode* node = &schedule->nodes[i];
+		if (node->systemIndex == dependencyIndex) {
+			reachable = node->dependents;
+		}
+		else if (reachable & (1u << i)) {
+			if (node->systemIndex == systemIndex) {
+				return true;
+			}
+			reachable |= node->dependents;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,76 @@
+#ifndef CN_SCHEDULE_H
+#define CN_SCHEDULE_H
+
+/**
+ * @file schedule.h
+ *
+ * Orders system ticks by the resources they declare, so systems which don't
+ * depend on each other tick at the same time on the job system.
+ *
+ * A system depends on every system added before it with which it shares a
+ * resource that either writes.  These dependencies form a graph with no
+ * cycles, and each system starts once everything it depends on has finished.
+ * When every system depends on the one before it, such as when none declare
+ * their resources, systems tick one after another on the calling thread.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/behavior.h>
+#include <calendon/job.h>
+#include <calendon/system.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Most systems which can be scheduled, limited by the bits in a mask.
+ */
+#define CN_SCHEDULE_MAX_SYSTEMS 32
+
+/**
+ * Runs a system's tick, given its index in the systems the schedule was built
+ * from.
+ */
+typedef void (*CnSchedule_RunSystemFn)(uint32_t systemIndex, CnFrameEvent* event);
+
+struct CnSchedule;
+
+typedef struct {
+	struct CnSchedule* schedule;
+	uint32_t systemIndex;
+	uint32_t numDependencies;
+
+	/** Bit per node which depends on this node. */
+	uint32_t dependents;
+
+	/** Dependencies not yet finished during a run. */
+	volatile uint32_t waitingOn;
+} CnScheduleNode;
+
+typedef struct CnSchedule {
+	/** Systems which tick, in the order they were added. */
+	CnScheduleNode nodes[CN_SCHEDULE_MAX_SYSTEMS];
+	uint32_t numNodes;
+
+	/** Every node depends on the one before it, so there's no parallelism. */
+	bool serial;
+
+	// State of the current run.
+	CnSchedule_RunSystemFn runSystem;
+	CnFrameEvent* event;
+	CnJobCounter running;
+} CnSchedule;
+
+CN_API void cnSchedule_Build(CnSchedule* schedule, const CnSystem* systems, uint32_t numSystems);
+CN_API void cnSchedule_Run(CnSchedule* schedule, CnSchedule_RunSystemFn runSystem, CnFrameEvent* event);
+
+CN_API bool cnSchedule_IsSerial(const CnSchedule* schedule);
+CN_API bool cnSchedule_DependsOn(const CnSchedule* schedule, uint32_t systemIndex, uint32_t dependencyIndex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_SCHEDULE_H */
@@ -36,7 +36,8 @@ CnBehavior cnSystem_NoBehavior(void)
 
 /**
  * Finds functions with the matching prefix, followed by _FunctionName for each
- * system function type: Name, Init, BeginFrame, Tick, Draw, and EndFrame.
+ * system function type: Name, Init, BeginFrame, Tick, Draw, EndFrame, Shutdown
+ * and Access.
  * e.g. "Physics" would find "Physics_Name", "Physics_Init", "Physics_Tick", etc.
  */
 bool cnSystem_LoadFromSharedLibrary(CnSystem* system, const char* name, CnSharedLibrary library)
@@ -82,5 +83,8 @@ bool cnSystem_LoadFromSharedLibrary(CnSystem* system, const char* name, CnShared
 	cnString_Format(functionNameStart, 256, "_Shutdown");
 	system->shutdown = (CnSystem_ShutdownFn) cnSharedLibrary_LookupFn(library, functionName);
 
+	cnString_Format(functionNameStart, 256, "_Access");
+	system->access = (CnSystem_AccessFn) cnSharedLibrary_LookupFn(library, functionName);
+
 	return true;
 }
@@ -50,6 +50,30 @@ typedef void* (*CnSystem_ConfigFn)(void);
  */
 typedef void (*CnSystem_SetDefaultConfigFn)(void*);
 
+/**
+ * Named resources a system reads and writes while ticking, so systems which
+ * don't touch the same things can tick at the same time on different threads.
+ *
+ * Names are arbitrary strings agreed on between systems, such as "Transforms".
+ * Every system also writes a resource with its own name, so reading another
+ * system's name keeps the two from ticking at the same time.
+ *
+ * Systems which touch a common resource, where at least one writes it, tick in
+ * the order they were added.
+ */
+typedef struct {
+	const char* const* reads;
+	uint32_t numReads;
+	const char* const* writes;
+	uint32_t numWrites;
+} CnSystemAccess;
+
+/**
+ * Describes the resources a system uses.  Systems without this are assumed to
+ * touch everything, so they tick alone and in order.
+ */
+typedef CnSystemAccess (*CnSystem_AccessFn)(void);
+
 /**
  * Provide a command line option list which has no options.
  */
@@ -90,6 +114,11 @@ typedef struct {
 	// Behaviors to be used by the system.
 	CnBehavior behavior;
 
+	/**
+	 * Resources touched by the behavior, may be NULL if undeclared.
+	 */
+	CnSystem_AccessFn access;
+
 	/**
 	 * The library from which this plugin was loaded.  If not loaded from a
 	 * shared library, this might be NULL.
@@ -29,3 +29,8 @@ void cnMain_TickCompleted(void)
 {
 	++totalTicks;
 }
+
+uint64_t cnMain_TicksCompleted(void)
+{
+	return totalTicks;
+}
@@ -10,6 +10,7 @@ extern "C" {
 CN_API bool cnMain_IsTickLimitReached(void);
 CN_API void cnMain_SetTickLimit(uint64_t numTicks);
 CN_API void cnMain_TickCompleted(void);
+CN_API uint64_t cnMain_TicksCompleted(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,248 @@
+#include "tilemap.h"
+
+#include <calendon/cn.h>
+
+#include <math.h>
+#include <string.h>
+
+static uint32_t cnTilemap_Min(uint32_t a, uint32_t b)
+{
+	return a < b ? a : b;
+}
+
+static uint32_t cnTilemap_TileOffset(const CnTilemap* map, uint32_t layer, CnRowColu32 tile)
+{
+	CN_ASSERT(layer < map->numLayers, "Layer %" PRIu32 " is out of range: %" PRIu32,
+		layer, map->numLayers);
+	CN_ASSERT(tile.row < map->sizeInTiles.height && tile.col < map->sizeInTiles.width,
+		"Tile (%" PRIu32 ", %" PRIu32 ") is outside of the tilemap", tile.row, tile.col);
+	return (layer * map->sizeInTiles.height + tile.row) * map->sizeInTiles.width + tile.col;
+}
+
+/**
+ * Creates a tilemap of the given size with every tile of every layer empty.
+ */
+void cnTilemap_Allocate(CnTilemap* map, CnDimension2u32 sizeInTiles, uint32_t numLayers, CnDimension2f tileSize)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(sizeInTiles.width > 0, "Cannot create a tilemap with zero width.");
+	CN_ASSERT(sizeInTiles.height > 0, "Cannot create a tilemap with zero height.");
+	CN_ASSERT(numLayers > 0, "Cannot create a tilemap with no layers.");
+	CN_ASSERT(tileSize.width > 0.0f && tileSize.height > 0.0f, "Tiles must have a positive size.");
+
+	map->sizeInTiles = sizeInTiles;
+	map->sizeInChunks = (CnDimension2u32) {
+		.width = (sizeInTiles.width + CN_TILEMAP_CHUNK_SIZE - 1) / CN_TILEMAP_CHUNK_SIZE,
+		.height = (sizeInTiles.height + CN_TILEMAP_CHUNK_SIZE - 1) / CN_TILEMAP_CHUNK_SIZE
+	};
+	map->tileSize = tileSize;
+	map->origin = cnFloat2_Make(0.0f, 0.0f);
+	map->tilesetGrid = (CnDimension2u32) { .width = 0, .height = 0 };
+	map->numLayers = numLayers;
+
+	const uint32_t numTiles = numLayers * sizeInTiles.width * sizeInTiles.height;
+	cnDynamicBuffer_Allocate(&map->tiles, numTiles * (uint32_t)sizeof(CnTileIndex));
+	memset(map->tiles.contents, 0, map->tiles.size);
+
+	// Every chunk starts dirty, so it gets baked the first time it is visible.
+	const uint32_t numChunks = numLayers * map->sizeInChunks.width * map->sizeInChunks.height;
+	cnDynamicBuffer_Allocate(&map->chunks, numChunks * (uint32_t)sizeof(CnTilemapChunk));
+	CnTilemapChunk* chunks = (CnTilemapChunk*)map->chunks.contents;
+	for (uint32_t i = 0; i < numChunks; ++i) {
+		chunks[i] = (CnTilemapChunk) { .renderBuffer = 0, .numQuads = 0, .dirty = true };
+	}
+}
+
+/**
+ * Releases the CPU side storage of the tilemap.  Renderer resources must be
+ * released first with `cnR_ReleaseTilemap`.
+ */
+void cnTilemap_Free(CnTilemap* map)
+{
+	CN_ASSERT_PTR(map);
+	cnDynamicBuffer_Free(&map->tiles);
+	cnDynamicBuffer_Free(&map->chunks);
+	map->numLayers = 0;
+}
+
+CnTileIndex cnTilemap_Tile(const CnTilemap* map, uint32_t layer, CnRowColu32 tile)
+{
+	CN_ASSERT_PTR(map);
+	const CnTileIndex* tiles = (const CnTileIndex*)map->tiles.contents;
+	return tiles[cnTilemap_TileOffset(map, layer, tile)];
+}
+
+/**
+ * Changes a single tile, marking its chunk for re-baking only if the tile
+ * actually changed.
+ */
+void cnTilemap_SetTile(CnTilemap* map, uint32_t layer, CnRowColu32 tile, CnTileIndex index)
+{
+	CN_ASSERT_PTR(map);
+	CnTileIndex* tiles = (CnTileIndex*)map->tiles.contents;
+	const uint32_t offset = cnTilemap_TileOffset(map, layer, tile);
+	if (tiles[offset] != index) {
+		tiles[offset] = index;
+		cnTilemap_Chunk(map, layer, cnTilemap_ChunkForTile(tile))->dirty = true;
+	}
+}
+
+/**
+ * Sets every tile in a layer to the same index.
+ */
+void cnTilemap_Fill(CnTilemap* map, uint32_t layer, CnTileIndex index)
+{
+	CN_ASSERT_PTR(map);
+	for (uint32_t row = 0; row < map->sizeInTiles.height; ++row) {
+		for (uint32_t col = 0; col < map->sizeInTiles.width; ++col) {
+			cnTilemap_SetTile(map, layer, (CnRowColu32) { row, col }, index);
+		}
+	}
+}
+
+/**
+ * Changes the grid of cells the tileset is divided into, marking every chunk
+ * for re-baking if it changed.
+ */
+void cnTilemap_SetTilesetGrid(CnTilemap* map, CnDimension2u32 tilesetGrid)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(tilesetGrid.width > 0 && tilesetGrid.height > 0, "Tileset grid must be non-empty.");
+	if (map->tilesetGrid.width == tilesetGrid.width && map->tilesetGrid.height == tilesetGrid.height) {
+		return;
+	}
+
+	map->tilesetGrid = tilesetGrid;
+	CnTilemapChunk* chunks = (CnTilemapChunk*)map->chunks.contents;
+	const uint32_t numChunks = map->numLayers * map->sizeInChunks.width * map->sizeInChunks.height;
+	for (uint32_t i = 0; i < numChunks; ++i) {
+		chunks[i].dirty = true;
+	}
+}
+
+CnRowColu32 cnTilemap_ChunkForTile(CnRowColu32 tile)
+{
+	return (CnRowColu32) {
+		.row = tile.row / CN_TILEMAP_CHUNK_SIZE,
+		.col = tile.col / CN_TILEMAP_CHUNK_SIZE
+	};
+}
+
+CnTilemapChunk* cnTilemap_Chunk(CnTilemap* map, uint32_t layer, CnRowColu32 chunk)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT(layer < map->numLayers, "Layer %" PRIu32 " is out of range: %" PRIu32,
+		layer, map->numLayers);
+	CN_ASSERT(chunk.row < map->sizeInChunks.height && chunk.col < map->sizeInChunks.width,
+		"Chunk (%" PRIu32 ", %" PRIu32 ") is outside of the tilemap", chunk.row, chunk.col);
+
+	CnTilemapChunk* chunks = (CnTilemapChunk*)map->chunks.contents;
+	return &chunks[(layer * map->sizeInChunks.height + chunk.row) * map->sizeInChunks.width + chunk.col];
+}
+
+/**
+ * The world space area covered by a chunk.  Chunks on the top and right edges
+ * of the map only cover the tiles which exist.
+ */
+CnAABB2 cnTilemap_ChunkAABB2(const CnTilemap* map, CnRowColu32 chunk)
+{
+	CN_ASSERT_PTR(map);
+	const uint32_t firstRow = chunk.row * CN_TILEMAP_CHUNK_SIZE;
+	const uint32_t firstCol = chunk.col * CN_TILEMAP_CHUNK_SIZE;
+	const uint32_t endRow = cnTilemap_Min(firstRow + CN_TILEMAP_CHUNK_SIZE, map->sizeInTiles.height);
+	const uint32_t endCol = cnTilemap_Min(firstCol + CN_TILEMAP_CHUNK_SIZE, map->sizeInTiles.width);
+
+	return cnAABB2_MakeMinMax(
+		cnFloat2_Make(map->origin.x + firstCol * map->tileSize.width,
+			map->origin.y + firstRow * map->tileSize.height),
+		cnFloat2_Make(map->origin.x + endCol * map->tileSize.width,
+			map->origin.y + endRow * map->tileSize.height));
+}
+
+/**
+ * Finds the inclusive range of chunks which overlap a world space area, such
+ * as the camera.  Returns false if no chunks overlap.
+ */
+bool cnTilemap_ChunksOverlapping(const CnTilemap* map, CnAABB2 area, CnRowColu32* first, CnRowColu32* last)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT_PTR(first);
+	CN_ASSERT_PTR(last);
+
+	const float chunkWidth = map->tileSize.width * CN_TILEMAP_CHUNK_SIZE;
+	const float chunkHeight = map->tileSize.height * CN_TILEMAP_CHUNK_SIZE;
+	const float minCol = floorf((area.min.x - map->origin.x) / chunkWidth);
+	const float maxCol = floorf((area.max.x - map->origin.x) / chunkWidth);
+	const float minRow = floorf((area.min.y - map->origin.y) / chunkHeight);
+	const float maxRow = floorf((area.max.y - map->origin.y) / chunkHeight);
+
+	if (maxCol < 0.0f || maxRow < 0.0f
+		|| minCol >= (float)map->sizeInChunks.width
+		|| minRow >= (float)map->sizeInChunks.height) {
+		return false;
+	}
+
+	first->col = minCol < 0.0f ? 0 : (uint32_t)minCol;
+	first->row = minRow < 0.0f ? 0 : (uint32_t)minRow;
+	last->col = cnTilemap_Min((uint32_t)maxCol, map->sizeInChunks.width - 1);
+	last->row = cnTilemap_Min((uint32_t)maxRow, map->sizeInChunks.height - 1);
+	return true;
+}
+
+/**
+ * Generates 4 vertices for every non-empty tile in a chunk, in triangle strip
+ * order relative to the map's origin, with texture coordinates into the map's
+ * tileset grid.  `vertices` must have room for `CN_TILEMAP_MAX_CHUNK_VERTICES`.
+ *
+ * Returns the number of quads written.
+ */
+uint32_t cnTilemap_BakeChunk(const CnTilemap* map, uint32_t layer, CnRowColu32 chunk,
+	CnTileVertex* vertices)
+{
+	CN_ASSERT_PTR(map);
+	CN_ASSERT_PTR(vertices);
+
+	const CnDimension2u32 tilesetGrid = map->tilesetGrid;
+	CN_ASSERT(tilesetGrid.width > 0 && tilesetGrid.height > 0, "Tileset grid must be set before baking.");
+
+	const float du = 1.0f / tilesetGrid.width;
+	const float dv = 1.0f / tilesetGrid.height;
+	const uint32_t numCells = tilesetGrid.width * tilesetGrid.height;
+
+	const uint32_t firstRow = chunk.row * CN_TILEMAP_CHUNK_SIZE;
+	const uint32_t firstCol = chunk.col * CN_TILEMAP_CHUNK_SIZE;
+	const uint32_t endRow = cnTilemap_Min(firstRow + CN_TILEMAP_CHUNK_SIZE, map->sizeInTiles.height);
+	const uint32_t endCol = cnTilemap_Min(firstCol + CN_TILEMAP_CHUNK_SIZE, map->sizeInTiles.width);
+
+	uint32_t numQuads = 0;
+	for (uint32_t row = firstRow; row < endRow; ++row) {
+		for (uint32_t col = firstCol; col < endCol; ++col) {
+			const CnTileIndex index = cnTilemap_Tile(map, layer, (CnRowColu32) { row, col });
+			if (index == CN_TILE_EMPTY) {
+				continue;
+			}
+
+			const uint32_t cell = (uint32_t)index - 1;
+			CN_ASSERT(cell < numCells, "Tile index %" PRIu32 " is outside the tileset of %"
+				PRIu32 " cells", (uint32_t)index, numCells);
+
+			// Images are flipped on load, so the top row of the tileset is at
+			// the highest texture coordinate.
+			const float u = (cell % tilesetGrid.width) * du;
+			const float v = 1.0f - ((cell / tilesetGrid.width) + 1) * dv;
+
+			const float x = col * map->tileSize.width;
+			const float y = row * map->tileSize.height;
+			const float w = map->tileSize.width;
+			const float h = map->tileSize.height;
+
+			CnTileVertex* quad = &vertices[4 * numQuads];
+			quad[0] = (CnTileVertex) { cnFloat2_Make(x, y),         cnFloat2_Make(u,      v) };
+			quad[1] = (CnTileVertex) { cnFloat2_Make(x + w, y),     cnFloat2_Make(u + du, v) };
+			quad[2] = (CnTileVertex) { cnFloat2_Make(x, y + h),     cnFloat2_Make(u,      v + dv) };
+			quad[3] = (CnTileVertex) { cnFloat2_Make(x + w, y + h), cnFloat2_Make(u + du, v + dv) };
+			++numQuads;
+		}
+	}
+	return numQuads;
+}
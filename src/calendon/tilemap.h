@@ -0,0 +1,123 @@
+#ifndef CN_TILEMAP_H
+#define CN_TILEMAP_H
+
+/**
+ * @file tilemap.h
+ *
+ * Layered grids of tiles, drawn from a tileset sprite.
+ *
+ * Each layer is a compact grid of tile indices addressed by (row, column),
+ * with row 0 at the bottom of the map.  Layers are split into square chunks so
+ * the renderer can bake each chunk into a static vertex buffer once, re-bake it
+ * only when one of its tiles or the tileset grid changes, and skip chunks
+ * outside of the camera.  Chunks are baked relative to the map's origin, so
+ * moving the map doesn't re-bake anything.
+ */
+
+#include <calendon/cn.h>
+
+#include <calendon/dimension.h>
+#include <calendon/math2.h>
+#include <calendon/memory.h>
+#include <calendon/row-col.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The number of tiles across the width and height of a chunk.
+ */
+#define CN_TILEMAP_CHUNK_SIZE 32
+
+/**
+ * Identifies the cell of the tileset to draw for a tile.  Tile index `n`
+ * draws the `n - 1` cell of the tileset, counting left to right, then top to
+ * bottom.
+ */
+typedef uint16_t CnTileIndex;
+
+/**
+ * Tiles with this index are not drawn.
+ */
+#define CN_TILE_EMPTY ((CnTileIndex)0)
+
+/**
+ * A vertex of a baked chunk, relative to the map's origin.
+ */
+typedef struct {
+	CnFloat2 position;
+	CnFloat2 texCoord;
+} CnTileVertex;
+
+/**
+ * The maximum number of vertices produced by baking a single chunk.
+ */
+#define CN_TILEMAP_MAX_CHUNK_VERTICES (4 * CN_TILEMAP_CHUNK_SIZE * CN_TILEMAP_CHUNK_SIZE)
+
+/**
+ * Rendering state for one chunk of a single layer.
+ */
+typedef struct {
+	/** The renderer's handle for the baked vertices, or 0 if not yet baked. */
+	uint32_t renderBuffer;
+
+	/** The number of non-empty tiles in the chunk when it was last baked. */
+	uint32_t numQuads;
+
+	/** Tiles have changed since the chunk was last baked. */
+	bool dirty;
+} CnTilemapChunk;
+
+typedef struct {
+	/** Number of tiles in each layer, with width as columns and height as rows. */
+	CnDimension2u32 sizeInTiles;
+
+	/** Number of chunks needed to cover each layer. */
+	CnDimension2u32 sizeInChunks;
+
+	/** The world space dimensions of a single tile. */
+	CnDimension2f tileSize;
+
+	/**
+	 * The world space position of the lower-left corner of tile (0, 0).  Can
+	 * be changed freely, since it's applied when drawing rather than baked.
+	 */
+	CnFloat2 origin;
+
+	/**
+	 * The cells the tileset is divided into, which baked texture coordinates
+	 * depend on.  Changed with `cnTilemap_SetTilesetGrid`.
+	 */
+	CnDimension2u32 tilesetGrid;
+
+	uint32_t numLayers;
+
+	/** `CnTileIndex` for each layer, stored layer by layer in row-major order. */
+	CnDynamicBuffer tiles;
+
+	/** `CnTilemapChunk` for each layer, stored layer by layer in row-major order. */
+	CnDynamicBuffer chunks;
+} CnTilemap;
+
+CN_API void            cnTilemap_Allocate(CnTilemap* map, CnDimension2u32 sizeInTiles, uint32_t numLayers, CnDimension2f tileSize);
+CN_API void            cnTilemap_Free(CnTilemap* map);
+
+CN_API CnTileIndex     cnTilemap_Tile(const CnTilemap* map, uint32_t layer, CnRowColu32 tile);
+CN_API void            cnTilemap_SetTile(CnTilemap* map, uint32_t layer, CnRowColu32 tile, CnTileIndex index);
+CN_API void            cnTilemap_Fill(CnTilemap* map, uint32_t layer, CnTileIndex index);
+CN_API void            cnTilemap_SetTilesetGrid(CnTilemap* map, CnDimension2u32 tilesetGrid);
+
+CN_API CnRowColu32     cnTilemap_ChunkForTile(CnRowColu32 tile);
+CN_API CnTilemapChunk* cnTilemap_Chunk(CnTilemap* map, uint32_t layer, CnRowColu32 chunk);
+CN_API CnAABB2         cnTilemap_ChunkAABB2(const CnTilemap* map, CnRowColu32 chunk);
+CN_API bool            cnTilemap_ChunksOverlapping(const CnTilemap* map, CnAABB2 area, CnRowColu32* first, CnRowColu32* last);
+
+CN_API uint32_t        cnTilemap_BakeChunk(const CnTilemap* map, uint32_t layer, CnRowColu32 chunk,
+	CnTileVertex* vertices);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CN_TILEMAP_H */
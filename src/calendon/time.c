@@ -34,6 +34,17 @@ uint64_t cnTime_NowNs(void)
 	return ticks.QuadPart;
 }
 
+/**
+ * Windows sleeps in whole milliseconds, and can overshoot by the scheduler
+ * period, so spin for longer.
+ */
+#define CN_TIME_SPIN_NS (2 * 1000 * 1000)
+
+static void cnTime_SleepNs(uint64_t ns)
+{
+	Sleep((DWORD)(ns / (1000 * 1000)));
+}
+
 #else
 
 #include <time.h>
@@ -50,6 +61,16 @@ uint64_t cnTime_NowNs(void)
 	return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + (uint64_t)ts.tv_nsec;
 }
 
+#define CN_TIME_SPIN_NS (1000 * 1000)
+
+static void cnTime_SleepNs(uint64_t ns)
+{
+	struct timespec ts;
+	ts.tv_sec = (time_t)(ns / (1000 * 1000 * 1000));
+	ts.tv_nsec = (long)(ns % (1000 * 1000 * 1000));
+	nanosleep(&ts, NULL);
+}
+
 #endif /* _WIN32 */
 
 uint64_t cnTime_MsToNs(uint64_t ms)
@@ -137,6 +158,26 @@ CnTime cnTime_Min(CnTime left, CnTime right)
 	return cnTime_LessThan(left, right) ? left : right;
 }
 
+/**
+ * Blocks until at least the given time.  Sleeps are only as precise as the
+ * operating system scheduler, so the end of the wait is spent spinning to
+ * avoid waking up late.
+ */
+void cnTime_SleepUntil(CnTime deadline)
+{
+	for (;;) {
+		const uint64_t now = cnTime_NowNs();
+		if (now >= deadline.native) {
+			return;
+		}
+
+		const uint64_t remaining = deadline.native - now;
+		if (remaining > CN_TIME_SPIN_NS) {
+			cnTime_SleepNs(remaining - CN_TIME_SPIN_NS);
+		}
+	}
+}
+
 const char* cnTime_Name(void)
 {
 	return "Time";
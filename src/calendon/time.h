@@ -49,6 +49,8 @@ CN_API float    cnTime_Lerp(CnTime currentDuration, CnTime totalDuration);
 CN_API CnTime   cnTime_Min(CnTime left, CnTime right);
 CN_API CnTime   cnTime_Max(CnTime left, CnTime right);
 
+CN_API void     cnTime_SleepUntil(CnTime deadline);
+
 CN_API uint64_t cnUInt64_SubtractMonotonic(uint64_t left, uint64_t right);
 
 #ifdef __cplusplus
@@ -1,10 +1,35 @@
 #include "ui.h"
 
 #include <calendon/control.h>
+#include <calendon/render.h>
+#include <calendon/replay.h>
 
 SDL_Window* window;
 static uint32_t width, height;
 CnInput lastInput;
+static CnInputEventQueue s_inputEvents;
+
+/**
+ * Events which nothing uses.  Ignoring them keeps them from being queued, so
+ * they don't need to be read and discarded every frame.  Text input events are
+ * sent for every key press by default.
+ */
+static const uint32_t s_ignoredEventTypes[] = {
+	SDL_TEXTEDITING,
+	SDL_TEXTINPUT,
+	SDL_KEYMAPCHANGED,
+	SDL_FINGERDOWN,
+	SDL_FINGERUP,
+	SDL_FINGERMOTION,
+	SDL_DOLLARGESTURE,
+	SDL_DOLLARRECORD,
+	SDL_MULTIGESTURE,
+	SDL_CLIPBOARDUPDATE,
+	SDL_DROPFILE,
+	SDL_DROPTEXT,
+	SDL_DROPBEGIN,
+	SDL_DROPCOMPLETE
+};
 
 /**
  * Create the window for drawing according to the available program
@@ -13,6 +38,10 @@ CnInput lastInput;
 static void cnUI_CreateWindow(const uint32_t w, const uint32_t h)
 {
 	const uint32_t windowInitFlags = SDL_WINDOW_OPENGL;
+
+	// The pixel format is picked when the window is created, so the depth
+	// buffer used to order draws must be requested beforehand.
+	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 	window = SDL_CreateWindow("Calendon", SDL_WINDOWPOS_CENTERED,
 			SDL_WINDOWPOS_CENTERED, (int)w, (int)h, windowInitFlags);
 	if (window == NULL) {
@@ -29,6 +58,11 @@ void cnUI_Init(CnUIInitParams* params)
 		CN_FATAL_ERROR("Unable to init SDL");
 	}
 
+	for (uint32_t i = 0; i < CN_ARRAY_SIZE(s_ignoredEventTypes); ++i) {
+		SDL_EventState(s_ignoredEventTypes[i], SDL_IGNORE);
+	}
+	cnInputEventQueue_Clear(&s_inputEvents);
+
 	CnDimension2u32 resolution = params->resolution;
 	cnUI_CreateWindow(resolution.width, resolution.height);
 	width = resolution.width;
@@ -44,41 +78,186 @@ void cnUI_Shutdown(void)
 }
 
 /**
- * Parses events off of the SDL event queue.
+ * Converts an SDL event timestamp to when the event happened.
+ *
+ * SDL timestamps are milliseconds from SDL's own clock, so the age of the event
+ * on that clock is subtracted from the current time.
+ */
+static CnTime cnUI_EventTime(uint32_t timestamp, uint32_t nowTicks, CnTime now)
+{
+	// Events arriving while the queue is drained can be newer than `nowTicks`.
+	const int32_t ageMs = (int32_t)(nowTicks - timestamp);
+	if (ageMs <= 0) {
+		return now;
+	}
+	return cnTime_SubtractMonotonic(now, cnTime_MakeMilli((uint64_t)ageMs));
+}
+
+/**
+ * Set when a mouse move is applied, so the mouse can be marked still when it
+ * didn't move.
+ */
+static bool s_mouseMoved;
+
+/**
+ * Applies an input event to the latest input state, and queues it for games to
+ * read.  Input comes from here rather than the window system when a recording
+ * is played back.
+ */
+void cnInput_Inject(const CnInputEvent* input)
+{
+	CN_ASSERT_PTR(input);
+
+	switch (input->type) {
+		case CnInputEventKeyDown:
+			cnKeySet_Add(&lastInput.keySet.down, input->key);
+			cnKeySet_Remove(&lastInput.keySet.up, input->key);
+			break;
+		case CnInputEventKeyUp:
+			cnKeySet_Add(&lastInput.keySet.up, input->key);
+			cnKeySet_Remove(&lastInput.keySet.down, input->key);
+			break;
+		case CnInputEventMouseMove:
+			s_mouseMoved = true;
+			cnMouse_Move(&lastInput.mouse, input->x, input->y, input->dx, input->dy);
+			break;
+		default:
+			break;
+	}
+
+	cnInputEventQueue_Push(&s_inputEvents, input);
+}
+
+/**
+ * Parses events off of the SDL event queue, updating the latest input state
+ * and queueing input events for games to read.
+ *
+ * While a recording plays back, input from the window system is ignored so it
+ * can't interfere with the recorded input.
  */
 void cnUI_ProcessWindowEvents(void)
 {
+	const uint32_t nowTicks = SDL_GetTicks();
+	const CnTime now = cnTime_MakeNow();
+	const bool replaying = cnReplay_IsReplaying();
+
 	SDL_Event event;
-	bool mouseMoved = false;
+	s_mouseMoved = false;
+	CnTime earliestInput = cnTime_MakeZero();
 	while (SDL_PollEvent(&event)) {
+		CnInputEvent input = { 0 };
+		input.time = cnUI_EventTime(event.common.timestamp, nowTicks, now);
+
 		switch (event.type) {
 			case SDL_QUIT:
 				cnMain_QueueGracefulShutdown();
-				break;
+				continue;
 			case SDL_KEYDOWN:
-				cnKeySet_Add(&lastInput.keySet.down, event.key.keysym.sym);
-				cnKeySet_Remove(&lastInput.keySet.up, event.key.keysym.sym);
+				input.type = CnInputEventKeyDown;
+				input.key = event.key.keysym.sym;
+				input.repeat = event.key.repeat != 0;
 				break;
 			case SDL_KEYUP:
-				cnKeySet_Add(&lastInput.keySet.up, event.key.keysym.sym);
-				cnKeySet_Remove(&lastInput.keySet.down, event.key.keysym.sym);
+				input.type = CnInputEventKeyUp;
+				input.key = event.key.keysym.sym;
 				break;
+			case SDL_WINDOWEVENT:
+				// The window system might have discarded what was drawn.
+				if (event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+					cnR_RequestRedraw();
+				}
+				continue;
 			case SDL_MOUSEMOTION:
 				// SDL mouse motion is recorded in accordance with an origin in
 				// the top left, so convert to a cartesian coordiante system for
 				// inputs.
-				mouseMoved = true;
-				cnMouse_Move(&lastInput.mouse, event.motion.x, (int32_t) height - event.motion.y, event.motion.xrel,
-							 -event.motion.yrel);
+				input.type = CnInputEventMouseMove;
+				input.x = event.motion.x;
+				input.y = (int32_t)height - event.motion.y;
+				input.dx = event.motion.xrel;
+				input.dy = -event.motion.yrel;
 				break;
-			default:
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+				input.type = event.type == SDL_MOUSEBUTTONDOWN
+					? CnInputEventMouseButtonDown : CnInputEventMouseButtonUp;
+				input.button = event.button.button;
+				input.x = event.button.x;
+				input.y = (int32_t)height - event.button.y;
+				break;
+			case SDL_MOUSEWHEEL:
+				input.type = CnInputEventMouseWheel;
+				input.dx = event.wheel.x;
+				input.dy = event.wheel.y;
 				break;
+			default:
+				continue;
+		}
+
+		if (replaying) {
+			continue;
+		}
+
+		cnReplay_RecordInput(&input);
+		cnInput_Inject(&input);
+		if (cnTime_IsZero(earliestInput) || cnTime_LessThan(input.time, earliestInput)) {
+			earliestInput = input.time;
 		}
 	}
 
-	if (!mouseMoved) {
+	if (!s_mouseMoved) {
 		cnMouse_Still(&lastInput.mouse);
 	}
+
+	// Latency is measured from when the input happened, not when it was read.
+	if (!cnTime_IsZero(earliestInput)) {
+		cnR_ReportInputTime(earliestInput);
+	}
+}
+
+/**
+ * Time before a deadline to stop waiting on events and sleep precisely instead,
+ * since event waits are only accurate to a few milliseconds.
+ */
+#define CN_UI_WAIT_MARGIN_MS 2
+
+/**
+ * Blocks until an event arrives or the deadline passes, without removing the
+ * event from the queue.  Used to idle instead of spinning while waiting for
+ * something to happen.
+ *
+ * Returns true if woken early by an event.
+ */
+bool cnUI_WaitForEventsUntil(CnTime deadline)
+{
+	const uint64_t remainingMs = cnTime_Milli(cnTime_SubtractMonotonic(deadline, cnTime_MakeNow()));
+	if (remainingMs > CN_UI_WAIT_MARGIN_MS) {
+		if (SDL_WaitEventTimeout(NULL, (int)(remainingMs - CN_UI_WAIT_MARGIN_MS))) {
+			return true;
+		}
+	}
+
+	cnTime_SleepUntil(deadline);
+	return false;
+}
+
+/**
+ * Removes the oldest input event not yet read, returning false if there are
+ * none.  Events stay queued until read, so games should read every event each
+ * tick, with the oldest dropped if too many build up.
+ */
+bool cnInput_NextEvent(CnInputEvent* event)
+{
+	CN_ASSERT_PTR(event);
+	return cnInputEventQueue_Pop(&s_inputEvents, event);
+}
+
+/**
+ * Input events lost because they weren't read before the queue filled.
+ */
+uint64_t cnInput_NumDroppedEvents(void)
+{
+	return s_inputEvents.numDropped;
 }
 
 CnInput* cnInput_Poll(void)
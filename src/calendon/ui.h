@@ -9,8 +9,10 @@
 
 #include <calendon/dimension.h>
 #include <calendon/input-button-mapping.h>
+#include <calendon/input-events.h>
 #include <calendon/input-keyset.h>
 #include <calendon/input-mouse.h>
+#include <calendon/time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +35,8 @@ CN_API void cnUI_Shutdown(void);
  */
 CN_API void cnUI_ProcessWindowEvents(void);
 
+CN_API bool cnUI_WaitForEventsUntil(CnTime deadline);
+
 typedef struct {
 	CnKeyInputs keySet;
 	CnMouse mouse;
@@ -43,6 +47,10 @@ typedef struct {
  */
 CN_API CnInput* cnInput_Poll(void);
 
+CN_API bool cnInput_NextEvent(CnInputEvent* event);
+CN_API uint64_t cnInput_NumDroppedEvents(void);
+CN_API void cnInput_Inject(const CnInputEvent* event);
+
 CN_API void cnInput_ApplyButtonMapping(const CnInput* input, CnButtonMapping* mapping);
 
 #ifdef __cplusplus
@@ -37,8 +37,21 @@ CN_GAME_API void Demo_Draw(CnFrameEvent* event)
 CN_GAME_API void Demo_Tick(CnFrameEvent* event)
 {
 	CN_UNUSED(event);
-	CnInput* input = cnInput_Poll();
-	CN_ASSERT(input, "CnInput poll provided a null pointer.");
-	position = cnFloat2_Make((float) input->mouse.x, (float) input->mouse.y);
 
+	// Read every event rather than the latest state, so clicks faster than a
+	// frame are still seen.
+	CnInputEvent input;
+	while (cnInput_NextEvent(&input)) {
+		switch (input.type) {
+			case CnInputEventMouseMove:
+				position = cnFloat2_Make((float) input.x, (float) input.y);
+				break;
+			case CnInputEventMouseButtonDown:
+				CN_TRACE(LogSysSample, "Click at (%d, %d), %" PRIu64 " us ago", input.x, input.y,
+					cnTime_SubtractMonotonic(cnTime_MakeNow(), input.time).native / 1000);
+				break;
+			default:
+				break;
+		}
+	}
 }
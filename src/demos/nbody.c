@@ -0,0 +1,454 @@
+/*
+ * A galaxy of bodies pulling on each other with gravity, used as a benchmark.
+ *
+ * Forces are approximated with a Barnes-Hut quadtree: distant groups of bodies
+ * are treated as a single body at their center of mass, making each tick
+ * O(N log N) instead of O(N^2).  Each body collects the tree nodes it interacts
+ * with into a list, which is then summed four at a time with SSE.  Bodies are
+ * split across threads with the job system.
+ *
+ * Tick times are printed on shutdown.  Nothing needs the renderer except
+ * drawing, so for repeatable numbers run headless with a fixed tick size and
+ * tick limit, e.g.
+ *
+ *   calendon-driver --headless --sim-dt 16 --tick-limit 500 -g libnbody.so
+ */
+#include <calendon/cn.h>
+#include <calendon/histogram.h>
+#include <calendon/job.h>
+#include <calendon/log.h>
+#include <calendon/math2.h>
+#include <calendon/memory.h>
+#include <calendon/particles.h>
+#include <calendon/render.h>
+#include <calendon/time.h>
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define NBODY_SSE 1
+	#include <xmmintrin.h>
+#else
+	#define NBODY_SSE 0
+#endif
+
+CnLogHandle LogSysSample;
+
+#define NUM_BODIES 20000
+
+/**
+ * Nodes smaller than this fraction of their distance are treated as a single
+ * body.  Smaller is more accurate, but slower.
+ */
+#define THETA 0.5f
+
+/**
+ * Prevents bodies passing close to each other from being flung apart.
+ */
+#define SOFTENING 2.0f
+
+#define GRAVITATIONAL_CONSTANT 1.0f
+#define CENTRAL_MASS 1000000.0f
+#define BODY_MASS 1.0f
+#define GALAXY_RADIUS 300.0f
+
+/**
+ * Bodies at the same position would be split forever, so nodes this deep hold
+ * every body which lands in them.
+ */
+#define MAX_TREE_DEPTH 24
+
+#define MAX_TREE_NODES (8 * NUM_BODIES)
+
+/**
+ * Interactions gathered before being summed.
+ */
+#define MAX_INTERACTIONS 1024
+
+/**
+ * Bodies processed by each job.
+ */
+#define BODIES_PER_JOB 256
+
+enum {
+	NodeEmpty = -1,
+
+	/** A leaf at maximum depth holding more than one body. */
+	NodeCluster = -2
+};
+
+typedef struct {
+	CnAABB2 bounds;
+
+	/** Sums of mass and mass-weighted positions, then the center of mass. */
+	float mass;
+	float comX;
+	float comY;
+
+	/** Index of the first of four children, or negative for a leaf. */
+	int32_t firstChild;
+
+	/** Body index for leaves with one body, or a NodeEmpty or NodeCluster. */
+	int32_t body;
+} TreeNode;
+
+/**
+ * Positions, velocities and colors are kept as particles so they can be drawn
+ * directly.  The rest of each body is kept in matching arrays.
+ */
+static CnParticles bodies;
+static CnDynamicBuffer extraStorage;
+static float* mass;
+static float* ax;
+static float* ay;
+
+static TreeNode* nodes;
+static uint32_t numNodes;
+
+static CnHistogram buildTimes;
+static CnHistogram forceTimes;
+static CnHistogram tickTimes;
+
+/**
+ * Xorshift random number generator, returning a value in [0, 1).
+ */
+static float randomFloat(uint32_t* seed)
+{
+	uint32_t x = *seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*seed = x;
+	return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Spreads bodies in a disk around a heavy center, each on a roughly circular
+ * orbit.
+ */
+static void createGalaxy(void)
+{
+	const CnFloat2 center = cnFloat2_Make(512.0f, 384.0f);
+	uint32_t seed = 12345;
+
+	cnParticles_Spawn(&bodies, center, cnFloat2_Make(0.0f, 0.0f), INFINITY,
+		(CnRGBA8u) { 255, 240, 200, 255 });
+	mass[0] = CENTRAL_MASS;
+
+	for (uint32_t i = 1; i < NUM_BODIES; ++i) {
+		// Square root spreads bodies evenly over the area of the disk.
+		const float r = 20.0f + (GALAXY_RADIUS - 20.0f) * sqrtf(randomFloat(&seed));
+		const float angle = 2.0f * 3.14159265f * randomFloat(&seed);
+		const float c = cosf(angle);
+		const float s = sinf(angle);
+		const float speed = sqrtf(GRAVITATIONAL_CONSTANT * CENTRAL_MASS / r);
+
+		const uint8_t blue = (uint8_t)(155 + 100 * (r / GALAXY_RADIUS));
+		cnParticles_Spawn(&bodies,
+			cnFloat2_Make(center.x + r * c, center.y + r * s),
+			cnFloat2_Make(-speed * s, speed * c),
+			INFINITY, (CnRGBA8u) { 120, 160, blue, 255 });
+		mass[i] = BODY_MASS;
+	}
+}
+
+static uint32_t allocateChildren(CnAABB2 parent)
+{
+	const uint32_t first = numNodes;
+	numNodes += 4;
+
+	const CnFloat2 mid = cnAABB2_Center(parent);
+	const CnAABB2 quadrants[4] = {
+		cnAABB2_MakeMinMax(parent.min, mid),
+		cnAABB2_MakeMinMax(cnFloat2_Make(mid.x, parent.min.y), cnFloat2_Make(parent.max.x, mid.y)),
+		cnAABB2_MakeMinMax(cnFloat2_Make(parent.min.x, mid.y), cnFloat2_Make(mid.x, parent.max.y)),
+		cnAABB2_MakeMinMax(mid, parent.max)
+	};
+	for (uint32_t i = 0; i < 4; ++i) {
+		nodes[first + i] = (TreeNode) {
+			.bounds = quadrants[i],
+			.firstChild = NodeEmpty,
+			.body = NodeEmpty
+		};
+	}
+	return first;
+}
+
+static uint32_t childFor(const TreeNode* node, uint32_t body)
+{
+	const CnFloat2 mid = cnAABB2_Center(node->bounds);
+	const uint32_t right = bodies.x[body] >= mid.x ? 1 : 0;
+	const uint32_t top = bodies.y[body] >= mid.y ? 2 : 0;
+	return (uint32_t)node->firstChild + right + top;
+}
+
+static void addMass(TreeNode* node, uint32_t body)
+{
+	node->mass += mass[body];
+	node->comX += mass[body] * bodies.x[body];
+	node->comY += mass[body] * bodies.y[body];
+}
+
+static void insertBody(uint32_t body)
+{
+	TreeNode* node = &nodes[0];
+	for (uint32_t depth = 0; ; ++depth) {
+		addMass(node, body);
+		if (node->firstChild >= 0) {
+			node = &nodes[childFor(node, body)];
+			continue;
+		}
+
+		if (node->body == NodeEmpty) {
+			node->body = (int32_t)body;
+			return;
+		}
+
+		if (depth == MAX_TREE_DEPTH || numNodes + 4 > MAX_TREE_NODES) {
+			node->body = NodeCluster;
+			return;
+		}
+
+		// Split the leaf, moving its body down into a child.
+		const uint32_t existing = (uint32_t)node->body;
+		node->body = NodeEmpty;
+		node->firstChild = (int32_t)allocateChildren(node->bounds);
+		TreeNode* moved = &nodes[childFor(node, existing)];
+		addMass(moved, existing);
+		moved->body = (int32_t)existing;
+
+		node = &nodes[childFor(node, body)];
+	}
+}
+
+static void buildTree(void)
+{
+	CnAABB2 bounds = cnAABB2_MakeMinMax(cnFloat2_Make(bodies.x[0], bodies.y[0]),
+		cnFloat2_Make(bodies.x[0], bodies.y[0]));
+	for (uint32_t i = 1; i < bodies.count; ++i) {
+		bounds = cnAABB2_IncludePoint(bounds, cnFloat2_Make(bodies.x[i], bodies.y[i]));
+	}
+
+	// Square nodes keep the opening test the same in both directions.
+	const float size = fmaxf(cnAABB2_Width(bounds), cnAABB2_Height(bounds)) + 1.0f;
+	bounds.max = cnFloat2_Make(bounds.min.x + size, bounds.min.y + size);
+
+	numNodes = 1;
+	nodes[0] = (TreeNode) { .bounds = bounds, .firstChild = NodeEmpty, .body = NodeEmpty };
+	for (uint32_t i = 0; i < bodies.count; ++i) {
+		insertBody(i);
+	}
+
+	for (uint32_t i = 0; i < numNodes; ++i) {
+		if (nodes[i].mass > 0.0f) {
+			nodes[i].comX /= nodes[i].mass;
+			nodes[i].comY /= nodes[i].mass;
+		}
+	}
+}
+
+/**
+ * Point masses which pull on a body.
+ */
+typedef struct {
+	float x[MAX_INTERACTIONS];
+	float y[MAX_INTERACTIONS];
+	float mass[MAX_INTERACTIONS];
+	uint32_t count;
+} Interactions;
+
+/**
+ * Sums the acceleration from every interaction, then empties the list.
+ */
+static void accumulate(Interactions* list, float px, float py, float* outAx, float* outAy)
+{
+	const float eps2 = SOFTENING * SOFTENING;
+	uint32_t i = 0;
+	float sumX = 0.0f;
+	float sumY = 0.0f;
+
+#if NBODY_SSE
+	{
+		const __m128 px4 = _mm_set1_ps(px);
+		const __m128 py4 = _mm_set1_ps(py);
+		const __m128 eps4 = _mm_set1_ps(eps2);
+		const __m128 one = _mm_set1_ps(1.0f);
+		__m128 sumX4 = _mm_setzero_ps();
+		__m128 sumY4 = _mm_setzero_ps();
+		for (; i + 4 <= list->count; i += 4) {
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&list->x[i]), px4);
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&list->y[i]), py4);
+			const __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), eps4);
+			const __m128 invR = _mm_div_ps(one, _mm_sqrt_ps(r2));
+			const __m128 invR3 = _mm_mul_ps(invR, _mm_mul_ps(invR, invR));
+			const __m128 strength = _mm_mul_ps(_mm_loadu_ps(&list->mass[i]), invR3);
+			sumX4 = _mm_add_ps(sumX4, _mm_mul_ps(dx, strength));
+			sumY4 = _mm_add_ps(sumY4, _mm_mul_ps(dy, strength));
+		}
+
+		float lanes[4];
+		_mm_storeu_ps(lanes, sumX4);
+		sumX = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+		_mm_storeu_ps(lanes, sumY4);
+		sumY = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+#endif
+
+	for (; i < list->count; ++i) {
+		const float dx = list->x[i] - px;
+		const float dy = list->y[i] - py;
+		const float invR = 1.0f / sqrtf(dx * dx + dy * dy + eps2);
+		const float strength = list->mass[i] * invR * invR * invR;
+		sumX += dx * strength;
+		sumY += dy * strength;
+	}
+
+	*outAx += GRAVITATIONAL_CONSTANT * sumX;
+	*outAy += GRAVITATIONAL_CONSTANT * sumY;
+	list->count = 0;
+}
+
+static void addInteraction(Interactions* list, const TreeNode* node, float px, float py,
+	float* outAx, float* outAy)
+{
+	if (list->count == MAX_INTERACTIONS) {
+		accumulate(list, px, py, outAx, outAy);
+	}
+	list->x[list->count] = node->comX;
+	list->y[list->count] = node->comY;
+	list->mass[list->count] = node->mass;
+	++list->count;
+}
+
+/**
+ * Walks the tree from the root, opening nodes which are too close to treat as
+ * a single body.
+ */
+static void computeForce(uint32_t body, Interactions* list)
+{
+	const float px = bodies.x[body];
+	const float py = bodies.y[body];
+	float sumX = 0.0f;
+	float sumY = 0.0f;
+
+	uint32_t stack[4 * MAX_TREE_DEPTH + 4];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0) {
+		const TreeNode* node = &nodes[stack[--stackSize]];
+		if (node->mass == 0.0f || node->body == (int32_t)body) {
+			continue;
+		}
+
+		if (node->firstChild < 0) {
+			addInteraction(list, node, px, py, &sumX, &sumY);
+			continue;
+		}
+
+		const float dx = node->comX - px;
+		const float dy = node->comY - py;
+		const float width = cnAABB2_Width(node->bounds);
+		if (width * width < THETA * THETA * (dx * dx + dy * dy)) {
+			addInteraction(list, node, px, py, &sumX, &sumY);
+		}
+		else {
+			for (int32_t i = 0; i < 4; ++i) {
+				stack[stackSize++] = (uint32_t)(node->firstChild + i);
+			}
+		}
+	}
+	accumulate(list, px, py, &sumX, &sumY);
+
+	ax[body] = sumX;
+	ay[body] = sumY;
+}
+
+static void computeForces(uint32_t begin, uint32_t end, void* context)
+{
+	CN_UNUSED(context);
+
+	Interactions list;
+	list.count = 0;
+	for (uint32_t i = begin; i < end; ++i) {
+		computeForce(i, &list);
+	}
+}
+
+CN_GAME_API bool Demo_Init(void)
+{
+	LogSysSample = cnLog_RegisterSystem("Sample");
+	cnLog_SetVerbosity(LogSysSample, CnLogVerbosityTrace);
+	CN_TRACE(LogSysSample, "Sample loaded");
+
+	cnParticles_Allocate(&bodies, NUM_BODIES);
+	cnDynamicBuffer_Allocate(&extraStorage, 3 * NUM_BODIES * sizeof(float)
+		+ MAX_TREE_NODES * sizeof(TreeNode));
+	mass = (float*)extraStorage.contents;
+	ax = mass + NUM_BODIES;
+	ay = ax + NUM_BODIES;
+	nodes = (TreeNode*)(ay + NUM_BODIES);
+
+	cnHistogram_Clear(&buildTimes);
+	cnHistogram_Clear(&forceTimes);
+	cnHistogram_Clear(&tickTimes);
+
+	createGalaxy();
+	return true;
+}
+
+static void printTimes(const char* name, const CnHistogram* h)
+{
+	cnPrint("  %-8s p50 %8.1f us   p90 %8.1f us   p99 %8.1f us   max %8.1f us\n", name,
+		cnHistogram_Percentile(h, 50.0) / 1000.0,
+		cnHistogram_Percentile(h, 90.0) / 1000.0,
+		cnHistogram_Percentile(h, 99.0) / 1000.0,
+		h->max / 1000.0);
+}
+
+CN_GAME_API void Demo_Shutdown(void)
+{
+	cnPrint("N-body: %d bodies, %" PRIu32 " threads, %" PRIu64 " ticks, %s\n",
+		NUM_BODIES, cnJob_NumThreads(), tickTimes.numValues, NBODY_SSE ? "SSE" : "scalar");
+	printTimes("build", &buildTimes);
+	printTimes("forces", &forceTimes);
+	printTimes("tick", &tickTimes);
+
+	cnDynamicBuffer_Free(&extraStorage);
+	cnParticles_Free(&bodies);
+}
+
+CN_GAME_API void Demo_Draw(CnFrameEvent* event)
+{
+	CN_UNUSED(event);
+	cnR_StartFrame();
+
+	cnR_DrawParticles(&bodies, 1.0f);
+	cnR_EndFrame();
+}
+
+CN_GAME_API void Demo_Tick(CnFrameEvent* event)
+{
+	CN_ASSERT_PTR(event);
+
+	// Large steps make close orbits unstable.
+	const float dt = fminf(cnTime_Milli(event->dt) / 1000.0f, 1.0f / 30.0f);
+
+	const CnTime start = cnTime_MakeNow();
+	buildTree();
+	const CnTime built = cnTime_MakeNow();
+	cnJob_ParallelFor(bodies.count, BODIES_PER_JOB, computeForces, NULL);
+	const CnTime forced = cnTime_MakeNow();
+
+	for (uint32_t i = 0; i < bodies.count; ++i) {
+		bodies.vx[i] += ax[i] * dt;
+		bodies.vy[i] += ay[i] * dt;
+		bodies.x[i] += bodies.vx[i] * dt;
+		bodies.y[i] += bodies.vy[i] * dt;
+	}
+	const CnTime end = cnTime_MakeNow();
+
+	cnHistogram_Record(&buildTimes, cnTime_SubtractMonotonic(built, start).native);
+	cnHistogram_Record(&forceTimes, cnTime_SubtractMonotonic(forced, built).native);
+	cnHistogram_Record(&tickTimes, cnTime_SubtractMonotonic(end, start).native);
+}
@@ -0,0 +1,72 @@
+/*
+ * A demo of a fountain of particles, showing the cost of updating them.
+ */
+#include <calendon/cn.h>
+#include <calendon/assets.h>
+#include <calendon/log.h>
+#include <calendon/particles.h>
+#include <calendon/path.h>
+#include <calendon/render.h>
+#include <calendon/time.h>
+
+CnLogHandle LogSysSample;
+
+CnFontId font;
+
+#define MAX_PARTICLES (1024 * 1024)
+static CnParticleEmitter emitter;
+static CnTime lastUpdateTime;
+
+CN_GAME_API bool Demo_Init(void)
+{
+	LogSysSample = cnLog_RegisterSystem("Sample");
+	cnLog_SetVerbosity(LogSysSample, CnLogVerbosityTrace);
+	CN_TRACE(LogSysSample, "Sample loaded");
+
+	CnPathBuffer fontPath;
+	cnAssets_PathBufferFor("fonts/bizcat.psf", &fontPath);
+	cnR_CreateFont(&font);
+	if (!cnR_LoadPSF2Font(font, fontPath.str))	{
+		CN_FATAL_ERROR("Unable to load font: %s", fontPath.str);
+	}
+
+	cnParticleEmitter_Allocate(&emitter, MAX_PARTICLES);
+	emitter.position = cnFloat2_Make(512.0f, 100.0f);
+	emitter.acceleration = cnFloat2_Make(0.0f, -200.0f);
+	emitter.velocityRange = cnAABB2_MakeMinMax(cnFloat2_Make(-150.0f, 300.0f),
+		cnFloat2_Make(150.0f, 550.0f));
+	emitter.minLifetime = 2.0f;
+	emitter.maxLifetime = 4.0f;
+	emitter.rate = 250000.0f;
+	emitter.color = (CnRGBA8u) { 100, 180, 255, 255 };
+	return true;
+}
+
+CN_GAME_API void Demo_Shutdown(void)
+{
+	cnParticleEmitter_Free(&emitter);
+}
+
+CN_GAME_API void Demo_Draw(CnFrameEvent* event)
+{
+	CN_UNUSED(event);
+	cnR_StartFrame();
+
+	cnR_DrawParticles(&emitter.particles, 1.0f);
+
+	char status[100];
+	cnString_Format(status, 100, "%" PRIu32 " particles: %" PRIu64 " us",
+		emitter.particles.count, lastUpdateTime.native / 1000);
+	cnR_DrawSimpleText(font, cnFloat2_Make(0, 0), "Particles demo");
+	cnR_DrawSimpleText(font, cnFloat2_Make(0, 50), status);
+	cnR_EndFrame();
+}
+
+CN_GAME_API void Demo_Tick(CnFrameEvent* event)
+{
+	CN_ASSERT_PTR(event);
+
+	const CnTime start = cnTime_MakeNow();
+	cnParticleEmitter_Update(&emitter, cnTime_Milli(event->dt) / 1000.0f);
+	lastUpdateTime = cnTime_SubtractMonotonic(cnTime_MakeNow(), start);
+}
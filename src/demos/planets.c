@@ -10,6 +10,8 @@
 #include <calendon/render-resources.h>
 #include <calendon/time.h>
 
+#include <string.h>
+
 CnLogHandle LogSysSample;
 
 CnFontId font;
@@ -17,6 +19,9 @@ static CnTime lastDt;
 
 typedef struct {
 	CnFloat2 position;
+
+	/** Position before the last tick, to draw between ticks. */
+	CnFloat2 previousPosition;
 	CnFloat2 velocity;
 	float mass;
 	float radius;
@@ -61,15 +66,69 @@ CN_GAME_API bool Demo_Init(void)
 	bodies[3].mass = 5.0f;
 	bodies[3].velocity = cnFloat2_Make(0.0f, 0.13f);
 	bodies[3].radius = 5.0f;
+
+	for (uint32_t i = 0; i < NUM_PLANETS; ++i) {
+		bodies[i].previousPosition = bodies[i].position;
+	}
 	return true;
 }
 
+/**
+ * Bump when CelestialBody changes in a way which keeps its size, so state
+ * saved by an older build isn't read as the new layout.
+ */
+#define BODIES_STATE_VERSION 1
+
+/**
+ * Written before the saved bodies, and never changed, so any build can tell
+ * whether it can read the state.
+ */
+typedef struct {
+	uint32_t version;
+	uint32_t size;
+} BodiesStateHeader;
+
+/**
+ * Keeps the planets where they are when the demo is rebuilt with --hot-reload.
+ * The saved state is heap allocated, since this library is unloaded before the
+ * new one gets it.
+ */
+CN_GAME_API void* Demo_PreReload(void)
+{
+	BodiesStateHeader* saved = malloc(sizeof(BodiesStateHeader) + sizeof(bodies));
+	if (saved) {
+		saved->version = BODIES_STATE_VERSION;
+		saved->size = sizeof(bodies);
+		memcpy(saved + 1, bodies, sizeof(bodies));
+	}
+	return saved;
+}
+
+CN_GAME_API void Demo_PostReload(void* state)
+{
+	if (!state) {
+		return;
+	}
+
+	const BodiesStateHeader* saved = (const BodiesStateHeader*)state;
+	if (saved->version == BODIES_STATE_VERSION && saved->size == sizeof(bodies)) {
+		memcpy(bodies, saved + 1, sizeof(bodies));
+	}
+	else {
+		CN_WARN(LogSysSample, "Planets changed layout, starting over.");
+	}
+	free(state);
+}
+
 CN_GAME_API void Demo_Draw(CnFrameEvent* event)
 {
 	cnR_StartFrame();
 
+	CN_ASSERT_PTR(event);
 	for (uint32_t bodyIndex = 0; bodyIndex < NUM_PLANETS; ++bodyIndex) {
-		cnR_OutlineCircle(bodies[bodyIndex].position, bodies[bodyIndex].radius, bodies[bodyIndex].color, 20);
+		const CnFloat2 position = cnFloat2_Lerp(bodies[bodyIndex].previousPosition,
+			bodies[bodyIndex].position, event->alpha);
+		cnR_OutlineCircle(position, bodies[bodyIndex].radius, bodies[bodyIndex].color, 20);
 	}
 
 	static char frameTime[100] = "";
@@ -120,6 +179,7 @@ CN_GAME_API void Demo_Tick(CnFrameEvent* event)
 	}
 
 	for (uint32_t i = 0; i < NUM_PLANETS; ++i) {
+		bodies[i].previousPosition = bodies[i].position;
 		bodies[i].position = cnFloat2_Add(bodies[i].position, cnFloat2_Multiply(bodies[i].velocity, (float)ms));
 	}
 }
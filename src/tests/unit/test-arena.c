@@ -0,0 +1,59 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/memory.h>
+
+CN_TEST_SUITE_BEGIN("arena")
+	CN_TEST_UNIT("Allocations are aligned and don't overlap.") {
+		CnArena arena;
+		cnArena_Allocate(&arena, 1024);
+
+		uint8_t* a = cnArena_Alloc(&arena, 3, 1);
+		uint8_t* b = cnArena_Alloc(&arena, 8, 8);
+		uint8_t* c = cnArena_Alloc(&arena, 64, 64);
+		CN_TEST_ASSERT_TRUE(a != NULL && b != NULL && c != NULL);
+		CN_TEST_ASSERT_EQ_U64(0, (uintptr_t)b % 8);
+		CN_TEST_ASSERT_EQ_U64(0, (uintptr_t)c % 64);
+		CN_TEST_ASSERT_TRUE(a + 3 <= b);
+		CN_TEST_ASSERT_TRUE(b + 8 <= c);
+
+		cnArena_Free(&arena);
+	}
+
+	CN_TEST_UNIT("A full arena returns NULL until reset.") {
+		CnArena arena;
+		cnArena_Allocate(&arena, 256);
+
+		CN_TEST_ASSERT_TRUE(cnArena_Alloc(&arena, 200, 1) != NULL);
+		CN_TEST_ASSERT_TRUE(cnArena_Alloc(&arena, 100, 1) == NULL);
+
+		cnArena_Reset(&arena);
+		CN_TEST_ASSERT_EQ_U32(200, arena.peak);
+		CN_TEST_ASSERT_TRUE(cnArena_Alloc(&arena, 256, 1) == (void*)arena.buffer.contents);
+
+		cnArena_Free(&arena);
+	}
+
+	CN_TEST_UNIT("Frame arena allocations last until the end of the next frame.") {
+		cnFrameArena_Init(1024);
+
+		uint32_t* first = cnFrameArena_Alloc(sizeof(uint32_t), sizeof(uint32_t));
+		*first = 0xC0FFEE;
+		cnFrameArena_EndFrame();
+
+		// The next frame uses the other half, so the first frame's data
+		// survives.
+		uint32_t* second = cnFrameArena_Alloc(sizeof(uint32_t), sizeof(uint32_t));
+		*second = 0xBEEF;
+		CN_TEST_ASSERT_TRUE(first != second);
+		CN_TEST_ASSERT_EQ_U32(0xC0FFEE, *first);
+		cnFrameArena_EndFrame();
+
+		// Two frames later, the first frame's memory is reused.
+		uint32_t* third = cnFrameArena_Alloc(sizeof(uint32_t), sizeof(uint32_t));
+		CN_TEST_ASSERT_TRUE(third == first);
+		CN_TEST_ASSERT_EQ_U32(0xBEEF, *second);
+
+		cnFrameArena_Shutdown();
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,30 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/color.h>
+
+CN_TEST_SUITE_BEGIN("color")
+	CN_TEST_UNIT("Opaque colors pack to 8 bit channels.") {
+		const CnRGBA8u packed = cnOpaqueColor_ToRGBA8u(cnOpaqueColor_MakeRGBf(0.0f, 0.5f, 1.0f));
+		CN_TEST_ASSERT_EQ_U32(0, packed.red);
+		CN_TEST_ASSERT_EQ_U32(128, packed.green);
+		CN_TEST_ASSERT_EQ_U32(255, packed.blue);
+		CN_TEST_ASSERT_EQ_U32(255, packed.alpha);
+	}
+
+	CN_TEST_UNIT("Packing roundtrips 8 bit colors.") {
+		for (uint32_t i = 0; i < 256; ++i) {
+			const uint8_t c = (uint8_t)i;
+			const CnRGBA8u packed = cnOpaqueColor_ToRGBA8u(cnOpaqueColor_MakeRGBu8(c, c, c));
+			CN_TEST_ASSERT_EQ_U32(c, packed.red);
+			CN_TEST_ASSERT_EQ_U32(c, packed.green);
+			CN_TEST_ASSERT_EQ_U32(c, packed.blue);
+		}
+	}
+
+	CN_TEST_UNIT("Out of range channels are clamped.") {
+		const CnRGBA8u packed = cnOpaqueColor_ToRGBA8u(cnOpaqueColor_MakeRGBf(-1.0f, 2.0f, 1.0f));
+		CN_TEST_ASSERT_EQ_U32(0, packed.red);
+		CN_TEST_ASSERT_EQ_U32(255, packed.green);
+	}
+CN_TEST_SUITE_END
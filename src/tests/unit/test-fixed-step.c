@@ -0,0 +1,58 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/fixed-step.h>
+
+static const CnTime step = { .native = 10000000 };
+
+CN_TEST_SUITE_BEGIN("fixed step")
+	CN_TEST_UNIT("Cannot use a zero step.") {
+		CnFixedStep fs;
+		CN_TEST_PRECONDITION(cnFixedStep_Init(&fs, cnTime_MakeZero(), 5));
+	}
+
+	CN_TEST_UNIT("Elapsed time is divided into whole steps.") {
+		CnFixedStep fs;
+		cnFixedStep_Init(&fs, step, 5);
+		CN_TEST_ASSERT_EQ_U32(0, cnFixedStep_Advance(&fs, (CnTime) { .native = step.native / 2 }));
+		CN_TEST_ASSERT_EQ_U32(1, cnFixedStep_Advance(&fs, step));
+		CN_TEST_ASSERT_EQ_U32(3, cnFixedStep_Advance(&fs, (CnTime) { .native = 3 * step.native }));
+	}
+
+	CN_TEST_UNIT("Partial steps carry over into the next frame.") {
+		CnFixedStep fs;
+		cnFixedStep_Init(&fs, step, 5);
+		const CnTime threeQuarters = { .native = 3 * step.native / 4 };
+		CN_TEST_ASSERT_EQ_U32(0, cnFixedStep_Advance(&fs, threeQuarters));
+		CN_TEST_ASSERT_CLOSE_F(0.75f, cnFixedStep_Alpha(&fs), 0.0001f);
+		CN_TEST_ASSERT_EQ_U32(1, cnFixedStep_Advance(&fs, threeQuarters));
+		CN_TEST_ASSERT_CLOSE_F(0.5f, cnFixedStep_Alpha(&fs), 0.0001f);
+	}
+
+	CN_TEST_UNIT("Steps are the same regardless of frame times.") {
+		CnFixedStep uneven;
+		CnFixedStep even;
+		cnFixedStep_Init(&uneven, step, 5);
+		cnFixedStep_Init(&even, step, 5);
+
+		const uint64_t frameTimes[] = { 3000000, 17000000, 9000000, 1000000, 20000000 };
+		uint32_t unevenSteps = 0;
+		uint64_t total = 0;
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(frameTimes); ++i) {
+			unevenSteps += cnFixedStep_Advance(&uneven, (CnTime) { .native = frameTimes[i] });
+			total += frameTimes[i];
+		}
+		const uint32_t evenSteps = cnFixedStep_Advance(&even, (CnTime) { .native = total });
+		CN_TEST_ASSERT_EQ_U32(evenSteps, unevenSteps);
+		CN_TEST_ASSERT_EQ_U64(even.accumulated.native, uneven.accumulated.native);
+	}
+
+	CN_TEST_UNIT("Catching up is limited and the rest of the time is dropped.") {
+		CnFixedStep fs;
+		cnFixedStep_Init(&fs, step, 4);
+		const CnTime longFrame = { .native = 100 * step.native + step.native / 4 };
+		CN_TEST_ASSERT_EQ_U32(4, cnFixedStep_Advance(&fs, longFrame));
+		CN_TEST_ASSERT_CLOSE_F(0.25f, cnFixedStep_Alpha(&fs), 0.0001f);
+		CN_TEST_ASSERT_EQ_U32(1, cnFixedStep_Advance(&fs, step));
+	}
+CN_TEST_SUITE_END
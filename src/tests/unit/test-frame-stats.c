@@ -0,0 +1,93 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/frame-stats.h>
+
+CN_TEST_SUITE_BEGIN("frame stats")
+	CN_TEST_UNIT("Recent times wrap around, keeping the latest.") {
+		cnFrameStats_Clear();
+		cnFrameStats_SetSystemName(0, "Physics");
+		const CnPhaseTimes* times = cnFrameStats_SystemPhaseAt(0, CnFramePhaseTick);
+
+		for (uint32_t i = 0; i < CN_FRAME_STATS_RECENT; ++i) {
+			cnFrameStats_RecordSystem(0, CnFramePhaseTick, cnTime_MakeMilli(1));
+		}
+		CN_TEST_ASSERT_EQ_U32(0, times->nextRecent);
+		CN_TEST_ASSERT_EQ_U64(1, cnTime_Milli(cnPhaseTimes_RecentMean(times)));
+
+		// The oldest quarter is replaced.
+		for (uint32_t i = 0; i < CN_FRAME_STATS_RECENT / 4; ++i) {
+			cnFrameStats_RecordSystem(0, CnFramePhaseTick, cnTime_MakeMilli(5));
+		}
+		CN_TEST_ASSERT_EQ_U32(CN_FRAME_STATS_RECENT / 4, times->nextRecent);
+		CN_TEST_ASSERT_EQ_U64(2, cnTime_Milli(cnPhaseTimes_RecentMean(times)));
+
+		// All time stats still cover every call.
+		CN_TEST_ASSERT_EQ_U64(CN_FRAME_STATS_RECENT + CN_FRAME_STATS_RECENT / 4, times->numCalls);
+		CN_TEST_ASSERT_EQ_U64(1800000, cnPhaseTimes_Mean(times).native);
+		CN_TEST_ASSERT_EQ_U64(5, cnTime_Milli(cnPhaseTimes_Max(times)));
+
+		for (uint32_t i = 0; i < CN_FRAME_STATS_RECENT * 3 / 4; ++i) {
+			cnFrameStats_RecordSystem(0, CnFramePhaseTick, cnTime_MakeMilli(5));
+		}
+		CN_TEST_ASSERT_EQ_U32(0, times->nextRecent);
+		CN_TEST_ASSERT_EQ_U64(5, cnTime_Milli(cnPhaseTimes_RecentMean(times)));
+	}
+
+	CN_TEST_UNIT("Fewer times than fit average only those recorded.") {
+		cnFrameStats_Clear();
+		cnFrameStats_SetSystemName(0, "Physics");
+		const CnPhaseTimes* times = cnFrameStats_SystemPhaseAt(0, CnFramePhaseDraw);
+
+		CN_TEST_ASSERT_EQ_U64(0, cnPhaseTimes_RecentMean(times).native);
+		cnFrameStats_RecordSystem(0, CnFramePhaseDraw, cnTime_MakeMilli(2));
+		cnFrameStats_RecordSystem(0, CnFramePhaseDraw, cnTime_MakeMilli(4));
+		CN_TEST_ASSERT_EQ_U64(3, cnTime_Milli(cnPhaseTimes_RecentMean(times)));
+	}
+
+	CN_TEST_UNIT("Systems are found by name.") {
+		cnFrameStats_Clear();
+		cnFrameStats_SetSystemName(0, "Physics");
+		cnFrameStats_SetSystemName(3, "Audio");
+		cnFrameStats_RecordSystem(3, CnFramePhaseTick, cnTime_MakeMilli(7));
+
+		const CnPhaseTimes* audio = cnFrameStats_SystemPhase("Audio", CnFramePhaseTick);
+		CN_TEST_ASSERT_TRUE(audio == cnFrameStats_SystemPhaseAt(3, CnFramePhaseTick));
+		CN_TEST_ASSERT_EQ_U64(1, audio->numCalls);
+		CN_TEST_ASSERT_EQ_U64(0, cnFrameStats_SystemPhase("Physics", CnFramePhaseTick)->numCalls);
+		CN_TEST_ASSERT_EQ_STR("Audio", cnFrameStats_SystemName(3));
+
+		CN_TEST_ASSERT_TRUE(cnFrameStats_SystemPhase("Rendering", CnFramePhaseTick) == NULL);
+		CN_TEST_ASSERT_TRUE(cnFrameStats_SystemPhase("", CnFramePhaseTick) == NULL);
+		CN_TEST_ASSERT_TRUE(cnFrameStats_SystemName(1) == NULL);
+	}
+
+	CN_TEST_UNIT("Render stats are averaged over drawn frames.") {
+		cnFrameStats_Clear();
+		CN_TEST_ASSERT_EQ_U64(0, cnFrameStats_RenderMean().pixelsInFrame);
+
+		// Nothing has been drawn by the GPU yet.
+		cnFrameStats_RecordRender((CnRenderStats) { 0 });
+
+		cnFrameStats_RecordRender((CnRenderStats) {
+			.drawCalls = 10, .opaqueDraws = 6, .translucentDraws = 4,
+			.pixelsCovered = 3000, .samplesPassed = 1000, .pixelsInFrame = 1000, .gpuNs = 2000000
+		});
+		cnFrameStats_RecordRender((CnRenderStats) {
+			.drawCalls = 20, .opaqueDraws = 12, .translucentDraws = 8,
+			.pixelsCovered = 5000, .samplesPassed = 2000, .pixelsInFrame = 1000, .gpuNs = 4000000
+		});
+
+		const CnRenderStats mean = cnFrameStats_RenderMean();
+		CN_TEST_ASSERT_EQ_U32(15, mean.drawCalls);
+		CN_TEST_ASSERT_EQ_U32(9, mean.opaqueDraws);
+		CN_TEST_ASSERT_EQ_U32(6, mean.translucentDraws);
+		CN_TEST_ASSERT_EQ_U64(4000, mean.pixelsCovered);
+		CN_TEST_ASSERT_EQ_U64(1500, mean.samplesPassed);
+		CN_TEST_ASSERT_EQ_U64(1000, mean.pixelsInFrame);
+		CN_TEST_ASSERT_EQ_U64(3000000, mean.gpuNs);
+
+		cnFrameStats_Clear();
+		CN_TEST_ASSERT_EQ_U32(0, cnFrameStats_RenderMean().drawCalls);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,62 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/histogram.h>
+
+CN_TEST_SUITE_BEGIN("histogram")
+	CN_TEST_UNIT("Empty histograms have no percentiles.") {
+		CnHistogram h;
+		cnHistogram_Clear(&h);
+		CN_TEST_ASSERT_EQ_U64(0, h.numValues);
+		CN_TEST_ASSERT_EQ_U64(0, cnHistogram_Percentile(&h, 50.0));
+	}
+
+	CN_TEST_UNIT("Every value fits in a bucket containing it.") {
+		uint32_t lastIndex = 0;
+		for (uint64_t value = 0; value < 100000; ++value) {
+			const uint32_t index = cnHistogram_BucketIndex(value);
+			CN_TEST_ASSERT_TRUE(index >= lastIndex);
+			CN_TEST_ASSERT_TRUE(value <= cnHistogram_BucketUpperBound(index));
+			if (index > 0) {
+				CN_TEST_ASSERT_TRUE(value > cnHistogram_BucketUpperBound(index - 1));
+			}
+			lastIndex = index;
+		}
+		CN_TEST_ASSERT_EQ_U32(CN_HISTOGRAM_NUM_BUCKETS - 1, cnHistogram_BucketIndex(UINT64_MAX));
+	}
+
+	CN_TEST_UNIT("Small values are exact.") {
+		CnHistogram h;
+		cnHistogram_Clear(&h);
+		for (uint64_t value = 1; value <= 4; ++value) {
+			cnHistogram_Record(&h, value);
+		}
+		CN_TEST_ASSERT_EQ_U64(1, h.min);
+		CN_TEST_ASSERT_EQ_U64(4, h.max);
+		CN_TEST_ASSERT_EQ_U64(2, cnHistogram_Percentile(&h, 50.0));
+		CN_TEST_ASSERT_EQ_U64(4, cnHistogram_Percentile(&h, 100.0));
+	}
+
+	CN_TEST_UNIT("Percentiles are within a bucket of the actual value.") {
+		CnHistogram h;
+		cnHistogram_Clear(&h);
+		for (uint64_t ms = 1; ms <= 1000; ++ms) {
+			cnHistogram_Record(&h, ms * 1000000);
+		}
+		CN_TEST_ASSERT_CLOSE_F(500000000.0f, (float)cnHistogram_Percentile(&h, 50.0), 0.125f);
+		CN_TEST_ASSERT_CLOSE_F(990000000.0f, (float)cnHistogram_Percentile(&h, 99.0), 0.125f);
+		CN_TEST_ASSERT_EQ_U64(1000000000, cnHistogram_Percentile(&h, 100.0));
+	}
+
+	CN_TEST_UNIT("Rare slow values show up in the tail.") {
+		CnHistogram h;
+		cnHistogram_Clear(&h);
+		for (uint32_t i = 0; i < 999; ++i) {
+			cnHistogram_Record(&h, 16000000);
+		}
+		cnHistogram_Record(&h, 100000000);
+		CN_TEST_ASSERT_TRUE(cnHistogram_Percentile(&h, 99.0) < 20000000);
+		CN_TEST_ASSERT_EQ_U64(100000000, cnHistogram_Percentile(&h, 99.95));
+		CN_TEST_ASSERT_EQ_U64(100000000, h.max);
+	}
+CN_TEST_SUITE_END
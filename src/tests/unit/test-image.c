@@ -2,6 +2,7 @@
 
 #include <calendon/cn.h>
 #include <calendon/image.h>
+#include <calendon/memory.h>
 
 CN_TEST_SUITE_BEGIN("image")
 	CN_TEST_UNIT("Cannot create inappropriate texture atlases.") {
@@ -10,4 +11,28 @@ CN_TEST_SUITE_BEGIN("image")
 		cnImageRGBA8_GetPixelRowCol(&image, (CnRowColu32) { .row = 0, .col = 0 });
 	}
 
+	CN_TEST_UNIT("Flipping reverses the order of rows.") {
+		cnFrameArena_Init(1024);
+
+		// An odd number of rows, so the middle row stays in place.
+		CnImageRGBA8 image;
+		cnImageRGBA8_AllocateSized(&image, (CnDimension2u32) { 2, 3 });
+		for (uint32_t i = 0; i < image.pixels.size; ++i) {
+			image.pixels.contents[i] = (char)i;
+		}
+
+		cnImageRGBA8_Flip(&image);
+
+		const uint32_t rowSize = 2 * 4;
+		for (uint32_t row = 0; row < 3; ++row) {
+			for (uint32_t i = 0; i < rowSize; ++i) {
+				CN_TEST_ASSERT_EQ_I32((int32_t)((2 - row) * rowSize + i),
+					image.pixels.contents[row * rowSize + i]);
+			}
+		}
+
+		cnImageRGBA8_Free(&image);
+		cnFrameArena_Shutdown();
+	}
+
 CN_TEST_SUITE_END
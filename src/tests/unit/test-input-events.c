@@ -0,0 +1,64 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/input-events.h>
+
+static CnInputEvent keyDown(SDL_Keycode key)
+{
+	CnInputEvent event = { 0 };
+	event.type = CnInputEventKeyDown;
+	event.time = cnTime_MakeMilli(key);
+	event.key = key;
+	return event;
+}
+
+CN_TEST_SUITE_BEGIN("input events")
+	CN_TEST_UNIT("An empty queue has nothing to pop.") {
+		CnInputEventQueue queue;
+		cnInputEventQueue_Clear(&queue);
+		CnInputEvent event;
+		CN_TEST_ASSERT_FALSE(cnInputEventQueue_Pop(&queue, &event));
+		CN_TEST_ASSERT_EQ_U32(0, cnInputEventQueue_Count(&queue));
+	}
+
+	CN_TEST_UNIT("Events come out in the order they went in.") {
+		CnInputEventQueue queue;
+		cnInputEventQueue_Clear(&queue);
+
+		// Wrap around the end of the ring several times.
+		uint32_t nextIn = 0;
+		uint32_t nextOut = 0;
+		for (uint32_t round = 0; round < 10; ++round) {
+			for (uint32_t i = 0; i < CN_INPUT_EVENT_QUEUE_CAPACITY / 3; ++i) {
+				const CnInputEvent in = keyDown((SDL_Keycode)nextIn++);
+				cnInputEventQueue_Push(&queue, &in);
+			}
+
+			CnInputEvent out;
+			while (cnInputEventQueue_Pop(&queue, &out)) {
+				CN_TEST_ASSERT_EQ_I32((int32_t)nextOut, out.key);
+				CN_TEST_ASSERT_EQ_U64(nextOut, cnTime_Milli(out.time));
+				++nextOut;
+			}
+		}
+		CN_TEST_ASSERT_EQ_U32(nextIn, nextOut);
+		CN_TEST_ASSERT_EQ_U64(0, queue.numDropped);
+	}
+
+	CN_TEST_UNIT("A full queue drops the oldest events.") {
+		CnInputEventQueue queue;
+		cnInputEventQueue_Clear(&queue);
+
+		const uint32_t extra = 5;
+		for (uint32_t i = 0; i < CN_INPUT_EVENT_QUEUE_CAPACITY + extra; ++i) {
+			const CnInputEvent in = keyDown((SDL_Keycode)i);
+			cnInputEventQueue_Push(&queue, &in);
+		}
+		CN_TEST_ASSERT_EQ_U32(CN_INPUT_EVENT_QUEUE_CAPACITY, cnInputEventQueue_Count(&queue));
+		CN_TEST_ASSERT_EQ_U64(extra, queue.numDropped);
+
+		CnInputEvent out;
+		CN_TEST_ASSERT_TRUE(cnInputEventQueue_Pop(&queue, &out));
+		CN_TEST_ASSERT_EQ_I32((int32_t)extra, out.key);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,170 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/atomic.h>
+#include <calendon/job.h>
+#include <calendon/job-config.h>
+
+#include <string.h>
+
+static CnSystem startJobs(uint32_t numThreads)
+{
+	CnSystem system = cnJob_System();
+	system.setDefaultConfig(system.config());
+	((CnJobConfig*)system.config())->numThreads = numThreads;
+	system.init();
+	return system;
+}
+
+static void countJob(void* context)
+{
+	cnAtomic_FetchAddU32((volatile uint32_t*)context, 1);
+}
+
+enum { NumElements = 100000 };
+static volatile uint32_t s_touched[NumElements];
+
+static void touchRange(uint32_t begin, uint32_t end, void* context)
+{
+	CN_UNUSED(context);
+	for (uint32_t i = begin; i < end; ++i) {
+		cnAtomic_FetchAddU32(&s_touched[i], 1);
+	}
+}
+
+typedef struct {
+	volatile uint32_t* firstDone;
+	volatile uint32_t* sawFirstDone;
+} OrderCheck;
+
+static void firstJob(void* context)
+{
+	OrderCheck* check = (OrderCheck*)context;
+	cnAtomic_StoreU32(check->firstDone, 1);
+}
+
+static void secondJob(void* context)
+{
+	OrderCheck* check = (OrderCheck*)context;
+	cnAtomic_StoreU32(check->sawFirstDone, cnAtomic_LoadU32(check->firstDone));
+}
+
+/**
+ * Each thread's queue holds a job above one which depends on a job below the
+ * blocked job in the other thread's queue.
+ */
+typedef struct {
+	CnJobCounter first[2];
+	CnJobCounter second[2];
+	volatile uint32_t firstDone[2];
+	volatile uint32_t sawFirstDone[2];
+	OrderCheck checks[2];
+	volatile uint32_t workerReady;
+	volatile uint32_t mainReady;
+} CrossQueue;
+
+static void fillWorkerQueue(void* context)
+{
+	CrossQueue* cross = (CrossQueue*)context;
+	cnJob_Run(firstJob, &cross->checks[1], &cross->first[1]);
+	cnJob_RunAfter(secondJob, &cross->checks[0], &cross->second[1], &cross->first[0]);
+
+	// Keep the worker busy so the main thread can't steal from its queue.
+	cnAtomic_StoreU32(&cross->workerReady, 1);
+	while (!cnAtomic_LoadU32(&cross->mainReady)) {}
+}
+
+CN_TEST_SUITE_BEGIN("job")
+	CN_TEST_UNIT("Waiting finishes every job started with a counter.") {
+		const uint32_t threadCounts[] = { 1, 4 };
+		for (uint32_t t = 0; t < CN_ARRAY_SIZE(threadCounts); ++t) {
+			CnSystem system = startJobs(threadCounts[t]);
+
+			volatile uint32_t runs = 0;
+			CnJobCounter counter = { 0 };
+			for (uint32_t i = 0; i < 1000; ++i) {
+				cnJob_Run(countJob, (void*)&runs, &counter);
+			}
+			cnJob_Wait(&counter);
+			const bool done = cnJob_IsDone(&counter);
+			const uint32_t numRuns = runs;
+
+			system.shutdown();
+			CN_TEST_ASSERT_TRUE(done);
+			CN_TEST_ASSERT_EQ_U32(1000, numRuns);
+		}
+	}
+
+	CN_TEST_UNIT("Parallel for visits every element exactly once.") {
+		CnSystem system = startJobs(4);
+
+		const uint32_t grains[] = { 1, 7, 64, NumElements };
+		uint32_t wrongCounts = 0;
+		for (uint32_t g = 0; g < CN_ARRAY_SIZE(grains); ++g) {
+			memset((void*)s_touched, 0, sizeof(s_touched));
+			cnJob_ParallelFor(NumElements, grains[g], touchRange, NULL);
+			for (uint32_t i = 0; i < NumElements; ++i) {
+				wrongCounts += s_touched[i] != 1;
+			}
+		}
+
+		system.shutdown();
+		CN_TEST_ASSERT_EQ_U32(0, wrongCounts);
+	}
+
+	CN_TEST_UNIT("Jobs with a dependency run after it finishes.") {
+		CnSystem system = startJobs(4);
+
+		uint32_t outOfOrder = 0;
+		for (uint32_t i = 0; i < 200; ++i) {
+			volatile uint32_t firstDone = 0;
+			volatile uint32_t sawFirstDone = 0;
+			OrderCheck check = { &firstDone, &sawFirstDone };
+
+			CnJobCounter first = { 0 };
+			CnJobCounter second = { 0 };
+			cnJob_Run(firstJob, &check, &first);
+			cnJob_RunAfter(secondJob, &check, &second, &first);
+			cnJob_Wait(&second);
+			outOfOrder += sawFirstDone != 1;
+		}
+
+		system.shutdown();
+		CN_TEST_ASSERT_EQ_U32(0, outOfOrder);
+	}
+
+	CN_TEST_UNIT("Blocked jobs don't hide runnable jobs beneath them.") {
+		CnSystem system = startJobs(2);
+
+		uint32_t outOfOrder = 0;
+		for (uint32_t i = 0; i < 100; ++i) {
+			CrossQueue cross;
+			memset(&cross, 0, sizeof(cross));
+			for (uint32_t q = 0; q < 2; ++q) {
+				cross.checks[q].firstDone = &cross.firstDone[q];
+				cross.checks[q].sawFirstDone = &cross.sawFirstDone[q];
+			}
+
+			// Hold the main thread's first job as unfinished until it is
+			// queued, so the worker's second job blocks on it.
+			cross.first[0].remaining = 1;
+
+			CnJobCounter filled = { 0 };
+			cnJob_Run(fillWorkerQueue, &cross, &filled);
+			while (!cnAtomic_LoadU32(&cross.workerReady)) {}
+
+			cnJob_Run(firstJob, &cross.checks[0], &cross.first[0]);
+			cnAtomic_FetchSubU32(&cross.first[0].remaining, 1);
+			cnJob_RunAfter(secondJob, &cross.checks[1], &cross.second[0], &cross.first[1]);
+			cnAtomic_StoreU32(&cross.mainReady, 1);
+
+			cnJob_Wait(&cross.second[0]);
+			cnJob_Wait(&cross.second[1]);
+			cnJob_Wait(&filled);
+			outOfOrder += (cross.sawFirstDone[0] != 1) + (cross.sawFirstDone[1] != 1);
+		}
+
+		system.shutdown();
+		CN_TEST_ASSERT_EQ_U32(0, outOfOrder);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,49 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/json.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Writes a string to a temporary file and reads back what was written.
+ */
+static void writeString(const char* str, char* written, size_t size)
+{
+	memset(written, 0, size);
+	FILE* file = tmpfile();
+	if (!file) {
+		return;
+	}
+	cnJSON_WriteString(file, str);
+	rewind(file);
+	fread(written, 1, size - 1, file);
+	fclose(file);
+}
+
+CN_TEST_SUITE_BEGIN("json")
+	CN_TEST_UNIT("Plain strings are quoted.") {
+		char written[64];
+		writeString("nbody", written, sizeof(written));
+		CN_TEST_ASSERT_EQ_STR("\"nbody\"", written);
+
+		writeString("", written, sizeof(written));
+		CN_TEST_ASSERT_EQ_STR("\"\"", written);
+	}
+
+	CN_TEST_UNIT("Quotes, backslashes and control characters are escaped.") {
+		char written[64];
+		writeString("C:\\games\\\"x\".dll", written, sizeof(written));
+		CN_TEST_ASSERT_EQ_STR("\"C:\\\\games\\\\\\\"x\\\".dll\"", written);
+
+		writeString("a\nb\t\x1f", written, sizeof(written));
+		CN_TEST_ASSERT_EQ_STR("\"a\\u000ab\\u0009\\u001f\"", written);
+	}
+
+	CN_TEST_UNIT("Characters past ASCII are written as-is.") {
+		char written[64];
+		writeString("\xc3\xa9t\xc3\xa9", written, sizeof(written));
+		CN_TEST_ASSERT_EQ_STR("\"\xc3\xa9t\xc3\xa9\"", written);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,109 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/particles.h>
+
+static const CnRGBA8u white = { 255, 255, 255, 255 };
+
+CN_TEST_SUITE_BEGIN("particles")
+	CN_TEST_UNIT("Cannot create storage for zero particles.") {
+		CnParticles particles;
+		CN_TEST_PRECONDITION(cnParticles_Allocate(&particles, 0));
+	}
+
+	CN_TEST_UNIT("Spawning is limited by capacity.") {
+		CnParticles particles;
+		cnParticles_Allocate(&particles, 3);
+		const CnFloat2 zero = cnFloat2_Make(0.0f, 0.0f);
+		CN_TEST_ASSERT_TRUE(cnParticles_Spawn(&particles, zero, zero, 1.0f, white));
+		CN_TEST_ASSERT_TRUE(cnParticles_Spawn(&particles, zero, zero, 1.0f, white));
+		CN_TEST_ASSERT_TRUE(cnParticles_Spawn(&particles, zero, zero, 1.0f, white));
+		CN_TEST_ASSERT_FALSE(cnParticles_Spawn(&particles, zero, zero, 1.0f, white));
+		CN_TEST_ASSERT_EQ_U32(3, particles.count);
+		cnParticles_Free(&particles);
+	}
+
+	CN_TEST_UNIT("Wide and scalar updates integrate the same way.") {
+		// 11 particles exercises both the SIMD path and the scalar remainder.
+		enum { numParticles = 11 };
+		CnParticles particles;
+		cnParticles_Allocate(&particles, numParticles);
+		for (uint32_t i = 0; i < numParticles; ++i) {
+			cnParticles_Spawn(&particles, cnFloat2_Make((float)i, 0.0f),
+				cnFloat2_Make(1.0f, (float)i), 10.0f, white);
+		}
+
+		const CnFloat2 acceleration = cnFloat2_Make(0.0f, -2.0f);
+		cnParticles_Update(&particles, 0.5f, acceleration);
+		cnParticles_Update(&particles, 0.5f, acceleration);
+
+		CN_TEST_ASSERT_EQ_U32(numParticles, particles.count);
+		for (uint32_t i = 0; i < numParticles; ++i) {
+			// Semi-implicit Euler: v += a * dt, then p += v * dt.
+			CN_TEST_ASSERT_CLOSE_F((float)i + 1.0f, particles.x[i], 0.0001f);
+			CN_TEST_ASSERT_CLOSE_F((float)i - 1.5f, particles.y[i], 0.0001f);
+			CN_TEST_ASSERT_CLOSE_F(1.0f, particles.vx[i], 0.0001f);
+			CN_TEST_ASSERT_CLOSE_F((float)i - 2.0f, particles.vy[i], 0.0001f);
+			CN_TEST_ASSERT_CLOSE_F(1.0f, particles.age[i], 0.0001f);
+		}
+		cnParticles_Free(&particles);
+	}
+
+	CN_TEST_UNIT("Dead particles are removed.") {
+		enum { numParticles = 13 };
+		CnParticles particles;
+		cnParticles_Allocate(&particles, numParticles);
+
+		// Every third particle dies first, including the last one.
+		for (uint32_t i = 0; i < numParticles; ++i) {
+			const float lifetime = (i % 3 == 0) ? 1.0f : 5.0f;
+			cnParticles_Spawn(&particles, cnFloat2_Make((float)i, 0.0f),
+				cnFloat2_Make(0.0f, 0.0f), lifetime, white);
+		}
+
+		cnParticles_Update(&particles, 0.5f, cnFloat2_Make(0.0f, 0.0f));
+		CN_TEST_ASSERT_EQ_U32(numParticles, particles.count);
+
+		cnParticles_Update(&particles, 0.5f, cnFloat2_Make(0.0f, 0.0f));
+		CN_TEST_ASSERT_EQ_U32(8, particles.count);
+
+		// Survivors keep their own data, in any order.
+		float sumOfX = 0.0f;
+		for (uint32_t i = 0; i < particles.count; ++i) {
+			CN_TEST_ASSERT_CLOSE_F(5.0f, particles.lifetime[i], 0.0001f);
+			CN_TEST_ASSERT_TRUE((uint32_t)particles.x[i] % 3 != 0);
+			sumOfX += particles.x[i];
+		}
+		CN_TEST_ASSERT_CLOSE_F(1.0f + 2.0f + 4.0f + 5.0f + 7.0f + 8.0f + 10.0f + 11.0f, sumOfX, 0.0001f);
+
+		cnParticles_Update(&particles, 10.0f, cnFloat2_Make(0.0f, 0.0f));
+		CN_TEST_ASSERT_EQ_U32(0, particles.count);
+		cnParticles_Free(&particles);
+	}
+
+	CN_TEST_UNIT("Emitters spawn at their rate.") {
+		CnParticleEmitter emitter;
+		cnParticleEmitter_Allocate(&emitter, 100);
+		emitter.rate = 10.0f;
+		emitter.minLifetime = 100.0f;
+		emitter.maxLifetime = 100.0f;
+		emitter.velocityRange = cnAABB2_MakeMinMax(cnFloat2_Make(-1.0f, -1.0f), cnFloat2_Make(1.0f, 1.0f));
+
+		cnParticleEmitter_Update(&emitter, 0.25f);
+		CN_TEST_ASSERT_EQ_U32(2, emitter.particles.count);
+
+		// Fractional particles carry over.
+		cnParticleEmitter_Update(&emitter, 0.25f);
+		CN_TEST_ASSERT_EQ_U32(5, emitter.particles.count);
+
+		for (uint32_t i = 0; i < emitter.particles.count; ++i) {
+			CN_TEST_ASSERT_TRUE(emitter.particles.vx[i] >= -1.0f && emitter.particles.vx[i] <= 1.0f);
+			CN_TEST_ASSERT_TRUE(emitter.particles.vy[i] >= -1.0f && emitter.particles.vy[i] <= 1.0f);
+		}
+
+		// Particles which don't fit are dropped.
+		cnParticleEmitter_Update(&emitter, 100.0f);
+		CN_TEST_ASSERT_EQ_U32(100, emitter.particles.count);
+		cnParticleEmitter_Free(&emitter);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,144 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/job.h>
+#include <calendon/job-config.h>
+#include <calendon/memory.h>
+
+typedef struct {
+	float position[2];
+	float velocity[2];
+	uint32_t id;
+} Projectile;
+
+enum { NumPoolJobs = 16, BlocksPerJob = 1000 };
+
+/**
+ * Churns through blocks of its own pool, leaving half of them outstanding.
+ */
+static void poolJob(void* context)
+{
+	CnPool* pool = (CnPool*)context;
+	void* blocks[BlocksPerJob];
+	for (uint32_t round = 0; round < 10; ++round) {
+		for (uint32_t i = 0; i < BlocksPerJob; ++i) {
+			blocks[i] = cnPool_Alloc(pool);
+		}
+		for (uint32_t i = 0; i < BlocksPerJob; ++i) {
+			cnPool_Release(pool, blocks[i]);
+		}
+	}
+	for (uint32_t i = 0; i < BlocksPerJob / 2; ++i) {
+		cnPool_Alloc(pool);
+	}
+}
+
+CN_TEST_SUITE_BEGIN("pool")
+	CN_TEST_UNIT("Released blocks are handed out again.") {
+		CnPool pool;
+		cnPool_Allocate(&pool, sizeof(Projectile), 8, CN_POOL_DEFAULT_FLAGS);
+
+		Projectile* a = cnPool_Alloc(&pool);
+		Projectile* b = cnPool_Alloc(&pool);
+		CN_TEST_ASSERT_TRUE(a != b);
+		CN_TEST_ASSERT_EQ_U64(0, (uintptr_t)a % 16);
+		CN_TEST_ASSERT_EQ_U64(0, (uintptr_t)b % 16);
+
+		cnPool_Release(&pool, a);
+		CN_TEST_ASSERT_TRUE(cnPool_Alloc(&pool) == a);
+
+		cnPool_Release(&pool, a);
+		cnPool_Release(&pool, b);
+		CN_TEST_ASSERT_EQ_U64(0, pool.outstanding);
+		cnPool_Free(&pool);
+	}
+
+	CN_TEST_UNIT("Slabs are added as blocks run out.") {
+		CnPool pool;
+		cnPool_Allocate(&pool, sizeof(Projectile), 4, CnPoolFlagStats | CnPoolFlagPoison);
+
+		Projectile* blocks[10];
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(blocks); ++i) {
+			blocks[i] = cnPool_Alloc(&pool);
+			blocks[i]->id = i;
+		}
+		CN_TEST_ASSERT_EQ_U32(3, pool.numSlabs);
+		CN_TEST_ASSERT_EQ_U64(10, pool.outstanding);
+		CN_TEST_ASSERT_EQ_U64(10, cnMemory_Stats().outstandingPoolBlocks);
+
+		// Writing to blocks must not disturb other blocks.
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(blocks); ++i) {
+			CN_TEST_ASSERT_EQ_U32(i, blocks[i]->id);
+		}
+
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(blocks); ++i) {
+			cnPool_Release(&pool, blocks[i]);
+		}
+		CN_TEST_ASSERT_EQ_U64(10, pool.stats.numAllocs);
+		CN_TEST_ASSERT_EQ_U64(10, pool.stats.numReleases);
+		CN_TEST_ASSERT_EQ_U64(10, pool.stats.peakOutstanding);
+		CN_TEST_ASSERT_EQ_U64(0, cnMemory_Stats().outstandingPoolBlocks);
+
+		// Reusing released blocks doesn't need more slabs.
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(blocks); ++i) {
+			blocks[i] = cnPool_Alloc(&pool);
+		}
+		CN_TEST_ASSERT_EQ_U32(3, pool.numSlabs);
+		for (uint32_t i = 0; i < CN_ARRAY_SIZE(blocks); ++i) {
+			cnPool_Release(&pool, blocks[i]);
+		}
+		cnPool_Free(&pool);
+	}
+
+	CN_TEST_UNIT("Tiny blocks still hold the free list link.") {
+		CnPool pool;
+		cnPool_Allocate(&pool, 1, 4, 0);
+		CN_TEST_ASSERT_TRUE(pool.blockSize >= sizeof(void*));
+
+		uint8_t* a = cnPool_Alloc(&pool);
+		uint8_t* b = cnPool_Alloc(&pool);
+		CN_TEST_ASSERT_TRUE(a + pool.blockSize == b);
+		cnPool_Release(&pool, b);
+		cnPool_Release(&pool, a);
+		cnPool_Free(&pool);
+	}
+
+	CN_TEST_UNIT("Misuse is caught when poisoning.") {
+		CnPool pool;
+		cnPool_Allocate(&pool, sizeof(Projectile), 4, CnPoolFlagPoison);
+		Projectile* block = cnPool_Alloc(&pool);
+
+		Projectile notFromPool;
+		CN_TEST_PRECONDITION(cnPool_Release(&pool, &notFromPool));
+
+		// Write through a dangling pointer to a released block.
+		cnPool_Release(&pool, block);
+		block->id = 42;
+		CN_TEST_PRECONDITION(cnPool_Alloc(&pool));
+
+		cnPool_Free(&pool);
+	}
+
+	CN_TEST_UNIT("Blocks are counted across pools used on different threads.") {
+		CnSystem jobs = cnJob_System();
+		jobs.setDefaultConfig(jobs.config());
+		((CnJobConfig*)jobs.config())->numThreads = 4;
+		jobs.init();
+
+		const uint64_t before = cnMemory_Stats().outstandingPoolBlocks;
+		CnPool pools[NumPoolJobs];
+		CnJobCounter counter = { 0 };
+		for (uint32_t i = 0; i < NumPoolJobs; ++i) {
+			cnPool_Allocate(&pools[i], sizeof(Projectile), 64, 0);
+			cnJob_Run(poolJob, &pools[i], &counter);
+		}
+		cnJob_Wait(&counter);
+		jobs.shutdown();
+
+		CN_TEST_ASSERT_EQ_U64(before + NumPoolJobs * BlocksPerJob / 2, cnMemory_Stats().outstandingPoolBlocks);
+		for (uint32_t i = 0; i < NumPoolJobs; ++i) {
+			cnPool_Free(&pools[i]);
+		}
+		CN_TEST_ASSERT_EQ_U64(before, cnMemory_Stats().outstandingPoolBlocks);
+	}
+CN_TEST_SUITE_END
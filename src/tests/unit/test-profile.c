@@ -0,0 +1,246 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/atomic.h>
+#include <calendon/job.h>
+#include <calendon/job-config.h>
+#include <calendon/profile.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CN_ENABLE_PROFILER
+
+static const char* tracePath = "test-profile.json";
+
+/**
+ * The trace is read all at once, and kept until the next one is read.
+ */
+static char* s_trace;
+
+static void readTrace(void)
+{
+	free(s_trace);
+	s_trace = NULL;
+
+	long size = 0;
+	FILE* file = fopen(tracePath, "rb");
+	if (file) {
+		fseek(file, 0, SEEK_END);
+		size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+	}
+
+	s_trace = calloc((size_t)size + 1, 1);
+	if (file) {
+		fread(s_trace, 1, (size_t)size, file);
+		fclose(file);
+	}
+	remove(tracePath);
+}
+
+/**
+ * Each event is written on its own line.  Returns the next line starting with
+ * an event, or NULL at the end of the trace.
+ */
+static const char* nextEvent(const char* line, char* phase, uint32_t* tid)
+{
+	while (line && *line) {
+		const char* ph = strstr(line, "\"ph\":\"");
+		const char* tidText = strstr(line, "\"tid\":");
+		const char* end = strchr(line, '\n');
+		if (ph && tidText && (!end || ph < end)) {
+			*phase = ph[6];
+			*tid = (uint32_t)strtoul(tidText + 6, NULL, 10);
+			return end ? end + 1 : line + strlen(line);
+		}
+		line = end ? end + 1 : NULL;
+	}
+	return NULL;
+}
+
+/**
+ * Counts begin and end events on each thread, and fails if an end comes
+ * without a matching begin, or a thread is left with zones open.
+ */
+static bool isBalanced(uint32_t* numBegins, uint32_t maxThreads)
+{
+	int32_t depth[64] = { 0 };
+	memset(numBegins, 0, maxThreads * sizeof(uint32_t));
+
+	char phase;
+	uint32_t tid;
+	const char* line = s_trace;
+	while ((line = nextEvent(line, &phase, &tid)) != NULL) {
+		if (phase == 'M') {
+			continue;
+		}
+		if (tid >= maxThreads || (phase != 'B' && phase != 'E')) {
+			return false;
+		}
+		if (phase == 'B') {
+			++depth[tid];
+			++numBegins[tid];
+		}
+		else if (--depth[tid] < 0) {
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < maxThreads; ++i) {
+		if (depth[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static CnSystem startProfile(void)
+{
+	CnSystem system = cnProfile_System();
+	system.setDefaultConfig(system.config());
+	system.init();
+	return system;
+}
+
+enum { NumZoneThreads = 4 };
+static volatile uint32_t s_numInZone;
+
+/**
+ * Stays in its zone until every job is in one, so each job has to run on a
+ * different thread.
+ */
+static void zoneJob(void* context)
+{
+	CN_UNUSED(context);
+	CN_PROFILE_BEGIN("job");
+	cnAtomic_FetchAddU32(&s_numInZone, 1);
+	while (cnAtomic_LoadU32(&s_numInZone) < NumZoneThreads) {}
+	CN_PROFILE_END();
+}
+
+CN_TEST_SUITE_BEGIN("profile")
+	CN_TEST_UNIT("Nested zones write balanced begin and end events.") {
+		CnSystem system = startProfile();
+
+		CN_PROFILE_BEGIN("outer");
+		for (uint32_t i = 0; i < 3; ++i) {
+			CN_PROFILE_SCOPE("middle") {
+				CN_PROFILE_BEGIN("inner");
+				CN_PROFILE_END();
+			}
+		}
+		CN_PROFILE_BEGIN("sibling");
+		CN_PROFILE_END();
+		CN_PROFILE_END();
+
+		// Still open when written, so it ends then.
+		CN_PROFILE_BEGIN("unfinished");
+		const bool written = cnProfile_WriteTrace(tracePath);
+		CN_PROFILE_END();
+		system.shutdown();
+		readTrace();
+
+		uint32_t numBegins[1];
+		CN_TEST_ASSERT_TRUE(written);
+		CN_TEST_ASSERT_TRUE(isBalanced(numBegins, CN_ARRAY_SIZE(numBegins)));
+		CN_TEST_ASSERT_EQ_U32(9, numBegins[0]);
+
+		// The first inner zone ends before the second middle zone begins.
+		const char* firstInnerEnd = strstr(s_trace, "{\"name\":\"inner\",\"ph\":\"E\"");
+		const char* secondMiddle = strstr(strstr(s_trace, "{\"name\":\"middle\",\"ph\":\"B\"") + 1,
+			"{\"name\":\"middle\",\"ph\":\"B\"");
+		CN_TEST_ASSERT_TRUE(firstInnerEnd != NULL && secondMiddle != NULL);
+		CN_TEST_ASSERT_TRUE(firstInnerEnd < secondMiddle);
+	}
+
+	CN_TEST_UNIT("Zone names are escaped.") {
+		CnSystem system = startProfile();
+		CN_PROFILE_BEGIN("say \"hi\"\\\n\tthere");
+		CN_PROFILE_END();
+		const bool written = cnProfile_WriteTrace(tracePath);
+		system.shutdown();
+		readTrace();
+
+		CN_TEST_ASSERT_TRUE(written);
+		CN_TEST_ASSERT_TRUE(strstr(s_trace, "\"say \\\"hi\\\"\\\\\\u000a\\u0009there\"") != NULL);
+	}
+
+	CN_TEST_UNIT("Full buffers keep the most recent zones.") {
+		CnSystem system = startProfile();
+
+		// Open until the end, so it outlives everything it's nested around.
+		CN_PROFILE_BEGIN("outer");
+		CN_PROFILE_BEGIN("oldest");
+		CN_PROFILE_END();
+		for (uint32_t i = 0; i < CN_PROFILE_MAX_ZONES - 1; ++i) {
+			CN_PROFILE_BEGIN("middle");
+			CN_PROFILE_END();
+		}
+		CN_PROFILE_BEGIN("latest");
+		CN_PROFILE_END();
+		CN_PROFILE_END();
+
+		const bool written = cnProfile_WriteTrace(tracePath);
+		system.shutdown();
+		readTrace();
+
+		uint32_t numBegins[1];
+		CN_TEST_ASSERT_TRUE(written);
+		CN_TEST_ASSERT_TRUE(isBalanced(numBegins, CN_ARRAY_SIZE(numBegins)));
+		CN_TEST_ASSERT_EQ_U32(CN_PROFILE_MAX_ZONES, numBegins[0]);
+		CN_TEST_ASSERT_TRUE(strstr(s_trace, "\"oldest\"") == NULL);
+		CN_TEST_ASSERT_TRUE(strstr(s_trace, "{\"name\":\"outer\",\"ph\":\"B\"") != NULL);
+		CN_TEST_ASSERT_TRUE(strstr(s_trace, "{\"name\":\"latest\",\"ph\":\"E\"") != NULL);
+
+		// The outer zone is still written first, around everything else.
+		const char* firstZone = strstr(s_trace, "\"ph\":\"B\"");
+		CN_TEST_ASSERT_TRUE(firstZone != NULL && strstr(s_trace, "\"outer\"") < firstZone);
+	}
+
+	CN_TEST_UNIT("Each thread records into its own buffer.") {
+		CnSystem profile = startProfile();
+		CnSystem jobs = cnJob_System();
+		jobs.setDefaultConfig(jobs.config());
+		((CnJobConfig*)jobs.config())->numThreads = NumZoneThreads;
+		jobs.init();
+
+		cnAtomic_StoreU32(&s_numInZone, 0);
+		CnJobCounter counter = { 0 };
+		for (uint32_t i = 0; i < NumZoneThreads; ++i) {
+			cnJob_Run(zoneJob, NULL, &counter);
+		}
+		cnJob_Wait(&counter);
+		jobs.shutdown();
+
+		const bool written = cnProfile_WriteTrace(tracePath);
+		profile.shutdown();
+		readTrace();
+
+		uint32_t numBegins[NumZoneThreads];
+		CN_TEST_ASSERT_TRUE(written);
+		CN_TEST_ASSERT_TRUE(isBalanced(numBegins, CN_ARRAY_SIZE(numBegins)));
+		for (uint32_t i = 0; i < NumZoneThreads; ++i) {
+			CN_TEST_ASSERT_EQ_U32(1, numBegins[i]);
+		}
+	}
+CN_TEST_SUITE_END
+
+#else
+
+CN_TEST_SUITE_BEGIN("profile")
+	CN_TEST_UNIT("Zones compile away without the profiler.") {
+		uint32_t numRuns = 0;
+		CN_PROFILE_BEGIN("zone");
+		for (uint32_t i = 0; i < 3; ++i) {
+			CN_PROFILE_SCOPE("scope") {
+				++numRuns;
+			}
+		}
+		CN_PROFILE_END();
+		CN_TEST_ASSERT_EQ_U32(3, numRuns);
+	}
+CN_TEST_SUITE_END
+
+#endif /* CN_ENABLE_PROFILER */
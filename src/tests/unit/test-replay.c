@@ -0,0 +1,164 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/replay.h>
+#include <calendon/replay-config.h>
+#include <calendon/string.h>
+#include <calendon/ui.h>
+
+#include <stdio.h>
+
+static const char* recordingPath = "test-replay.cnrp";
+
+CN_TEST_SUITE_BEGIN("replay")
+	CN_TEST_UNIT("Ticks and input read back as recorded.") {
+		const CnTime recordStart = cnTime_MakeMilli(1000);
+		CnReplayLog log;
+		CN_TEST_ASSERT_TRUE(cnReplayLog_OpenWrite(&log, recordingPath, recordStart));
+
+		CnInputEvent move = { 0 };
+		move.type = CnInputEventMouseMove;
+		move.time = cnTime_Add(recordStart, cnTime_MakeMilli(5));
+		move.x = 300;
+		move.y = 20;
+		move.dx = -7;
+		move.dy = 4;
+		cnReplayLog_WriteInput(&log, &move);
+
+		CnInputEvent key = { 0 };
+		key.type = CnInputEventKeyDown;
+		key.time = cnTime_Add(recordStart, cnTime_MakeMilli(6));
+		key.key = SDLK_SPACE;
+		key.repeat = true;
+		cnReplayLog_WriteInput(&log, &key);
+
+		CnReplayTick tick;
+		tick.event.dt.native = 16666667;
+		tick.event.alpha = 0.25f;
+		tick.mouse = (CnMouse) { 300, 20, -7, 4 };
+		cnReplayLog_WriteTick(&log, &tick);
+		cnReplayLog_Close(&log);
+
+		// Played back later, event times shift by the same amount.
+		const CnTime playStart = cnTime_MakeMilli(9000);
+		CN_TEST_ASSERT_TRUE(cnReplayLog_OpenRead(&log, recordingPath, playStart));
+
+		CnReplayTick readTick = { 0 };
+		CnInputEvent readInput = { 0 };
+		CN_TEST_ASSERT_TRUE(cnReplayLog_Read(&log, &readTick, &readInput) == CnReplayEntryInput);
+		CN_TEST_ASSERT_TRUE(readInput.type == CnInputEventMouseMove);
+		CN_TEST_ASSERT_EQ_U64(9005, cnTime_Milli(readInput.time));
+		CN_TEST_ASSERT_EQ_I32(300, readInput.x);
+		CN_TEST_ASSERT_EQ_I32(20, readInput.y);
+		CN_TEST_ASSERT_EQ_I32(-7, readInput.dx);
+		CN_TEST_ASSERT_EQ_I32(4, readInput.dy);
+
+		CN_TEST_ASSERT_TRUE(cnReplayLog_Read(&log, &readTick, &readInput) == CnReplayEntryInput);
+		CN_TEST_ASSERT_TRUE(readInput.type == CnInputEventKeyDown);
+		CN_TEST_ASSERT_EQ_U64(9006, cnTime_Milli(readInput.time));
+		CN_TEST_ASSERT_EQ_I32(SDLK_SPACE, readInput.key);
+		CN_TEST_ASSERT_TRUE(readInput.repeat);
+
+		CN_TEST_ASSERT_TRUE(cnReplayLog_Read(&log, &readTick, &readInput) == CnReplayEntryTick);
+		CN_TEST_ASSERT_EQ_U64(tick.event.dt.native, readTick.event.dt.native);
+		CN_TEST_ASSERT_EXACT_F(tick.event.alpha, readTick.event.alpha);
+		CN_TEST_ASSERT_EQ_I32(300, readTick.mouse.x);
+		CN_TEST_ASSERT_EQ_I32(20, readTick.mouse.y);
+		CN_TEST_ASSERT_EQ_I32(-7, readTick.mouse.dx);
+		CN_TEST_ASSERT_EQ_I32(4, readTick.mouse.dy);
+
+		CN_TEST_ASSERT_TRUE(cnReplayLog_Read(&log, &readTick, &readInput) == CnReplayEntryEnd);
+		cnReplayLog_Close(&log);
+		remove(recordingPath);
+	}
+
+	CN_TEST_UNIT("Files which aren't recordings aren't read.") {
+		FILE* file = fopen(recordingPath, "wb");
+		CN_TEST_ASSERT_TRUE(file != NULL);
+		fputs("not a recording", file);
+		fclose(file);
+
+		CnReplayLog log;
+		CN_TEST_ASSERT_FALSE(cnReplayLog_OpenRead(&log, recordingPath, cnTime_MakeZero()));
+		remove(recordingPath);
+	}
+
+	CN_TEST_UNIT("A truncated entry is an error.") {
+		CnReplayLog log;
+		CN_TEST_ASSERT_TRUE(cnReplayLog_OpenWrite(&log, recordingPath, cnTime_MakeZero()));
+		CnReplayTick tick = { 0 };
+		tick.event.dt.native = 1u << 30;
+		tick.event.alpha = 1.0f;
+		cnReplayLog_WriteTick(&log, &tick);
+		fflush(log.file);
+
+		// Cut off the last byte of the tick.
+		const long size = ftell(log.file);
+		cnReplayLog_Close(&log);
+		FILE* file = fopen(recordingPath, "rb");
+		char bytes[64];
+		CN_TEST_ASSERT_TRUE(fread(bytes, 1, sizeof(bytes), file) == (size_t)size);
+		fclose(file);
+		file = fopen(recordingPath, "wb");
+		fwrite(bytes, 1, (size_t)size - 1, file);
+		fclose(file);
+
+		CN_TEST_ASSERT_TRUE(cnReplayLog_OpenRead(&log, recordingPath, cnTime_MakeZero()));
+		CnReplayTick readTick;
+		CnInputEvent readInput;
+		CN_TEST_ASSERT_TRUE(cnReplayLog_Read(&log, &readTick, &readInput) == CnReplayEntryError);
+		cnReplayLog_Close(&log);
+		remove(recordingPath);
+	}
+
+	CN_TEST_UNIT("Ticks sharing a frame replay the mouse state they polled.") {
+		// One mouse move read in a frame which ran three ticks, then a frame
+		// without input, which cleared the movement.
+		CnReplayLog log;
+		CN_TEST_ASSERT_TRUE(cnReplayLog_OpenWrite(&log, recordingPath, cnTime_MakeZero()));
+		CnInputEvent move = { 0 };
+		move.type = CnInputEventMouseMove;
+		move.x = 40;
+		move.y = 50;
+		move.dx = 3;
+		move.dy = -2;
+		cnReplayLog_WriteInput(&log, &move);
+
+		CnReplayTick tick = { 0 };
+		tick.event.dt = cnTime_MakeMilli(10);
+		tick.event.alpha = 1.0f;
+		tick.mouse = (CnMouse) { 40, 50, 3, -2 };
+		for (uint32_t i = 0; i < 3; ++i) {
+			cnReplayLog_WriteTick(&log, &tick);
+		}
+		tick.mouse.dx = 0;
+		tick.mouse.dy = 0;
+		cnReplayLog_WriteTick(&log, &tick);
+		cnReplayLog_Close(&log);
+
+		CnSystem system = cnReplay_System();
+		system.setDefaultConfig(system.config());
+		CnReplayConfig* config = (CnReplayConfig*)system.config();
+		cnString_Copy(config->replayPath.str, recordingPath, CN_MAX_TERMINATED_PATH);
+		CN_TEST_ASSERT_TRUE(system.init());
+
+		// Playback runs one tick per frame, and the mouse is made still
+		// between frames since there's no live input.
+		const int32_t expectedDx[] = { 3, 3, 3, 0 };
+		uint32_t numTicks = 0;
+		uint32_t wrongDx = 0;
+		CnFrameEvent event;
+		while (cnReplay_NextTick(&event)) {
+			CnMouse* mouse = &cnInput_Poll()->mouse;
+			wrongDx += numTicks >= CN_ARRAY_SIZE(expectedDx) || mouse->dx != expectedDx[numTicks];
+			++numTicks;
+			mouse->dx = 0;
+			mouse->dy = 0;
+		}
+
+		system.shutdown();
+		remove(recordingPath);
+		CN_TEST_ASSERT_EQ_U32(4, numTicks);
+		CN_TEST_ASSERT_EQ_U32(0, wrongDx);
+	}
+CN_TEST_SUITE_END
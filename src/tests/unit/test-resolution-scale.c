@@ -0,0 +1,103 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/resolution-scale.h>
+
+static const CnTime target = { .native = 16000000 };
+
+static void runFrames(CnResolutionScale* rs, uint32_t numFrames, uint64_t frameNs)
+{
+	for (uint32_t i = 0; i < numFrames; ++i) {
+		cnResolutionScale_Update(rs, (CnTime) { .native = frameNs });
+	}
+}
+
+/**
+ * Runs frames whose work goes with the number of pixels drawn, presented with
+ * VSync so a frame never takes less than `refreshNs` from one present to the
+ * next.  The scale is fed the work, as the renderer does, since the time
+ * between presents is floored by the wait for VSync.  Returns the shortest time
+ * between presents.
+ */
+static uint64_t runVSyncFrames(CnResolutionScale* rs, uint32_t numFrames, uint64_t fullScaleNs,
+	uint64_t refreshNs)
+{
+	uint64_t shortestPresentNs = UINT64_MAX;
+	for (uint32_t i = 0; i < numFrames; ++i) {
+		const uint64_t workNs = (uint64_t)((float)fullScaleNs * rs->scale * rs->scale);
+		const uint64_t presentNs = workNs > refreshNs ? workNs : refreshNs;
+		if (presentNs < shortestPresentNs) {
+			shortestPresentNs = presentNs;
+		}
+		cnResolutionScale_Update(rs, (CnTime) { .native = workNs });
+	}
+	return shortestPresentNs;
+}
+
+CN_TEST_SUITE_BEGIN("resolution scale")
+	CN_TEST_UNIT("Cannot target a zero frame time.") {
+		CnResolutionScale rs;
+		CN_TEST_PRECONDITION(cnResolutionScale_Init(&rs, cnTime_MakeZero()));
+	}
+
+	CN_TEST_UNIT("Frames on target keep full resolution.") {
+		CnResolutionScale rs;
+		cnResolutionScale_Init(&rs, target);
+		runFrames(&rs, 200, target.native);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, rs.scale, 0.0001f);
+	}
+
+	CN_TEST_UNIT("A single slow frame doesn't change the scale.") {
+		CnResolutionScale rs;
+		cnResolutionScale_Init(&rs, target);
+		runFrames(&rs, 100, target.native);
+		runFrames(&rs, 1, 4 * target.native);
+		runFrames(&rs, 100, target.native);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, rs.scale, 0.0001f);
+	}
+
+	CN_TEST_UNIT("Slow frames reduce the scale down to a minimum.") {
+		CnResolutionScale rs;
+		cnResolutionScale_Init(&rs, target);
+		runFrames(&rs, 100, 2 * target.native);
+		CN_TEST_ASSERT_TRUE(rs.scale < 1.0f);
+
+		runFrames(&rs, 1000, 10 * target.native);
+		CN_TEST_ASSERT_CLOSE_F(CN_RESOLUTION_SCALE_MIN, rs.scale, 0.0001f);
+	}
+
+	CN_TEST_UNIT("Fast frames recover full resolution.") {
+		CnResolutionScale rs;
+		cnResolutionScale_Init(&rs, target);
+		runFrames(&rs, 1000, 10 * target.native);
+		runFrames(&rs, 1000, target.native / 2);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, rs.scale, 0.0001f);
+	}
+
+	CN_TEST_UNIT("The scale recovers with frames floored at the refresh interval.") {
+		// Anything under 1.25 times the refresh interval can't be reached by
+		// the time between presents while scaling up.
+		const uint64_t refreshNs = 16666667;
+		CnResolutionScale rs;
+		cnResolutionScale_Init(&rs, (CnTime) { .native = 18000000 });
+
+		runVSyncFrames(&rs, 500, 3 * refreshNs, refreshNs);
+		CN_TEST_ASSERT_TRUE(rs.scale < 0.9f);
+
+		const uint64_t shortestPresentNs = runVSyncFrames(&rs, 1000, refreshNs / 2, refreshNs);
+		CN_TEST_ASSERT_EQ_U64(refreshNs, shortestPresentNs);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, rs.scale, 0.0001f);
+	}
+
+	CN_TEST_UNIT("The scale waits to settle after changing.") {
+		CnResolutionScale rs;
+		cnResolutionScale_Init(&rs, target);
+		bool changed = false;
+		while (!changed) {
+			changed = cnResolutionScale_Update(&rs, (CnTime) { .native = 3 * target.native });
+		}
+		for (uint32_t i = 0; i < CN_RESOLUTION_SCALE_SETTLE_FRAMES; ++i) {
+			CN_TEST_ASSERT_FALSE(cnResolutionScale_Update(&rs, (CnTime) { .native = 3 * target.native }));
+		}
+	}
+CN_TEST_SUITE_END
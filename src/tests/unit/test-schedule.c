@@ -0,0 +1,153 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/atomic.h>
+#include <calendon/job-config.h>
+#include <calendon/schedule.h>
+
+static void noopTick(CnFrameEvent* event)
+{
+	CN_UNUSED(event);
+}
+
+static const char* physicsName(void) { return "Physics"; }
+static const char* audioName(void) { return "Audio"; }
+static const char* aiName(void) { return "AI"; }
+static const char* cameraName(void) { return "Camera"; }
+
+static const char* const transforms[] = { "Transforms" };
+static const char* const sounds[] = { "Sounds" };
+static const char* const physics[] = { "Physics" };
+
+static CnSystemAccess physicsAccess(void)
+{
+	return (CnSystemAccess) { .writes = transforms, .numWrites = 1 };
+}
+
+static CnSystemAccess audioAccess(void)
+{
+	return (CnSystemAccess) { .reads = transforms, .numReads = 1, .writes = sounds, .numWrites = 1 };
+}
+
+static CnSystemAccess aiAccess(void)
+{
+	return (CnSystemAccess) { .reads = physics, .numReads = 1 };
+}
+
+static CnSystemAccess cameraAccess(void)
+{
+	return (CnSystemAccess) { .reads = transforms, .numReads = 1 };
+}
+
+static CnSystem makeSystem(CnSystem_NameFn name, CnSystem_AccessFn access)
+{
+	CnSystem system = { 0 };
+	system.name = name;
+	system.access = access;
+	system.behavior.tick = noopTick;
+	return system;
+}
+
+enum { NumParallel = 8 };
+static volatile uint32_t s_nextOrder;
+static uint32_t s_order[NumParallel];
+
+static void recordOrder(uint32_t systemIndex, CnFrameEvent* event)
+{
+	CN_UNUSED(event);
+	s_order[systemIndex] = cnAtomic_FetchAddU32(&s_nextOrder, 1);
+}
+
+CN_TEST_SUITE_BEGIN("schedule")
+	CN_TEST_UNIT("Systems which don't declare resources run in order.") {
+		CnSystem systems[3] = {
+			makeSystem(physicsName, NULL),
+			makeSystem(audioName, NULL),
+			makeSystem(aiName, NULL)
+		};
+		CnSchedule schedule;
+		cnSchedule_Build(&schedule, systems, 3);
+		CN_TEST_ASSERT_TRUE(cnSchedule_IsSerial(&schedule));
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 1, 0));
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 2, 0));
+	}
+
+	CN_TEST_UNIT("An undeclared system waits on everything before it.") {
+		CnSystem systems[3] = {
+			makeSystem(physicsName, physicsAccess),
+			makeSystem(cameraName, cameraAccess),
+			makeSystem(aiName, NULL)
+		};
+		CnSchedule schedule;
+		cnSchedule_Build(&schedule, systems, 3);
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 2, 0));
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 2, 1));
+	}
+
+	CN_TEST_UNIT("Shared resources order systems, unrelated systems don't.") {
+		CnSystem systems[4] = {
+			makeSystem(physicsName, physicsAccess),
+			makeSystem(audioName, audioAccess),
+			makeSystem(aiName, aiAccess),
+			makeSystem(cameraName, cameraAccess)
+		};
+		CnSchedule schedule;
+		cnSchedule_Build(&schedule, systems, 4);
+		CN_TEST_ASSERT_FALSE(cnSchedule_IsSerial(&schedule));
+
+		// Writes to transforms before others read them.
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 1, 0));
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 3, 0));
+
+		// Reading a system's name depends on that system.
+		CN_TEST_ASSERT_TRUE(cnSchedule_DependsOn(&schedule, 2, 0));
+
+		// Readers of the same resource don't depend on each other.
+		CN_TEST_ASSERT_FALSE(cnSchedule_DependsOn(&schedule, 3, 1));
+		CN_TEST_ASSERT_FALSE(cnSchedule_DependsOn(&schedule, 2, 1));
+		CN_TEST_ASSERT_FALSE(cnSchedule_DependsOn(&schedule, 0, 1));
+	}
+
+	CN_TEST_UNIT("Systems without a tick aren't scheduled.") {
+		CnSystem systems[2] = {
+			makeSystem(physicsName, NULL),
+			makeSystem(audioName, NULL)
+		};
+		systems[0].behavior.tick = NULL;
+		CnSchedule schedule;
+		cnSchedule_Build(&schedule, systems, 2);
+		CN_TEST_ASSERT_EQ_U32(1, schedule.numNodes);
+		CN_TEST_ASSERT_FALSE(cnSchedule_DependsOn(&schedule, 1, 0));
+	}
+
+	CN_TEST_UNIT("Running on threads finishes dependencies before dependents.") {
+		CnSystem jobs = cnJob_System();
+		jobs.setDefaultConfig(jobs.config());
+		((CnJobConfig*)jobs.config())->numThreads = 4;
+		jobs.init();
+
+		// A physics system feeding pairs of independent readers.
+		CnSystem systems[NumParallel];
+		systems[0] = makeSystem(physicsName, physicsAccess);
+		for (uint32_t i = 1; i < NumParallel; ++i) {
+			systems[i] = makeSystem(i % 2 ? cameraName : aiName, i % 2 ? cameraAccess : aiAccess);
+		}
+
+		CnSchedule schedule;
+		cnSchedule_Build(&schedule, systems, NumParallel);
+
+		uint32_t outOfOrder = 0;
+		CnFrameEvent event = { 0 };
+		for (uint32_t run = 0; run < 100; ++run) {
+			s_nextOrder = 0;
+			cnSchedule_Run(&schedule, recordOrder, &event);
+			for (uint32_t i = 1; i < NumParallel; ++i) {
+				outOfOrder += s_order[i] < s_order[0];
+			}
+			outOfOrder += s_nextOrder != NumParallel;
+		}
+
+		jobs.shutdown();
+		CN_TEST_ASSERT_EQ_U32(0, outOfOrder);
+	}
+CN_TEST_SUITE_END
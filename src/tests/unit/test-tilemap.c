@@ -0,0 +1,174 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/tilemap.h>
+
+static const CnDimension2f unitTile = { .width = 1.0f, .height = 1.0f };
+
+CN_TEST_SUITE_BEGIN("tilemap")
+	CN_TEST_UNIT("Cannot create inappropriate tilemaps.") {
+		CnTilemap map;
+		CN_TEST_PRECONDITION(cnTilemap_Allocate(&map, (CnDimension2u32) { 0, 1 }, 1, unitTile));
+		CN_TEST_PRECONDITION(cnTilemap_Allocate(&map, (CnDimension2u32) { 1, 0 }, 1, unitTile));
+		CN_TEST_PRECONDITION(cnTilemap_Allocate(&map, (CnDimension2u32) { 1, 1 }, 0, unitTile));
+	}
+
+	CN_TEST_UNIT("Chunks cover partial edges.") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 33, .height = 64 }, 2, unitTile);
+		CN_TEST_ASSERT_EQ_U32(2, map.sizeInChunks.width);
+		CN_TEST_ASSERT_EQ_U32(2, map.sizeInChunks.height);
+
+		const CnAABB2 edge = cnTilemap_ChunkAABB2(&map, (CnRowColu32) { .row = 1, .col = 1 });
+		CN_TEST_ASSERT_CLOSE_F(32.0f, edge.min.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(32.0f, edge.min.y, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(33.0f, edge.max.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(64.0f, edge.max.y, 0.001f);
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Tiles start empty and can be set.") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 40, .height = 40 }, 2, unitTile);
+
+		const CnRowColu32 tile = { .row = 35, .col = 3 };
+		CN_TEST_ASSERT_EQ_U32(CN_TILE_EMPTY, cnTilemap_Tile(&map, 0, tile));
+		CN_TEST_ASSERT_EQ_U32(CN_TILE_EMPTY, cnTilemap_Tile(&map, 1, tile));
+
+		cnTilemap_SetTile(&map, 1, tile, 7);
+		CN_TEST_ASSERT_EQ_U32(CN_TILE_EMPTY, cnTilemap_Tile(&map, 0, tile));
+		CN_TEST_ASSERT_EQ_U32(7, cnTilemap_Tile(&map, 1, tile));
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Only changing a tile dirties its chunk.") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 64, .height = 64 }, 1, unitTile);
+
+		const CnRowColu32 chunkRowCol = { .row = 1, .col = 0 };
+		CnTilemapChunk* chunk = cnTilemap_Chunk(&map, 0, chunkRowCol);
+		CN_TEST_ASSERT_TRUE(chunk->dirty);
+		chunk->dirty = false;
+
+		const CnRowColu32 tile = { .row = 40, .col = 5 };
+		cnTilemap_SetTile(&map, 0, tile, CN_TILE_EMPTY);
+		CN_TEST_ASSERT_FALSE(chunk->dirty);
+
+		cnTilemap_SetTile(&map, 0, tile, 2);
+		CN_TEST_ASSERT_TRUE(chunk->dirty);
+		CN_TEST_ASSERT_TRUE(cnTilemap_Chunk(&map, 0, (CnRowColu32) { 0, 0 })->dirty);
+		cnTilemap_Chunk(&map, 0, (CnRowColu32) { 0, 0 })->dirty = false;
+
+		cnTilemap_SetTile(&map, 0, (CnRowColu32) { .row = 41, .col = 5 }, 3);
+		CN_TEST_ASSERT_FALSE(cnTilemap_Chunk(&map, 0, (CnRowColu32) { 0, 0 })->dirty);
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Chunks overlapping an area.") {
+		CnTilemap map;
+		const CnDimension2f tileSize = { .width = 2.0f, .height = 2.0f };
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 256, .height = 128 }, 1, tileSize);
+		map.origin = cnFloat2_Make(-100.0f, 0.0f);
+
+		CnRowColu32 first, last;
+		CN_TEST_ASSERT_TRUE(cnTilemap_ChunksOverlapping(&map,
+			cnAABB2_MakeMinMax(cnFloat2_Make(-50.0f, 10.0f), cnFloat2_Make(70.0f, 70.0f)),
+			&first, &last));
+		CN_TEST_ASSERT_EQ_U32(0, first.col);
+		CN_TEST_ASSERT_EQ_U32(0, first.row);
+		CN_TEST_ASSERT_EQ_U32(2, last.col);
+		CN_TEST_ASSERT_EQ_U32(1, last.row);
+
+		// Clamped to the edges of the map.
+		CN_TEST_ASSERT_TRUE(cnTilemap_ChunksOverlapping(&map,
+			cnAABB2_MakeMinMax(cnFloat2_Make(-1000.0f, -1000.0f), cnFloat2_Make(1000.0f, 1000.0f)),
+			&first, &last));
+		CN_TEST_ASSERT_EQ_U32(0, first.col);
+		CN_TEST_ASSERT_EQ_U32(0, first.row);
+		CN_TEST_ASSERT_EQ_U32(7, last.col);
+		CN_TEST_ASSERT_EQ_U32(3, last.row);
+
+		CN_TEST_ASSERT_FALSE(cnTilemap_ChunksOverlapping(&map,
+			cnAABB2_MakeMinMax(cnFloat2_Make(-300.0f, 0.0f), cnFloat2_Make(-200.0f, 10.0f)),
+			&first, &last));
+		CN_TEST_ASSERT_FALSE(cnTilemap_ChunksOverlapping(&map,
+			cnAABB2_MakeMinMax(cnFloat2_Make(0.0f, 300.0f), cnFloat2_Make(10.0f, 310.0f)),
+			&first, &last));
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Baking skips empty tiles.") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 40, .height = 40 }, 1, unitTile);
+		static CnTileVertex vertices[CN_TILEMAP_MAX_CHUNK_VERTICES];
+		cnTilemap_SetTilesetGrid(&map, (CnDimension2u32) { .width = 2, .height = 2 });
+
+		CN_TEST_ASSERT_EQ_U32(0, cnTilemap_BakeChunk(&map, 0, (CnRowColu32) { 0, 0 }, vertices));
+
+		cnTilemap_SetTile(&map, 0, (CnRowColu32) { .row = 3, .col = 2 }, 2);
+		cnTilemap_SetTile(&map, 0, (CnRowColu32) { .row = 33, .col = 2 }, 1);
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_BakeChunk(&map, 0, (CnRowColu32) { 0, 0 }, vertices));
+
+		// Positions of the tile in triangle strip order.
+		CN_TEST_ASSERT_CLOSE_F(2.0f, vertices[0].position.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(3.0f, vertices[0].position.y, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(3.0f, vertices[1].position.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(3.0f, vertices[1].position.y, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(2.0f, vertices[2].position.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(4.0f, vertices[2].position.y, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(3.0f, vertices[3].position.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(4.0f, vertices[3].position.y, 0.001f);
+
+		// Tile index 2 is the top right cell of the tileset.
+		CN_TEST_ASSERT_CLOSE_F(0.5f, vertices[0].texCoord.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(0.5f, vertices[0].texCoord.y, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, vertices[3].texCoord.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(1.0f, vertices[3].texCoord.y, 0.001f);
+
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_BakeChunk(&map, 0, (CnRowColu32) { 1, 0 }, vertices));
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Full chunks bake every tile.") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 40, .height = 40 }, 1, unitTile);
+		static CnTileVertex vertices[CN_TILEMAP_MAX_CHUNK_VERTICES];
+		cnTilemap_SetTilesetGrid(&map, (CnDimension2u32) { .width = 1, .height = 1 });
+
+		cnTilemap_Fill(&map, 0, 1);
+		CN_TEST_ASSERT_EQ_U32(CN_TILEMAP_CHUNK_SIZE * CN_TILEMAP_CHUNK_SIZE,
+			cnTilemap_BakeChunk(&map, 0, (CnRowColu32) { 0, 0 }, vertices));
+		CN_TEST_ASSERT_EQ_U32(8 * 8,
+			cnTilemap_BakeChunk(&map, 0, (CnRowColu32) { 1, 1 }, vertices));
+		cnTilemap_Free(&map);
+	}
+
+	CN_TEST_UNIT("Changing the tileset grid re-bakes, but moving the map doesn't.") {
+		CnTilemap map;
+		cnTilemap_Allocate(&map, (CnDimension2u32) { .width = 40, .height = 40 }, 2, unitTile);
+		static CnTileVertex vertices[CN_TILEMAP_MAX_CHUNK_VERTICES];
+		cnTilemap_SetTilesetGrid(&map, (CnDimension2u32) { .width = 2, .height = 2 });
+		cnTilemap_SetTile(&map, 1, (CnRowColu32) { .row = 34, .col = 35 }, 1);
+
+		const CnRowColu32 chunk = { 1, 1 };
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_BakeChunk(&map, 1, chunk, vertices));
+		cnTilemap_Chunk(&map, 1, chunk)->dirty = false;
+
+		// Baked positions don't include the origin.
+		map.origin = cnFloat2_Make(500.0f, -20.0f);
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_BakeChunk(&map, 1, chunk, vertices));
+		CN_TEST_ASSERT_CLOSE_F(35.0f, vertices[0].position.x, 0.001f);
+		CN_TEST_ASSERT_CLOSE_F(34.0f, vertices[0].position.y, 0.001f);
+		CN_TEST_ASSERT_FALSE(cnTilemap_Chunk(&map, 1, chunk)->dirty);
+
+		cnTilemap_SetTilesetGrid(&map, (CnDimension2u32) { .width = 2, .height = 2 });
+		CN_TEST_ASSERT_FALSE(cnTilemap_Chunk(&map, 1, chunk)->dirty);
+
+		cnTilemap_SetTilesetGrid(&map, (CnDimension2u32) { .width = 4, .height = 1 });
+		CN_TEST_ASSERT_TRUE(cnTilemap_Chunk(&map, 1, chunk)->dirty);
+		CN_TEST_ASSERT_TRUE(cnTilemap_Chunk(&map, 0, (CnRowColu32) { 0, 0 })->dirty);
+		CN_TEST_ASSERT_EQ_U32(1, cnTilemap_BakeChunk(&map, 1, chunk, vertices));
+		CN_TEST_ASSERT_CLOSE_F(0.25f, vertices[1].texCoord.x, 0.001f);
+		cnTilemap_Free(&map);
+	}
+CN_TEST_SUITE_END
@@ -0,0 +1,28 @@
+#include <calendon/test.h>
+
+#include <calendon/cn.h>
+#include <calendon/time.h>
+
+CN_TEST_SUITE_BEGIN("time")
+	CN_TEST_UNIT("Sleeping until a past time returns immediately.") {
+		const CnTime start = cnTime_MakeNow();
+		cnTime_SleepUntil(cnTime_MakeZero());
+		const CnTime elapsed = cnTime_SubtractMonotonic(cnTime_MakeNow(), start);
+		CN_TEST_ASSERT_TRUE(cnTime_LessThan(elapsed, cnTime_MakeMilli(50)));
+	}
+
+	CN_TEST_UNIT("Sleeping doesn't wake up early.") {
+		for (uint64_t ms = 1; ms <= 5; ++ms) {
+			const CnTime deadline = cnTime_Add(cnTime_MakeNow(), cnTime_MakeMilli(ms));
+			cnTime_SleepUntil(deadline);
+			CN_TEST_ASSERT_FALSE(cnTime_LessThan(cnTime_MakeNow(), deadline));
+		}
+	}
+
+	CN_TEST_UNIT("Subtraction doesn't underflow.") {
+		const CnTime early = cnTime_MakeMilli(1);
+		const CnTime late = cnTime_MakeMilli(2);
+		CN_TEST_ASSERT_TRUE(cnTime_IsZero(cnTime_SubtractMonotonic(early, late)));
+		CN_TEST_ASSERT_EQ_U64(1, cnTime_Milli(cnTime_SubtractMonotonic(late, early)));
+	}
+CN_TEST_SUITE_END